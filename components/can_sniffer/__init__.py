@@ -0,0 +1,60 @@
+import esphome.codegen as cg
+import esphome.config_validation as cv
+from esphome import automation
+from esphome.components.canbus import CanbusComponent
+from esphome.components.canbus_ext import frame_source
+from esphome.const import CONF_ID
+
+CODEOWNERS = ["@leodesigner"]
+AUTO_LOAD = ["canbus_ext"]
+MULTI_CONF = True
+
+CONF_CANBUS_ID = "canbus_id"
+CONF_CAPACITY = "capacity"
+CONF_DUMP_INTERVAL = "dump_interval"
+
+can_sniffer_ns = cg.esphome_ns.namespace("can_sniffer")
+CanSniffer = can_sniffer_ns.class_("CanSniffer", cg.Component)
+DumpAction = can_sniffer_ns.class_("DumpAction", automation.Action)
+ResetAction = can_sniffer_ns.class_("ResetAction", automation.Action)
+
+
+def validate_capacity(value):
+    value = cv.int_range(min=8, max=1024)(value)
+    if value & (value - 1):
+        raise cv.Invalid("capacity must be a power of two")
+    return value
+
+
+CONFIG_SCHEMA = cv.Schema(
+    {
+        cv.GenerateID(): cv.declare_id(CanSniffer),
+        cv.Required(CONF_CANBUS_ID): cv.use_id(CanbusComponent),
+        cv.Optional(CONF_CAPACITY, default=64): validate_capacity,
+        cv.Optional(
+            CONF_DUMP_INTERVAL, default="0s"
+        ): cv.positive_time_period_milliseconds,
+    }
+).extend(cv.COMPONENT_SCHEMA)
+
+
+async def to_code(config):
+    canbus = await cg.get_variable(config[CONF_CANBUS_ID])
+    var = cg.new_Pvariable(config[CONF_ID], config[CONF_CAPACITY])
+    cg.add(var.set_frame_source(frame_source(canbus)))
+    await cg.register_component(var, config)
+    cg.add(var.set_dump_interval(config[CONF_DUMP_INTERVAL]))
+
+
+SNIFFER_ACTION_SCHEMA = automation.maybe_simple_id(
+    {
+        cv.GenerateID(): cv.use_id(CanSniffer),
+    }
+)
+
+
+@automation.register_action("can_sniffer.dump", DumpAction, SNIFFER_ACTION_SCHEMA)
+@automation.register_action("can_sniffer.reset", ResetAction, SNIFFER_ACTION_SCHEMA)
+async def sniffer_action_to_code(config, action_id, template_arg, args):
+    paren = await cg.get_variable(config[CONF_ID])
+    return cg.new_Pvariable(action_id, template_arg, paren)
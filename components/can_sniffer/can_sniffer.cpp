@@ -0,0 +1,119 @@
+#include "can_sniffer.h"
+#include "esphome/core/log.h"
+
+#include <cmath>
+#include <cstring>
+
+namespace esphome {
+namespace can_sniffer {
+
+static const char *const TAG = "can_sniffer";
+
+void CanSniffer::setup() {
+  if (this->frame_source_ == nullptr) {
+    ESP_LOGE(TAG, "The canbus platform does not provide a frame source");
+    this->mark_failed();
+    return;
+  }
+  this->table_.resize(this->capacity_);
+  this->reset();
+  this->frame_source_->add_frame_listener(this);
+  if (this->dump_interval_ > 0)
+    this->set_interval("dump", this->dump_interval_, [this]() { this->dump(); });
+}
+
+void CanSniffer::dump_config() {
+  ESP_LOGCONFIG(TAG, "CAN sniffer:");
+  ESP_LOGCONFIG(TAG, "  Capacity: %u IDs", this->capacity_);
+  if (this->dump_interval_ > 0)
+    ESP_LOGCONFIG(TAG, "  Dump interval: %u ms", (unsigned) this->dump_interval_);
+}
+
+void CanSniffer::reset() {
+  for (auto &entry : this->table_)
+    entry.key = KEY_EMPTY;
+  this->used_ = 0;
+  this->untracked_ = 0;
+  this->total_ = 0;
+}
+
+void CanSniffer::on_frames(const canbus::CanFrame *frames, const uint32_t *timestamps_us, size_t count) {
+  for (size_t i = 0; i < count; i++) {
+    const canbus::CanFrame &frame = frames[i];
+    uint32_t key = frame.can_id | (frame.use_extended_id ? KEY_EXTENDED : 0) |
+                   (frame.remote_transmission_request ? KEY_RTR : 0);
+    this->total_++;
+    Entry *entry = this->lookup_(key);
+    if (entry == nullptr) {
+      this->untracked_++;
+      continue;
+    }
+    this->record_(entry, frame, timestamps_us[i]);
+  }
+}
+
+// Linear probing on a Fibonacci hash; entries are never removed individually, so a free slot ends the probe
+CanSniffer::Entry *CanSniffer::lookup_(uint32_t key) {
+  if (this->table_.empty())
+    return nullptr;
+  uint16_t mask = this->capacity_ - 1;
+  uint32_t hash = key * 2654435769UL;
+  uint16_t slot = (hash >> 16) & mask;
+  for (uint16_t probe = 0; probe < this->capacity_; probe++, slot = (slot + 1) & mask) {
+    Entry &entry = this->table_[slot];
+    if (entry.key == key)
+      return &entry;
+    if (entry.key != KEY_EMPTY)
+      continue;
+    // keep one slot free so lookups of unknown IDs always terminate early
+    if (this->used_ + 1 >= this->capacity_)
+      return nullptr;
+    memset(&entry, 0, sizeof(entry));
+    entry.key = key;
+    this->used_++;
+    return &entry;
+  }
+  return nullptr;
+}
+
+void CanSniffer::record_(Entry *entry, const canbus::CanFrame &frame, uint32_t timestamp_us) {
+  if (entry->count == 0) {
+    entry->first_us = timestamp_us;
+  } else {
+    float interval = timestamp_us - entry->last_us;
+    // count - 1 intervals seen so far, this is interval number count
+    float delta = interval - entry->interval_mean_us;
+    entry->interval_mean_us += delta / entry->count;
+    entry->interval_m2 += delta * (interval - entry->interval_mean_us);
+  }
+  entry->count++;
+  entry->last_us = timestamp_us;
+  entry->dlc = frame.can_data_length_code;
+  memcpy(entry->data, frame.data, frame.can_data_length_code);
+}
+
+void CanSniffer::dump() {
+  uint32_t now = micros();
+  ESP_LOGI(TAG, "%u IDs, %u frames, %u untracked", this->used_, (unsigned) this->total_, (unsigned) this->untracked_);
+  for (const auto &entry : this->table_) {
+    if (entry.key == KEY_EMPTY)
+      continue;
+    char payload[3 * canbus::CAN_MAX_DATA_LENGTH + 1];
+    size_t pos = 0;
+    payload[0] = '\0';
+    for (uint8_t i = 0; i < entry.dlc; i++)
+      pos += snprintf(payload + pos, sizeof(payload) - pos, "%02x ", entry.data[i]);
+
+    float span_s = (entry.last_us - entry.first_us) / 1e6f;
+    float rate = span_s > 0.0f ? (entry.count - 1) / span_s : NAN;
+    float jitter_ms = entry.count > 2 ? sqrtf(entry.interval_m2 / (entry.count - 2)) / 1000.0f : NAN;
+    bool extended = entry.key & KEY_EXTENDED;
+    ESP_LOGI(TAG, "  0x%0*X%s n=%u rate=%.2f/s interval=%.1f ms jitter=%.2f ms age=%u ms [%u] %s",
+             extended ? 8 : 3, (unsigned) (entry.key & KEY_ID_MASK), (entry.key & KEY_RTR) ? " rtr" : "",
+             (unsigned) entry.count, rate, entry.interval_mean_us / 1000.0f, jitter_ms,
+             (unsigned) ((now - entry.last_us) / 1000), entry.dlc, payload);
+  }
+}
+
+}  // namespace can_sniffer
+}  // namespace esphome
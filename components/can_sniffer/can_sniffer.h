@@ -0,0 +1,82 @@
+#pragma once
+
+#include "esphome/core/automation.h"
+#include "esphome/core/component.h"
+#include "esphome/components/canbus/canbus.h"
+#include "esphome/components/canbus_ext/canbus_ext.h"
+
+#include <vector>
+
+namespace esphome {
+namespace can_sniffer {
+
+// Passive bus survey: every CAN ID seen gets a slot with frame count, rate, inter-arrival jitter and the last
+// payload. Transmits nothing, so on an MCP2515 in LISTENONLY mode it does not even acknowledge frames.
+class CanSniffer : public Component, public canbus_ext::FrameListener {
+ public:
+  // capacity is a power of two, the table is allocated once in setup()
+  explicit CanSniffer(uint16_t capacity) : capacity_(capacity) {}
+  void set_frame_source(canbus_ext::FrameSource *frame_source) { frame_source_ = frame_source; }
+  void set_dump_interval(uint32_t dump_interval) { dump_interval_ = dump_interval; }
+
+  void setup() override;
+  void dump_config() override;
+  float get_setup_priority() const override { return setup_priority::DATA; }
+
+  void on_frames(const canbus::CanFrame *frames, const uint32_t *timestamps_us, size_t count) override;
+
+  // Logs one line per ID seen, in table order
+  void dump();
+  void reset();
+
+ protected:
+  struct Entry {
+    uint32_t key;  // can_id plus KEY_* flags, KEY_EMPTY for a free slot
+    uint32_t count;
+    uint32_t first_us;
+    uint32_t last_us;
+    // running mean and sum of squared deviations of the inter-arrival time (Welford)
+    float interval_mean_us;
+    float interval_m2;
+    uint8_t data[canbus::CAN_MAX_DATA_LENGTH];
+    uint8_t dlc;
+  };
+
+  static const uint32_t KEY_ID_MASK = 0x1FFFFFFF;
+  static const uint32_t KEY_EXTENDED = 1UL << 31;
+  static const uint32_t KEY_RTR = 1UL << 30;
+  static const uint32_t KEY_EMPTY = UINT32_MAX;
+
+  Entry *lookup_(uint32_t key);
+  void record_(Entry *entry, const canbus::CanFrame &frame, uint32_t timestamp_us);
+
+  canbus_ext::FrameSource *frame_source_{nullptr};
+  uint16_t capacity_;
+  uint32_t dump_interval_{0};
+  std::vector<Entry> table_;
+  uint16_t used_{0};
+  // frames of IDs that found the table full
+  uint32_t untracked_{0};
+  uint32_t total_{0};
+};
+
+template<typename... Ts> class DumpAction : public Action<Ts...> {
+ public:
+  explicit DumpAction(CanSniffer *parent) : parent_(parent) {}
+  void play(Ts... x) override { this->parent_->dump(); }
+
+ protected:
+  CanSniffer *parent_;
+};
+
+template<typename... Ts> class ResetAction : public Action<Ts...> {
+ public:
+  explicit ResetAction(CanSniffer *parent) : parent_(parent) {}
+  void play(Ts... x) override { this->parent_->reset(); }
+
+ protected:
+  CanSniffer *parent_;
+};
+
+}  // namespace can_sniffer
+}  // namespace esphome
@@ -0,0 +1,48 @@
+import esphome.codegen as cg
+import esphome.config_validation as cv
+from esphome.components import sensor
+from esphome.const import (
+    ENTITY_CATEGORY_DIAGNOSTIC,
+    ICON_PERCENT,
+    STATE_CLASS_MEASUREMENT,
+    UNIT_PERCENT,
+)
+
+CODEOWNERS = ["@leodesigner"]
+
+canbus_ext_ns = cg.esphome_ns.namespace("canbus_ext")
+FrameSource = canbus_ext_ns.class_("FrameSource")
+FrameListener = canbus_ext_ns.class_("FrameListener")
+
+CONF_BUS_LOAD = "bus_load"
+
+CONFIG_SCHEMA = cv.Schema({})
+
+# Options every canbus platform implementing FrameSource accepts
+FRAME_SOURCE_SCHEMA = cv.Schema(
+    {
+        cv.Optional(CONF_BUS_LOAD): sensor.sensor_schema(
+            unit_of_measurement=UNIT_PERCENT,
+            icon=ICON_PERCENT,
+            accuracy_decimals=1,
+            state_class=STATE_CLASS_MEASUREMENT,
+            entity_category=ENTITY_CATEGORY_DIAGNOSTIC,
+        ),
+    }
+)
+
+
+def frame_source(canbus):
+    """Expression resolving to the driver's FrameSource, or nullptr for canbus platforms without one."""
+    return canbus_ext_ns.as_frame_source(canbus)
+
+
+async def register_frame_source(var, config):
+    if CONF_BUS_LOAD in config:
+        sens = await sensor.new_sensor(config[CONF_BUS_LOAD])
+        cg.add(var.set_bus_load_sensor(sens))
+        cg.add_define("USE_CANBUS_EXT_BUS_LOAD_SENSOR")
+
+
+async def to_code(config):
+    cg.add_define("USE_CANBUS_EXT")
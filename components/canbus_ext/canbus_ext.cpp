@@ -0,0 +1,131 @@
+#include "canbus_ext.h"
+
+namespace esphome {
+namespace canbus_ext {
+
+static const uint16_t CAN_CRC15_POLY = 0x4599;
+// CRC delimiter, ACK slot, ACK delimiter, EOF and intermission are never stuffed
+static const uint16_t FRAME_TRAILER_BITS = 1 + 2 + 7 + 3;
+
+// Feeds the stuffed part of a frame bit by bit, tracking CRC and stuff bits as the controller does
+struct BitStuffer {
+  uint16_t bits{0};
+  uint16_t stuff_bits{0};
+  uint16_t crc{0};
+  uint8_t run{0};
+  bool last{false};
+
+  void put(bool bit, bool in_crc = false) {
+    if (!in_crc) {
+      bool crc_next = bit ^ ((this->crc >> 14) & 1);
+      this->crc = (this->crc << 1) & 0x7FFF;
+      if (crc_next)
+        this->crc ^= CAN_CRC15_POLY;
+    }
+    this->count(bit);
+  }
+
+  void put_field(uint32_t value, uint8_t width, bool in_crc = false) {
+    for (int8_t i = width - 1; i >= 0; i--)
+      this->put((value >> i) & 1, in_crc);
+  }
+
+  void count(bool bit) {
+    this->bits++;
+    if (this->run > 0 && bit == this->last) {
+      this->run++;
+    } else {
+      this->run = 1;
+      this->last = bit;
+    }
+    if (this->run == 5) {
+      // the inserted complementary bit starts the next run
+      this->stuff_bits++;
+      this->last = !bit;
+      this->run = 1;
+    }
+  }
+};
+
+uint16_t frame_bits(const canbus::CanFrame &frame) {
+  uint8_t dlc = frame.can_data_length_code > canbus::CAN_MAX_DATA_LENGTH ? canbus::CAN_MAX_DATA_LENGTH
+                                                                        : frame.can_data_length_code;
+  BitStuffer s;
+  s.put(0);  // SOF
+  if (frame.use_extended_id) {
+    s.put_field(frame.can_id >> 18, 11);  // base id
+    s.put(1);                             // SRR
+    s.put(1);                             // IDE
+    s.put_field(frame.can_id, 18);        // id extension
+    s.put(frame.remote_transmission_request);
+    s.put(0);  // r1
+    s.put(0);  // r0
+  } else {
+    s.put_field(frame.can_id, 11);
+    s.put(frame.remote_transmission_request);
+    s.put(0);  // IDE
+    s.put(0);  // r0
+  }
+  s.put_field(dlc, 4);
+  if (!frame.remote_transmission_request) {
+    for (uint8_t i = 0; i < dlc; i++)
+      s.put_field(frame.data[i], 8);
+  }
+  s.put_field(s.crc, 15, true);
+  return s.bits + s.stuff_bits + FRAME_TRAILER_BITS;
+}
+
+void FrameSource::update_bus_load_(uint32_t now) {
+  uint32_t elapsed = now - this->bus_window_start_;
+  if (elapsed < BUS_LOAD_WINDOW_MS)
+    return;
+  this->bus_load_ = 100.0f * this->bus_bits_ / (elapsed / 1000.0f * this->get_bit_rate_bps());
+  this->bus_bits_ = 0;
+  this->bus_window_start_ = now;
+#ifdef USE_CANBUS_EXT_BUS_LOAD_SENSOR
+  if (this->bus_load_sensor_ != nullptr)
+    this->bus_load_sensor_->publish_state(this->bus_load_);
+#endif
+}
+
+uint32_t speed_to_bps(canbus::CanSpeed speed) {
+  switch (speed) {
+    case canbus::CAN_5KBPS:
+      return 5000;
+    case canbus::CAN_10KBPS:
+      return 10000;
+    case canbus::CAN_20KBPS:
+      return 20000;
+    case canbus::CAN_31K25BPS:
+      return 31250;
+    case canbus::CAN_33KBPS:
+      return 33333;
+    case canbus::CAN_40KBPS:
+      return 40000;
+    case canbus::CAN_50KBPS:
+      return 50000;
+    case canbus::CAN_80KBPS:
+      return 80000;
+    case canbus::CAN_83K3BPS:
+      return 83333;
+    case canbus::CAN_95KBPS:
+      return 95000;
+    case canbus::CAN_100KBPS:
+      return 100000;
+    case canbus::CAN_125KBPS:
+      return 125000;
+    case canbus::CAN_200KBPS:
+      return 200000;
+    case canbus::CAN_250KBPS:
+      return 250000;
+    case canbus::CAN_500KBPS:
+      return 500000;
+    case canbus::CAN_1000KBPS:
+      return 1000000;
+    default:
+      return 125000;
+  }
+}
+
+}  // namespace canbus_ext
+}  // namespace esphome
@@ -0,0 +1,93 @@
+#pragma once
+
+#include "esphome/core/defines.h"
+#include "esphome/components/canbus/canbus.h"
+#ifdef USE_CANBUS_EXT_BUS_LOAD_SENSOR
+#include "esphome/components/sensor/sensor.h"
+#endif
+
+#include <cmath>
+
+namespace esphome {
+namespace canbus_ext {
+
+// Extensions to the ESPHome canbus API implemented by the drivers in this repository.
+
+// Receives every frame a driver takes off the bus, batched: one call per drain of the controller.
+// timestamps_us[i] is the micros() value at which frames[i] was received, as close to the wire as the driver
+// can tell (kernel receive time for SocketCAN, the RX drain for the MCP2515).
+class FrameListener {
+ public:
+  virtual void on_frames(const canbus::CanFrame *frames, const uint32_t *timestamps_us, size_t count) = 0;
+  // The driver left sleep mode because of activity on the bus
+  virtual void on_wake() {}
+};
+
+// Bits a frame occupies on the wire: SOF through CRC with the actual stuff bits, plus CRC delimiter, ACK, EOF
+// and the 3 bit intermission.
+uint16_t frame_bits(const canbus::CanFrame &frame);
+
+uint32_t speed_to_bps(canbus::CanSpeed speed);
+
+static const uint8_t MAX_FRAME_LISTENERS = 4;
+static const uint32_t BUS_LOAD_WINDOW_MS = 1000;
+
+class FrameSource {
+ public:
+  // Nominal bit rate of the bus the driver is attached to
+  virtual uint32_t get_bit_rate_bps() const = 0;
+
+  bool add_frame_listener(FrameListener *listener) {
+    if (this->listener_count_ >= MAX_FRAME_LISTENERS)
+      return false;
+    this->listeners_[this->listener_count_++] = listener;
+    return true;
+  }
+
+  // Share of bus time used by the frames this driver received and sent during the last BUS_LOAD_WINDOW_MS,
+  // in percent, NAN before the first window closes. Frames dropped by the acceptance filters or lost to an
+  // RX overflow are not seen, so on a hardware controller this is a lower bound.
+  float get_bus_load() const { return this->bus_load_; }
+#ifdef USE_CANBUS_EXT_BUS_LOAD_SENSOR
+  void set_bus_load_sensor(sensor::Sensor *bus_load_sensor) { this->bus_load_sensor_ = bus_load_sensor; }
+#endif
+
+  // Low-power standby for controllers that have one; false if the driver cannot sleep. A sleeping controller
+  // neither sends nor receives, it wakes by itself on bus activity (listeners get on_wake()) or on request_wake().
+  virtual bool request_sleep() { return false; }
+  virtual void request_wake() {}
+  bool is_sleeping() const { return this->sleeping_; }
+
+ protected:
+  void dispatch_frames_(const canbus::CanFrame *frames, const uint32_t *timestamps_us, size_t count) {
+    for (uint8_t i = 0; i < this->listener_count_; i++)
+      this->listeners_[i]->on_frames(frames, timestamps_us, count);
+  }
+
+  void notify_wake_() {
+    for (uint8_t i = 0; i < this->listener_count_; i++)
+      this->listeners_[i]->on_wake();
+  }
+
+  void account_frame_(const canbus::CanFrame &frame) { this->bus_bits_ += frame_bits(frame); }
+  // called from the driver's loop(), closes the window when it is due
+  void update_bus_load_(uint32_t now);
+
+  FrameListener *listeners_[MAX_FRAME_LISTENERS]{};
+  uint8_t listener_count_{0};
+  bool sleeping_{false};
+
+  uint32_t bus_bits_{0};
+  uint32_t bus_window_start_{0};
+  float bus_load_{NAN};
+#ifdef USE_CANBUS_EXT_BUS_LOAD_SENSOR
+  sensor::Sensor *bus_load_sensor_{nullptr};
+#endif
+};
+
+// Resolved at compile time: drivers deriving from FrameSource yield themselves, other canbus platforms nullptr.
+inline FrameSource *as_frame_source(FrameSource *source) { return source; }
+inline FrameSource *as_frame_source(void *) { return nullptr; }
+
+}  // namespace canbus_ext
+}  // namespace esphome
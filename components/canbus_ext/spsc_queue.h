@@ -0,0 +1,53 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+
+namespace esphome {
+namespace canbus_ext {
+
+// Lock-free ring for exactly one producer and one consumer thread (or ISR). Head and tail run freely and are
+// masked on access, so all N slots are usable.
+template<typename T, size_t N> class SpscQueue {
+  static_assert(N > 0 && (N & (N - 1)) == 0, "SpscQueue size must be a power of two");
+
+ public:
+  // producer side
+  bool push(const T &item) {
+    size_t head = this->head_.load(std::memory_order_relaxed);
+    if (head - this->tail_.load(std::memory_order_acquire) == N)
+      return false;
+    this->items_[head & (N - 1)] = item;
+    this->head_.store(head + 1, std::memory_order_release);
+    return true;
+  }
+
+  // consumer side: peek() and drop() let the consumer keep an item it could not handle yet
+  T *peek() {
+    size_t tail = this->tail_.load(std::memory_order_relaxed);
+    if (this->head_.load(std::memory_order_acquire) == tail)
+      return nullptr;
+    return &this->items_[tail & (N - 1)];
+  }
+  void drop() { this->tail_.store(this->tail_.load(std::memory_order_relaxed) + 1, std::memory_order_release); }
+  bool pop(T *item) {
+    T *front = this->peek();
+    if (front == nullptr)
+      return false;
+    *item = *front;
+    this->drop();
+    return true;
+  }
+
+  bool empty() const {
+    return this->head_.load(std::memory_order_acquire) == this->tail_.load(std::memory_order_acquire);
+  }
+
+ protected:
+  T items_[N];
+  std::atomic<size_t> head_{0};
+  std::atomic<size_t> tail_{0};
+};
+
+}  // namespace canbus_ext
+}  // namespace esphome
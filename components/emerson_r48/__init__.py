@@ -1,25 +1,68 @@
 import esphome.codegen as cg
 import esphome.config_validation as cv
+from esphome import automation
 from esphome.components.canbus import CanbusComponent
-from esphome.const import CONF_ID
+from esphome.const import CONF_ID, CONF_TRIGGER_ID
+from esphome.components.canbus_ext import frame_source
+
+AUTO_LOAD = ["canbus_ext", "emerson_r48_protocol"]
 
 CONF_CANBUS_ID = "canbus_id"
 CONF_EMERSON_R48_ID = "emerson_r48_id"
+CONF_BUS_LOAD_THRESHOLD = "bus_load_threshold"
+CONF_SLEEP_WHEN_AC_OFF = "sleep_when_ac_off"
+CONF_RESTORE_SETPOINTS = "restore_setpoints"
+CONF_ON_SNAPSHOT = "on_snapshot"
 
 emerson_r48_ns = cg.esphome_ns.namespace("emerson_r48")
 EmersonR48Component = emerson_r48_ns.class_(
     "EmersonR48Component", cg.PollingComponent
 )
+TelemetrySnapshot = emerson_r48_ns.struct("TelemetrySnapshot")
+SnapshotTrigger = emerson_r48_ns.class_(
+    "SnapshotTrigger",
+    automation.Trigger.template(TelemetrySnapshot.operator("ref").operator("const")),
+)
 
 CONFIG_SCHEMA = cv.Schema(
     {
         cv.GenerateID(): cv.declare_id(EmersonR48Component),
         cv.Required(CONF_CANBUS_ID): cv.use_id(CanbusComponent),
+        cv.Optional(CONF_BUS_LOAD_THRESHOLD): cv.percentage,
+        # delay after the AC off switch before the CAN controller sleeps (mcp2515 only)
+        cv.Optional(CONF_SLEEP_WHEN_AC_OFF): cv.positive_time_period_milliseconds,
+        # persist setpoints and control bits in flash, re-applied right after boot
+        cv.Optional(CONF_RESTORE_SETPOINTS, default=False): cv.boolean,
+        # once per poll cycle with all values, x is the TelemetrySnapshot
+        cv.Optional(CONF_ON_SNAPSHOT): automation.validate_automation(
+            {cv.GenerateID(CONF_TRIGGER_ID): cv.declare_id(SnapshotTrigger)}
+        ),
     }
 ).extend(cv.polling_component_schema("5s"))
 
 
+def _fnv1_hash(text):
+    # same as esphome::fnv1_hash(), a stable preference key per component id
+    value = 2166136261
+    for char in text.encode():
+        value = (value * 16777619) & 0xFFFFFFFF
+        value ^= char
+    return value
+
+
 async def to_code(config):
     canbus = await cg.get_variable(config[CONF_CANBUS_ID])
     var = cg.new_Pvariable(config[CONF_ID], canbus)
+    cg.add(var.set_frame_source(frame_source(canbus)))
     await cg.register_component(var, config)
+    if config[CONF_RESTORE_SETPOINTS]:
+        cg.add(var.set_restore_key(_fnv1_hash(f"emerson_r48.{config[CONF_ID].id}")))
+    if CONF_BUS_LOAD_THRESHOLD in config:
+        cg.add(var.set_bus_load_threshold(config[CONF_BUS_LOAD_THRESHOLD] * 100.0))
+    if CONF_SLEEP_WHEN_AC_OFF in config:
+        cg.add(var.set_sleep_delay(config[CONF_SLEEP_WHEN_AC_OFF]))
+    for conf in config.get(CONF_ON_SNAPSHOT, []):
+        trigger = cg.new_Pvariable(conf[CONF_TRIGGER_ID], var)
+        await automation.build_automation(
+            trigger, [(TelemetrySnapshot.operator("ref").operator("const"), "x")], conf
+        )
@@ -5,153 +5,295 @@
 #include "esphome/core/component.h"
 #include "esphome/core/log.h"
 
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#ifdef USE_ESP8266
+#include <Esp.h>
+#endif
+#ifdef USE_ESP32
+#include <esp_heap_caps.h>
+#endif
+
 namespace esphome {
 namespace emerson_r48 {
 
 static const char *const TAG = "emerson_r48";
 
-static const float EMR48_OUTPUT_VOLTAGE_MIN = 41.0;
-static const float EMR48_OUTPUT_VOLTAGE_MAX = 58.5;
-
-static const float EMR48_OUTPUT_CURRENT_RATED_VALUE = 62.5;
-static const float EMR48_OUTPUT_CURRENT_RATED_PERCENTAGE_MIN = 10;
-static const float EMR48_OUTPUT_CURRENT_RATED_PERCENTAGE_MAX = 121;
-static const float EMR48_OUTPUT_CURRENT_RATED_PERCENTAGE = 121;
-static const float EMR48_OUTPUT_CURRENT_MIN = 5.5; // 10%, rounded up to nearest 0.5A
-static const float EMR48_OUTPUT_CURRENT_MAX = EMR48_OUTPUT_CURRENT_RATED_VALUE;
-
-static const uint32_t CAN_ID_REQUEST = 0x06000783;
-static const uint32_t CAN_ID_DATA = 0x60f8003; // 0x0707F803;
-static const uint32_t CAN_ID_DATA2 = 0x60f8007;
-static const uint32_t CAN_ID_SET = 0x0607FF83; // set voltage and max current
-static const uint32_t CAN_ID_SET2 = 0x0677FF83; // set voltage and max current
-static const uint32_t CAN_ID_SET_CTL = 0x06080783; // set control
-static const uint32_t CAN_ID_SYNC = 0x0707FF83;
-static const uint32_t CAN_ID_SYNC2 = 0x0717FF83;
-static const uint32_t CAN_ID_GIMME5 = 0x06080783;
-
-static const uint8_t EMR48_DATA_OUTPUT_V = 0x01;
-static const uint8_t EMR48_DATA_OUTPUT_A = 0x02;
-static const uint8_t EMR48_DATA_OUTPUT_AL = 0x03;
-static const uint8_t EMR48_DATA_OUTPUT_T = 0x04;
-static const uint8_t EMR48_DATA_OUTPUT_IV = 0x05;
-
-
-EmersonR48Component::EmersonR48Component(canbus::Canbus *canbus) { this->canbus = canbus; }
+static const uint8_t EMR48_SYNC[EMR48_FRAME_LENGTH] = {0x04, 0xF0, 0x01, 0x5A, 00, 00, 00, 00};
+static const uint8_t EMR48_SYNC2[EMR48_FRAME_LENGTH] = {0x04, 0xF0, 0x5A, 00, 00, 00, 00, 00};
+static const uint8_t EMR48_GIMME5[EMR48_FRAME_LENGTH] = {0x20, 0xF0, 00, 0x80, 00, 00, 00, 00};
+
+static const float EMR48_SETPOINT_TOLERANCE_V = 0.1f;
+static const uint8_t EMR48_MAX_POLL_BACKOFF = 3;
+static const uint16_t EMR48_TIMING_LOG_CYCLES = 60;
+static const uint32_t EMR48_MAX_RESYNC_INTERVAL_MS = 300000;
+// boot sequence: one frame per step, spaced so the controller's TX buffers never fill up
+static const uint8_t EMR48_STARTUP_STEPS = 6;
+static const uint32_t EMR48_STARTUP_STEP_MS = 10;
+// a step whose frame cannot be sent (controller not up yet) is retried until then
+static const uint32_t EMR48_STARTUP_TIMEOUT_MS = 15000;
+// online setpoints lapse EMR48_ONLINE_COMMAND_TIMEOUT_MS after the last frame, the ones in use are repeated
+static const uint32_t EMR48_ONLINE_REFRESH_MS = EMR48_ONLINE_COMMAND_TIMEOUT_MS / 2;
+
+EmersonR48Component::EmersonR48Component(canbus::Canbus *canbus)
+    : canbus(canbus),
+      // catch all received messages
+      frame_trigger_(canbus, 0, 0, true),
+      frame_automation_(&frame_trigger_),
+      frame_action_([this](FrameArgs x, uint32_t can_id, bool remote_transmission_request) -> void {
+        this->on_frame(can_id, remote_transmission_request, x);
+      }) {
+  this->tx_data_.reserve(EMR48_FRAME_LENGTH);
+  std::fill(std::begin(this->pending_snapshot_.values), std::end(this->pending_snapshot_.values), NAN);
+  this->snapshot_ = this->pending_snapshot_;
+}
 
 void EmersonR48Component::sendSync(){
-  std::vector<uint8_t> data = {0x04, 0xF0, 0x01, 0x5A, 00, 00, 00, 00};
-  this->canbus->send_data(CAN_ID_SYNC, true, data);
+  this->send_frame_(CAN_ID_SYNC, EMR48_SYNC);
 }
 void EmersonR48Component::sendSync2(){
-  std::vector<uint8_t> data = {0x04, 0xF0, 0x5A, 00, 00, 00, 00, 00};
-  this->canbus->send_data(CAN_ID_SYNC2, true, data);
+  this->send_frame_(CAN_ID_SYNC2, EMR48_SYNC2);
 }
 
 void EmersonR48Component::gimme5(){
-  std::vector<uint8_t> data = {0x20, 0xF0, 00, 0x80, 00, 00, 00, 00};
-  this->canbus->send_data(CAN_ID_GIMME5, true, data);
+  this->send_frame_(CAN_ID_GIMME5, EMR48_GIMME5);
 }
 
 
 void EmersonR48Component::setup() {
-  Automation<std::vector<uint8_t>, uint32_t, bool> *automation;
-  LambdaAction<std::vector<uint8_t>, uint32_t, bool> *lambdaaction;
-  canbus::CanbusTrigger *canbus_canbustrigger;
-
-  // catch all received messages
-  canbus_canbustrigger = new canbus::CanbusTrigger(this->canbus, 0, 0, true);
-  canbus_canbustrigger->set_component_source("canbus");
-  App.register_component(canbus_canbustrigger);
-  automation = new Automation<std::vector<uint8_t>, uint32_t, bool>(canbus_canbustrigger);
-  auto cb = [=](std::vector<uint8_t> x, uint32_t can_id, bool remote_transmission_request) -> void {
-    this->on_frame(can_id, remote_transmission_request, x);
-  };
-  lambdaaction = new LambdaAction<std::vector<uint8_t>, uint32_t, bool>(cb);
-  automation->add_actions({lambdaaction});
+  if (this->frame_source_ != nullptr) {
+    this->frame_source_->add_frame_listener(this);
+  } else {
+    // the trigger is not registered as a component, its only job in setup() is to attach to the bus
+    this->canbus->add_trigger(&this->frame_trigger_);
+    this->frame_automation_.add_actions({&this->frame_action_});
+  }
 
-  this->sendSync();
-  this->gimme5();
+  if (this->restore_key_ != 0)
+    this->restore_setpoints_();
+}
+
+// Sync and the restored setpoints go out back to back right after setup, before the first poll, so the
+// rectifiers are only on their offline defaults for the first few tens of ms after a reboot
+void EmersonR48Component::loop() {
+  this->expire_reads_();
+  if (this->startup_step_ >= EMR48_STARTUP_STEPS) {
+    this->refresh_online_setpoints_();
+    return;
+  }
+  uint32_t now = millis();
+  if (this->startup_last_ != 0 && now - this->startup_last_ < EMR48_STARTUP_STEP_MS)
+    return;
+  if (this->run_startup_step_(this->startup_step_)) {
+    this->startup_step_++;
+  } else if (now > EMR48_STARTUP_TIMEOUT_MS) {
+    ESP_LOGW(TAG, "CAN bus not ready, skipping the rest of the startup sequence");
+    this->startup_step_ = EMR48_STARTUP_STEPS;
+  }
+  this->startup_last_ = now | 1;
+  if (this->startup_step_ >= EMR48_STARTUP_STEPS) {
+    ESP_LOGD(TAG, "Startup sequence done after %u ms", (unsigned) now);
+    this->stale_epoch_ = now;
+  }
+}
+
+// false if the frame could not be sent
+bool EmersonR48Component::run_startup_step_(uint8_t step) {
+  uint8_t data[EMR48_FRAME_LENGTH];
+  switch (step) {
+    case 0:
+      return this->send_frame_(CAN_ID_SYNC, EMR48_SYNC);
+    case 1:
+      return this->send_frame_(CAN_ID_GIMME5, EMR48_GIMME5);
+    case 2:
+      encode_control(this->control_bits(), data);
+      return this->send_frame_(CAN_ID_SET_CTL, data, "startup control");
+    case 3:
+      if (std::isnan(this->setpoints_.output_voltage) ||
+          !encode_output_voltage(this->setpoints_.output_voltage, this->setpoints_.output_voltage_offline, data))
+        return true;
+      if (!this->send_frame_(CAN_ID_SET, data, "startup output voltage"))
+        return false;
+      this->voltage_refreshed_ = this->setpoints_.output_voltage_offline ? 0 : millis() | 1;
+      return true;
+    case 4:
+      if (std::isnan(this->setpoints_.max_output_current) ||
+          !encode_max_output_current(this->setpoints_.max_output_current,
+                                     this->setpoints_.max_output_current_offline, data))
+        return true;
+      if (!this->send_frame_(CAN_ID_SET, data, "startup max output current"))
+        return false;
+      this->current_refreshed_ = this->setpoints_.max_output_current_offline ? 0 : millis() | 1;
+      return true;
+    case 5:
+      if (std::isnan(this->setpoints_.max_input_current) ||
+          !encode_max_input_current(this->setpoints_.max_input_current, data))
+        return true;
+      return this->send_frame_(CAN_ID_SET, data, "startup max input current");
+    default:
+      return true;
+  }
+}
+
+void EmersonR48Component::restore_setpoints_() {
+  this->setpoint_pref_ = global_preferences->make_preference<SetpointState>(this->restore_key_, true);
+  SetpointState state;
+  if (!this->setpoint_pref_.load(&state))
+    return;
+  this->setpoints_ = state;
+  this->saved_setpoints_ = state;
+  this->acOff_ = state.ac_off;
+  this->dcOff_ = state.dc_off;
+  this->fanFull_ = state.fan_full;
+  this->flashLed_ = state.flash_led;
+  ESP_LOGD(TAG, "Restored setpoints: %.2f V, %.1f %%, input %.1f A, control %02X", state.output_voltage,
+           state.max_output_current, state.max_input_current, this->control_bits());
+#ifdef USE_EMERSON_R48_OUTPUT_VOLTAGE_NUMBER
+  if (!std::isnan(state.output_voltage))
+    this->publish_number_state_(this->output_voltage_number_, state.output_voltage);
+#endif
+#ifdef USE_EMERSON_R48_MAX_OUTPUT_CURRENT_NUMBER
+  if (!std::isnan(state.max_output_current))
+    this->publish_number_state_(this->max_output_current_number_, state.max_output_current);
+#endif
+#ifdef USE_EMERSON_R48_MAX_INPUT_CURRENT_NUMBER
+  if (!std::isnan(state.max_input_current))
+    this->publish_number_state_(this->max_input_current_number_, state.max_input_current);
+#endif
+}
+
+// Called on every setpoint and control frame; preferences only see actual changes
+void EmersonR48Component::save_setpoints_() {
+  if (this->restore_key_ == 0)
+    return;
+  this->setpoints_.ac_off = this->acOff_;
+  this->setpoints_.dc_off = this->dcOff_;
+  this->setpoints_.fan_full = this->fanFull_;
+  this->setpoints_.flash_led = this->flashLed_;
+  if (memcmp(&this->setpoints_, &this->saved_setpoints_, sizeof(SetpointState)) == 0)
+    return;
+  this->saved_setpoints_ = this->setpoints_;
+  this->setpoint_pref_.save(&this->saved_setpoints_);
+}
 
+// The restored and the last online setpoints would fall back to the offline values 30 s after their last
+// frame, so each is repeated every 15 s for as long as it is in use (not while the node sleeps)
+void EmersonR48Component::refresh_online_setpoints_() {
+  if (this->voltage_refreshed_ == 0 && this->current_refreshed_ == 0)
+    return;
+  if (this->frame_source_ != nullptr && this->frame_source_->is_sleeping())
+    return;
+  const uint32_t now = millis();
+  uint8_t data[EMR48_FRAME_LENGTH];
+  if (this->voltage_refreshed_ != 0 && now - this->voltage_refreshed_ >= EMR48_ONLINE_REFRESH_MS &&
+      encode_output_voltage(this->setpoints_.output_voltage, false, data) &&
+      this->send_frame_(CAN_ID_SET, data, "refresh output voltage"))
+    this->voltage_refreshed_ = now | 1;
+  if (this->current_refreshed_ != 0 && now - this->current_refreshed_ >= EMR48_ONLINE_REFRESH_MS &&
+      encode_max_output_current(this->setpoints_.max_output_current, false, data) &&
+      this->send_frame_(CAN_ID_SET, data, "refresh max output current"))
+    this->current_refreshed_ = now | 1;
 }
 
 void EmersonR48Component::update() {
-  static uint8_t cnt = 0;
-  cnt++;
-
-  if (cnt == 1) {
-    ESP_LOGD(TAG, "Requesting output voltage message");
-    std::vector<uint8_t> data = {0x01, 0xF0, 0x00, 0x01, 0x00, 0x00, 0x00, 0x00};
-    this->canbus->send_data(CAN_ID_REQUEST, true, data);
-  }
-  if (cnt == 2) {
-    ESP_LOGD(TAG, "Requesting output current message");
-    std::vector<uint8_t> data = {0x01, 0xF0, 0x00, 0x02, 0x00, 0x00, 0x00, 0x00};
-    this->canbus->send_data(CAN_ID_REQUEST, true, data);
-  }
-  if (cnt == 3) {
-    ESP_LOGD(TAG, "Requesting output current limit message");
-    std::vector<uint8_t> data = {0x01, 0xF0, 0x00, 0x03, 0x00, 0x00, 0x00, 0x00};
-    this->canbus->send_data(CAN_ID_REQUEST, true, data);
-  }
-  if (cnt == 4) {
-    ESP_LOGD(TAG, "Requesting temperature (C) message");
-    std::vector<uint8_t> data = {0x01, 0xF0, 0x00, 0x04, 0x00, 0x00, 0x00, 0x00};
-    this->canbus->send_data(CAN_ID_REQUEST, true, data);
-  }
-  if (cnt == 5) {
-    ESP_LOGD(TAG, "Requesting supply voltage message");
-    std::vector<uint8_t> data = {0x01, 0xF0, 0x00, 0x05, 0x00, 0x00, 0x00, 0x00};
-    this->canbus->send_data(CAN_ID_REQUEST, true, data);
-  }
-//  if (cnt == 6) {
-//    ESP_LOGD(TAG, "Requesting all 5 message");
-//    std::vector<uint8_t> data = {0x00, 0xF0, 0x00, 0x80, 0x46, 0xA5, 0x34, 0x00};
-//    this->canbus->send_data(CAN_ID_REQUEST, true, data);
-//  }
-
-  if (cnt == 6) { 
-    cnt = 0; 
-    // send control every 10 seconds
-    uint8_t msgv = this->dcOff_ << 7 | this->fanFull_ << 4 | this->flashLed_ << 3 | this->acOff_ << 2 | 1;
-    this->set_control(msgv);
-
-    if (millis() - this->lastCtlSent_ > 10000) {
-
-      this->lastCtlSent_ = millis();
-    }
+  if (this->startup_step_ < EMR48_STARTUP_STEPS)
+    return;
+  if (this->frame_source_ != nullptr && this->frame_source_->is_sleeping())
+    return;
+  if (this->enter_sleep_())
+    return;
+  if (this->skip_poll_tick_())
+    return;
+  this->check_freshness_();
+
+  // position in the poll cycle: ticks 1..count request one parameter each, the last one sends the control bits
+  const uint8_t tick = ++this->poll_index_;
+  if (tick == 1) {
+    this->start_poll_cycle_();
+    if (++this->poll_cycles_ % EMR48_TIMING_LOG_CYCLES == 0)
+      this->log_response_stats();
+    // without sensors nothing is polled, one output voltage read per cycle tells whether the rectifiers answer
+    if (EMR48_POLL_LIST.count == 0)
+      this->send_read_request_(EMR48_DATA_OUTPUT_V, false);
   }
 
+  if (tick <= EMR48_POLL_LIST.count) {
+    const ParamDef &param = EMR48_PARAMS[EMR48_POLL_LIST.index[tick - 1]];
+    ESP_LOGD(TAG, "Requesting %s message", param.name);
+    this->send_read_request_(param.id, true);
+    return;
+  }
 
-  // no new value for 5* intervall -> set sensors to NAN)
-  if (millis() - lastUpdate_ > this->update_interval_ * 10 && cnt == 0) {
-    this->publish_sensor_state_(this->input_power_sensor_, NAN);
-    this->publish_sensor_state_(this->input_voltage_sensor_, NAN);
-    this->publish_sensor_state_(this->input_current_sensor_, NAN);
-    this->publish_sensor_state_(this->input_temp_sensor_, NAN);
-    this->publish_sensor_state_(this->input_frequency_sensor_, NAN);
-    this->publish_sensor_state_(this->output_power_sensor_, NAN);
-    this->publish_sensor_state_(this->output_current_sensor_, NAN);
-    this->publish_sensor_state_(this->output_voltage_sensor_, NAN);
-    this->publish_sensor_state_(this->output_temp_sensor_, NAN);
-    this->publish_sensor_state_(this->efficiency_sensor_, NAN);
-    this->publish_number_state_(this->max_output_current_number_, NAN);
+  this->poll_index_ = 0;
+  this->set_control(this->control_bits());
+  this->publish_heap_stats_();
+}
 
-    this->sendSync();
-    this->gimme5();
+// A parameter without a reply for its max age goes NAN on its own, the others keep their values. Only when
+// none answers at all (without sensors: no data frame for the default max age) are the rectifiers re-synced,
+// first right away, then at doubling intervals.
+void EmersonR48Component::check_freshness_() {
+  const uint32_t now = millis();
+  const uint32_t default_max_age = this->update_interval_ * 10 << this->poll_backoff_;
+  bool all_missing = EMR48_POLL_LIST.count > 0;
+  for (uint8_t i = 0; i < EMR48_POLL_LIST.count; i++) {
+    ParamTiming &timing = this->timing_[i];
+    // whichever is more recent: the last reply or the (re)start of polling
+    uint32_t age = now - this->stale_epoch_;
+    if (timing.seen_ms != 0 && now - timing.seen_ms < age)
+      age = now - timing.seen_ms;
+    if (age <= (timing.max_age_ms != 0 ? timing.max_age_ms : default_max_age)) {
+      all_missing = false;
+      continue;
+    }
+    if (timing.stale)
+      continue;
+    const ParamDef &param = EMR48_PARAMS[EMR48_POLL_LIST.index[i]];
+    ESP_LOGW(TAG, "%s: no reply for %u ms", param.name, (unsigned) age);
+    timing.stale = true;
+    this->publish_sensor_state_(this->sensor_(param.sensor), NAN);
+    this->pending_snapshot_.values[param.sensor] = NAN;
+    this->snapshot_dirty_ = true;
+  }
+  if (EMR48_POLL_LIST.count == 0) {
+    uint32_t age = now - this->stale_epoch_;
+    if (this->last_reply_ms_ != 0 && now - this->last_reply_ms_ < age)
+      age = now - this->last_reply_ms_;
+    all_missing = age > default_max_age;
   }
-}
 
-// Function to convert float to byte array
-void float_to_bytearray(float value, uint8_t *bytes) {
-    uint32_t temp;
-    memcpy(&temp, &value, sizeof(temp));
-    bytes[0] = (temp >> 24) & 0xFF; // Most significant byte
-    bytes[1] = (temp >> 16) & 0xFF;
-    bytes[2] = (temp >> 8) & 0xFF;
-    bytes[3] = temp & 0xFF; // Least significant byte
+  if (!all_missing) {
+    this->resync_interval_ = 0;
+    return;
+  }
+  if (this->resync_interval_ != 0 && now - this->last_resync_ < this->resync_interval_)
+    return;
+  if (this->resync_interval_ == 0) {
+#ifdef USE_EMERSON_R48_MAX_OUTPUT_CURRENT_NUMBER
+    this->publish_number_state_(this->max_output_current_number_, NAN);
+#endif
+    this->resync_interval_ = default_max_age;
+  } else {
+    this->resync_interval_ = std::min(this->resync_interval_ * 2, EMR48_MAX_RESYNC_INTERVAL_MS);
+  }
+  ESP_LOGW(TAG, "No rectifier replies, resyncing (next attempt in %u s)", (unsigned) (this->resync_interval_ / 1000));
+  this->last_resync_ = now;
+  this->sendSync();
+  this->gimme5();
 }
 
+void EmersonR48Component::set_max_age(SensorSlot slot, uint32_t max_age_ms) {
+  for (uint8_t i = 0; i < EMR48_POLL_LIST.count; i++) {
+    if (EMR48_PARAMS[EMR48_POLL_LIST.index[i]].sensor == slot) {
+      this->timing_[i].max_age_ms = max_age_ms;
+      return;
+    }
+  }
+  // sensor.py only offers max_age on polled sensors
+  ESP_LOGE(TAG, "max_age of sensor slot %u ignored: the sensor is not polled", (unsigned) slot);
+}
 
 // https://github.com/PurpleAlien/R48_Rectifier/blob/main/rectifier.py
 // # Set the output voltage to the new value. 
@@ -169,30 +311,25 @@ void float_to_bytearray(float value, uint8_t *bytes) {
 //        print(f"Voltage should be between {OUTPUT_VOLTAGE_MIN}V and {OUTPUT_VOLTAGE_MAX}V")
 
 void EmersonR48Component::set_output_voltage(float value, bool offline) {
-  int32_t raw = 0;
-  if (value > EMR48_OUTPUT_VOLTAGE_MIN && value < EMR48_OUTPUT_VOLTAGE_MAX) {
-    memcpy(&raw, &value, sizeof(raw));
-    uint8_t p = offline ? 0x24 : 0x21;
-    std::vector<uint8_t> data = {
-        0x03, 0xF0, 0x0, p, (uint8_t) (raw >> 24), (uint8_t) (raw >> 16), (uint8_t) (raw >> 8), (uint8_t) raw};
-    this->canbus->send_data(CAN_ID_SET, true, data);
-
-    size_t length = data.size();
-    char buffer[3 * length + 1];
-
-    // Format the data into the buffer
-    size_t pos = 0;
-    for (size_t i = 0; i < length; ++i) {
-        pos += snprintf(buffer + pos, sizeof(buffer) - pos, "%02x ", data[i]);
+  uint8_t data[EMR48_FRAME_LENGTH];
+  if (encode_output_voltage(value, offline, data)) {
+    this->send_frame_(CAN_ID_SET, data, "sent can_message.data");
+    this->setpoints_.output_voltage = value;
+    this->setpoints_.output_voltage_offline = offline;
+    this->save_setpoints_();
+#ifdef USE_EMERSON_R48_OUTPUT_VOLTAGE_NUMBER
+    this->publish_number_state_(this->output_voltage_number_, value);
+#endif
+    // an offline value holds by itself, an online one is refreshed until replaced
+    this->voltage_refreshed_ = offline ? 0 : millis() | 1;
+    // online setpoints are repeated, only a new value starts a latency measurement
+    if (value != this->setpoint_target_) {
+      this->setpoint_target_ = value;
+      this->setpoint_changed_ = millis();
     }
-
-    // Log the entire line
-    ESP_LOGD(TAG, "sent can_message.data: %s", buffer);
-
   } else {
     ESP_LOGD(TAG, "set output voltage is out of range: %f", value);
   }
-
 }
 
 //# The output current is set as a value
@@ -225,56 +362,34 @@ void EmersonR48Component::set_output_voltage(float value, bool offline) {
 
 // Function to set current percentage
 void EmersonR48Component::set_max_output_current(float value, bool offline) {
-
-    if (value >= EMR48_OUTPUT_CURRENT_RATED_PERCENTAGE_MIN && value <= EMR48_OUTPUT_CURRENT_RATED_PERCENTAGE_MAX) {
-        float limit = value / 100.0f;
-        uint8_t byte_array[4];
-        float_to_bytearray(limit, byte_array);
-        
-        uint8_t p = offline ? 0x19 : 0x22;
-        std::vector<uint8_t> data = { 0x03, 0xF0, 0x00, p, byte_array[0], byte_array[1], byte_array[2], byte_array[3] };
-        
-        this->canbus->send_data(CAN_ID_SET, true, data);
-        //this->canbus->send_data(CAN_ID_SET2, true, data);
-
-        size_t length = data.size();
-        char buffer[3 * length + 1];
-
-        // Format the data into the buffer
-        size_t pos = 0;
-        for (size_t i = 0; i < length; ++i) {
-            pos += snprintf(buffer + pos, sizeof(buffer) - pos, "%02x ", data[i]);
-        }
-
-        // Log the entire line
-        ESP_LOGD(TAG, "max_output_current: sent can_message.data: %s", buffer);
-
-    } else {
-        ESP_LOGD(TAG, "Current should be between 10 and 121\n");
-    }
+  uint8_t data[EMR48_FRAME_LENGTH];
+  if (encode_max_output_current(value, offline, data)) {
+    this->send_frame_(CAN_ID_SET, data, "max_output_current: sent can_message.data");
+    this->setpoints_.max_output_current = value;
+    this->setpoints_.max_output_current_offline = offline;
+    this->save_setpoints_();
+#ifdef USE_EMERSON_R48_MAX_OUTPUT_CURRENT_NUMBER
+    this->publish_number_state_(this->max_output_current_number_, value);
+#endif
+    this->current_refreshed_ = offline ? 0 : millis() | 1;
+    // this->send_frame_(CAN_ID_SET2, data, ...);
+  } else {
+    ESP_LOGD(TAG, "Current should be between 10 and 121\n");
+  }
 }
 
 void EmersonR48Component::set_max_input_current(float value) {
-
-    uint8_t byte_array[4];
-    float_to_bytearray(value, byte_array);
-    
-    std::vector<uint8_t> data = { 0x03, 0xF0, 0x00, 0x1A, byte_array[0], byte_array[1], byte_array[2], byte_array[3] };
-    
-    this->canbus->send_data(CAN_ID_SET, true, data);
-
-    size_t length = data.size();
-    char buffer[3 * length + 1];
-
-    // Format the data into the buffer
-    size_t pos = 0;
-    for (size_t i = 0; i < length; ++i) {
-        pos += snprintf(buffer + pos, sizeof(buffer) - pos, "%02x ", data[i]);
-    }
-
-    // Log the entire line
-    ESP_LOGD(TAG, "max_input_current, sent can_message.data: %s", buffer);
-
+  uint8_t data[EMR48_FRAME_LENGTH];
+  if (encode_max_input_current(value, data)) {
+    this->send_frame_(CAN_ID_SET, data, "max_input_current, sent can_message.data");
+    this->setpoints_.max_input_current = value;
+    this->save_setpoints_();
+#ifdef USE_EMERSON_R48_MAX_INPUT_CURRENT_NUMBER
+    this->publish_number_state_(this->max_input_current_number_, value);
+#endif
+  } else {
+    ESP_LOGD(TAG, "set max input current is out of range: %f", value);
+  }
 }
 
 /*
@@ -297,12 +412,16 @@ void EmersonR48Component::set_max_output_current2(float value, bool offline) {
 
 
 void EmersonR48Component::set_offline_values() {
+#ifdef USE_EMERSON_R48_OUTPUT_VOLTAGE_NUMBER
   if (output_voltage_number_) {
     set_output_voltage(output_voltage_number_->state, true);
   };
+#endif
+#ifdef USE_EMERSON_R48_MAX_OUTPUT_CURRENT_NUMBER
   if (max_output_current_number_) {
     set_max_output_current(max_output_current_number_->state, true);
   }
+#endif
 }
 
 // https://github.com/anikrooz/Emerson-Vertiv-R48/blob/main/standalone/chargerManager/chargerManager.ino
@@ -315,83 +434,404 @@ void EmersonR48Component::set_offline_values() {
 //}
 
 void EmersonR48Component::set_control(uint8_t msgv) {
-  uint8_t msg[8] = {0, 0xF0, msgv, 0x80, 0, 0, 0, 0};
+  uint8_t data[EMR48_FRAME_LENGTH];
+  encode_control(msgv, data);
+  this->send_frame_(CAN_ID_SET_CTL, data, "sent control can_message.data");
+  this->save_setpoints_();
+}
+
+void EmersonR48Component::set_control_flags(bool ac_off, bool dc_off, bool fan_full, bool flash_led) {
+  this->acOff_ = ac_off;
+  this->dcOff_ = dc_off;
+  this->fanFull_ = fan_full;
+  this->flashLed_ = flash_led;
+  this->set_control(this->control_bits());
+  this->publish_switch_state_(this->ac_switch_, ac_off);
+  this->publish_switch_state_(this->dc_switch_, dc_off);
+  this->publish_switch_state_(this->fan_switch_, fan_full);
+  this->publish_switch_state_(this->led_switch_, flash_led);
+}
+
+uint8_t EmersonR48Component::control_bits() const {
+  return encode_control_bits(this->dcOff_, this->fanFull_, this->flashLed_, this->acOff_);
+}
 
-  std::vector<uint8_t> data = { 0x00, 0xF0, msgv, 0x80, 0, 0, 0, 0 };
-  
-  this->canbus->send_data(CAN_ID_SET_CTL, true, data);
+void EmersonR48Component::on_frame(uint32_t can_id, bool rtr, std::vector<uint8_t> &data) {
+  // the canbus trigger carries no reception time
+  this->handle_frame_(can_id, data.data(), data.size(), micros());
+}
 
-  size_t length = data.size();
-  char buffer[3 * length + 1];
+// Everything the driver drained in one go is decoded and published in a single pass
+void EmersonR48Component::on_frames(const canbus::CanFrame *frames, const uint32_t *timestamps_us, size_t count) {
+  for (size_t i = 0; i < count; i++) {
+    const canbus::CanFrame &frame = frames[i];
+    if (!frame.use_extended_id || frame.remote_transmission_request)
+      continue;
+    this->handle_frame_(frame.can_id, frame.data, frame.can_data_length_code, timestamps_us[i]);
+  }
+}
 
-  // Format the data into the buffer
-  size_t pos = 0;
-  for (size_t i = 0; i < length; ++i) {
-      pos += snprintf(buffer + pos, sizeof(buffer) - pos, "%02x ", data[i]);
+void EmersonR48Component::handle_frame_(uint32_t can_id, const uint8_t *data, size_t length, uint32_t timestamp_us) {
+  this->log_frame_("received can_message.data", data, length);
+  if (can_id == CAN_ID_DATA)
+    this->last_reply_ms_ = millis() | 1;  // 0 means never
+
+  uint8_t param_id;
+  float raw_value;
+  if (decode_data_reply(can_id, data, length, &param_id, &raw_value))
+    this->cache_reply_(param_id, raw_value);
+
+  float conv_value;
+  const ParamDef *param = decode_data_frame(can_id, data, length, &conv_value);
+  if (param == nullptr)
+    return;
+
+  this->publish_sensor_state_(this->sensor_(param->sensor), conv_value);
+  ESP_LOGV(TAG, "%s: %f", param->name, conv_value);
+  if (param->sensor != SENSOR_NONE) {
+    this->pending_snapshot_.values[param->sensor] = conv_value;
+    // when the driver received the frame, not when a batch got around to decoding it; 0 means none
+    this->pending_snapshot_.sample_ms[param->sensor] = (millis() - (micros() - timestamp_us) / 1000) | 1;
+    this->snapshot_dirty_ = true;
   }
+  this->track_reply_(param, conv_value);
+
+  ParamTiming *timing = this->find_timing_(param->id);
+  if (timing != nullptr) {
+    timing->sample_us = timestamp_us;
+    timing->seen_ms = millis() | 1;  // 0 means never
+    timing->stale = false;
+    if (timing->requested_us != 0) {
+      uint32_t response = timestamp_us - timing->requested_us;
+      timing->requested_us = 0;
+      timing->count++;
+      float delta = response - timing->response_mean_us;
+      timing->response_mean_us += delta / timing->count;
+      timing->response_m2 += delta * (response - timing->response_mean_us);
+      if (timing->count == 1 || response < timing->response_min_us)
+        timing->response_min_us = response;
+      if (response > timing->response_max_us)
+        timing->response_max_us = response;
+    }
+  }
+}
 
-  // Log the entire line
-  ESP_LOGD(TAG, "sent control can_message.data: %s", buffer);
+// Only poll requests are timed: an on-demand read of a polled id must not restart the poll's measurement
+void EmersonR48Component::send_read_request_(uint8_t param, bool poll) {
+  uint8_t data[EMR48_FRAME_LENGTH];
+  encode_read_request(param, data);
+  this->send_frame_(CAN_ID_REQUEST, data);
+  if (!poll)
+    return;
+  ParamTiming *timing = this->find_timing_(param);
+  if (timing != nullptr)
+    timing->requested_us = micros() | 1;  // 0 means no request outstanding
 }
 
-void EmersonR48Component::on_frame(uint32_t can_id, bool rtr, std::vector<uint8_t> &data) {
-  // Create a buffer to hold the formatted string
-  // Each byte is represented by two hex digits and a space, +1 for null terminator
-  size_t length = data.size();
-  char buffer[3 * length + 1];
+bool EmersonR48Component::read_parameter(uint8_t param_id, ParameterCallback &&callback, uint32_t ttl_ms) {
+  const uint32_t now = millis();
+  ParamCacheEntry *entry = this->cache_entry_(param_id, true);
+  if (entry == nullptr)
+    return false;
+  if (entry->received_ms != 0 && now - entry->received_ms <= ttl_ms) {
+    callback(param_id, entry->value);
+    return true;
+  }
+
+  PendingRead *slot = nullptr;
+  for (auto &read : this->pending_reads_) {
+    if (!read.callback) {
+      slot = &read;
+      break;
+    }
+  }
+  if (slot == nullptr)
+    return false;
+  slot->id = param_id;
+  slot->callback = std::move(callback);
+  this->pending_count_++;
+  if (entry->requested_ms == 0) {
+    ESP_LOGV(TAG, "Reading parameter 0x%02X", param_id);
+    this->send_read_request_(param_id, false);
+    entry->requested_ms = now | 1;  // 0 means no request outstanding
+  }
+  return true;
+}
+
+// A read the hub cannot take (every read slot or cache entry busy) publishes NAN rather than leaving the last
+// value standing as if it were current
+void EmersonR48ParameterSensor::update() {
+  if (!this->parent_->read_parameter(
+          this->param_id_, [this](uint8_t param_id, float value) { this->publish_state(value); }, this->ttl_ms_)) {
+    ESP_LOGW(TAG, "Read of parameter 0x%02X rejected, too many reads outstanding", this->param_id_);
+    this->publish_state(NAN);
+  }
+}
+
+// With create, an unknown id takes a free entry or the one idle the longest; nullptr if every entry waits for
+// a reply
+ParamCacheEntry *EmersonR48Component::cache_entry_(uint8_t param_id, bool create) {
+  ParamCacheEntry *victim = nullptr;
+  for (auto &entry : this->param_cache_) {
+    if (entry.used && entry.id == param_id)
+      return &entry;
+    if (!create || entry.requested_ms != 0)
+      continue;
+    if (victim == nullptr || (victim->used && (!entry.used || (int32_t) (entry.received_ms - victim->received_ms) < 0)))
+      victim = &entry;
+  }
+  if (victim == nullptr)
+    return nullptr;
+  *victim = ParamCacheEntry{param_id, true, NAN, 0, 0};
+  return victim;
+}
 
-  // Format the data into the buffer
+// Every parameter reply lands here, polled ones included, so a read of a polled parameter is usually served
+// from the cache
+void EmersonR48Component::cache_reply_(uint8_t param_id, float raw_value) {
+  ParamCacheEntry *entry = this->cache_entry_(param_id, false);
+  if (entry == nullptr)
+    return;
+  size_t index = param_index(param_id, PARAM_READ);
+  entry->value = index == EMR48_PARAM_COUNT ? raw_value : raw_value * EMR48_PARAMS[index].scale;
+  entry->received_ms = millis() | 1;  // 0 means none
+  entry->requested_ms = 0;
+  this->complete_reads_(param_id, entry->value);
+}
+
+void EmersonR48Component::complete_reads_(uint8_t param_id, float value) {
+  for (auto &read : this->pending_reads_) {
+    if (!read.callback || read.id != param_id)
+      continue;
+    // the slot is free again before the callback runs, it may well read the next parameter
+    ParameterCallback callback = std::move(read.callback);
+    read.callback = nullptr;
+    this->pending_count_--;
+    callback(param_id, value);
+  }
+}
+
+void EmersonR48Component::expire_reads_() {
+  if (this->pending_count_ == 0)
+    return;
+  const uint32_t now = millis();
+  for (auto &entry : this->param_cache_) {
+    if (entry.requested_ms == 0 || now - entry.requested_ms <= EMR48_READ_TIMEOUT_MS)
+      continue;
+    ESP_LOGD(TAG, "No reply to the read of parameter 0x%02X", entry.id);
+    entry.requested_ms = 0;
+    this->complete_reads_(entry.id, NAN);
+  }
+}
+
+ParamTiming *EmersonR48Component::find_timing_(uint8_t param_id) {
+  for (uint8_t i = 0; i < EMR48_POLL_LIST.count; i++) {
+    if (EMR48_PARAMS[EMR48_POLL_LIST.index[i]].id == param_id)
+      return &this->timing_[i];
+  }
+  return nullptr;
+}
+
+const ParamTiming *EmersonR48Component::get_timing(uint8_t param_id) const {
+  return const_cast<EmersonR48Component *>(this)->find_timing_(param_id);
+}
+
+uint32_t EmersonR48Component::get_sample_age_ms(uint8_t param_id) const {
+  const ParamTiming *timing = this->get_timing(param_id);
+  if (timing == nullptr || timing->sample_us == 0)
+    return UINT32_MAX;
+  return (micros() - timing->sample_us) / 1000;
+}
+
+void EmersonR48Component::log_response_stats() {
+  for (uint8_t i = 0; i < EMR48_POLL_LIST.count; i++) {
+    const ParamTiming &timing = this->timing_[i];
+    if (timing.count == 0)
+      continue;
+    float jitter = timing.count > 1 ? sqrtf(timing.response_m2 / (timing.count - 1)) : 0.0f;
+    ESP_LOGD(TAG, "%s: %u replies, response %.2f ms (min %.2f, max %.2f), jitter %.2f ms",
+             EMR48_PARAMS[EMR48_POLL_LIST.index[i]].name, (unsigned) timing.count, timing.response_mean_us / 1000.0f,
+             timing.response_min_us / 1000.0f, timing.response_max_us / 1000.0f, jitter / 1000.0f);
+  }
+}
+
+bool EmersonR48Component::send_frame_(uint32_t can_id, const uint8_t *data, const char *what) {
+  // any local command ends the sleep
+  if (this->frame_source_ != nullptr && this->frame_source_->is_sleeping()) {
+    this->frame_source_->request_wake();
+    this->resume_();
+  }
+  // assign() into the reserved buffer does not allocate
+  this->tx_data_.assign(data, data + EMR48_FRAME_LENGTH);
+  canbus::Error error = this->canbus->send_data(can_id, true, this->tx_data_);
+  if (what != nullptr)
+    this->log_frame_(what, data, EMR48_FRAME_LENGTH);
+  return error == canbus::ERROR_OK;
+}
+
+void EmersonR48Component::log_frame_(const char *what, const uint8_t *data, size_t length) {
+  // Each byte is represented by two hex digits and a space, +1 for null terminator
+  char buffer[3 * EMR48_FRAME_LENGTH + 1];
   size_t pos = 0;
-  for (size_t i = 0; i < length; ++i) {
-      pos += snprintf(buffer + pos, sizeof(buffer) - pos, "%02x ", data[i]);
-  }
-
-  // Log the entire line
-  ESP_LOGD(TAG, "received can_message.data: %s", buffer);
-
-  if (can_id == CAN_ID_DATA) {
-    uint32_t value = (data[4] << 24) + (data[5] << 16) + (data[6] << 8) + data[7];
-    float conv_value = 0;
-    memcpy(&conv_value, &value, sizeof(conv_value));
-    switch (data[3]) {
-      case EMR48_DATA_OUTPUT_V:
-        //conv_value = value / 1.0;
-        this->publish_sensor_state_(this->output_voltage_sensor_, conv_value);
-        ESP_LOGV(TAG, "Output voltage: %f", conv_value);
-        break;
-
-      case EMR48_DATA_OUTPUT_A:
-        //conv_value = value / 1.0;
-        this->publish_sensor_state_(this->output_current_sensor_, conv_value);
-        ESP_LOGV(TAG, "Output current: %f", conv_value);
-        break;
-
-      case EMR48_DATA_OUTPUT_AL:
-        conv_value = conv_value * 100.0;
-        //this->publish_number_state_(this->max_output_current_number_, conv_value);
-        this->publish_sensor_state_(this->max_output_current_sensor_, conv_value);
-        ESP_LOGV(TAG, "Output current limit: %f", conv_value);
-        break;
-
-      case EMR48_DATA_OUTPUT_T:
-        //conv_value = value / 1.0;
-        this->publish_sensor_state_(this->output_temp_sensor_, conv_value);
-        ESP_LOGV(TAG, "Temperature: %f", conv_value);
-        break;
-
-      case EMR48_DATA_OUTPUT_IV:
-        //conv_value = value / 1.0;
-        this->publish_sensor_state_(this->input_voltage_sensor_, conv_value);
-        ESP_LOGV(TAG, "Input voltage: %f", conv_value);
-
-        this->lastUpdate_ = millis();
-        break;
-
-      default:
-        // printf("Unknown parameter 0x%02X, 0x%04X\r\n",frame[1], value);
-        break;
+  buffer[0] = '\0';
+  for (size_t i = 0; i < length && i < EMR48_FRAME_LENGTH; ++i) {
+    pos += snprintf(buffer + pos, sizeof(buffer) - pos, "%02x ", data[i]);
+  }
+  ESP_LOGD(TAG, "%s: %s", what, buffer);
+}
+
+// While the bus is busier than bus_load_threshold the gap between poll ticks doubles with every busy window
+// (up to 2^EMR48_MAX_POLL_BACKOFF update intervals) and shrinks again once the load drops. Only the periodic
+// traffic slows down, setpoints and switch changes are still sent immediately.
+bool EmersonR48Component::skip_poll_tick_() {
+  if (this->frame_source_ == nullptr || std::isnan(this->bus_load_threshold_))
+    return false;
+  if (this->poll_skip_ > 0) {
+    this->poll_skip_--;
+    return true;
+  }
+  float load = this->frame_source_->get_bus_load();
+  uint8_t backoff = this->poll_backoff_;
+  if (load > this->bus_load_threshold_ && backoff < EMR48_MAX_POLL_BACKOFF) {
+    backoff++;
+  } else if (!(load > this->bus_load_threshold_) && backoff > 0) {
+    backoff--;
+  }
+  if (backoff != this->poll_backoff_)
+    ESP_LOGD(TAG, "Bus load %.1f %%, polling every %u update intervals", load, 1u << backoff);
+  this->poll_backoff_ = backoff;
+  this->poll_skip_ = (1 << backoff) - 1;
+  return false;
+}
+
+// With every rectifier switched AC-off nothing worth polling happens on the bus: after sleep_delay_ the
+// controller goes to sleep and update() stops. The control bits sent with the last poll cycle are not
+// refreshed while asleep.
+bool EmersonR48Component::enter_sleep_() {
+  if (this->sleep_delay_ == 0 || this->frame_source_ == nullptr || !this->acOff_) {
+    this->ac_off_since_ = 0;
+    return false;
+  }
+  uint32_t now = millis();
+  if (this->ac_off_since_ == 0) {
+    this->ac_off_since_ = now | 1;  // 0 means AC on
+    return false;
+  }
+  if (now - this->ac_off_since_ < this->sleep_delay_ || !this->frame_source_->request_sleep())
+    return false;
+  ESP_LOGI(TAG, "Rectifiers AC off for %u s, polling stopped until bus activity or a command",
+           (unsigned) (this->sleep_delay_ / 1000));
+  return true;
+}
+
+void EmersonR48Component::on_wake() {
+  ESP_LOGI(TAG, "Bus activity, resuming");
+  this->resume_();
+}
+
+// Starts over as after boot: the rectifiers are re-synced and the stale timeout and sleep delay restart
+void EmersonR48Component::resume_() {
+  this->ac_off_since_ = 0;
+  this->stale_epoch_ = millis();
+  this->poll_outstanding_ = 0;
+  this->poll_started_ = 0;
+  this->sendSync();
+  this->gimme5();
+}
+
+// Every polled parameter is outstanding from the start of the cycle: its requests go out one update() apart and
+// each is usually answered before the next is sent. Replies still outstanding when the next cycle starts count as
+// missed.
+void EmersonR48Component::start_poll_cycle_() {
+  if (this->snapshot_dirty_)
+    this->publish_snapshot_();
+  if (this->poll_started_ != 0) {
+    uint8_t missed = __builtin_popcount(this->poll_outstanding_);
+    if (missed > 0)
+      ESP_LOGD(TAG, "Poll cycle missed %u replies", missed);
+    this->poll_stats_.missed += missed;
+#ifdef USE_EMERSON_R48_MISSED_REPLIES_SENSOR
+    this->publish_sensor_state_(this->missed_replies_sensor_, missed);
+#endif
+  }
+  this->poll_outstanding_ = EMR48_POLL_MASK;
+  this->poll_started_ = millis();
+}
+
+void EmersonR48Component::publish_snapshot_() {
+  this->pending_snapshot_.sequence = this->snapshot_.sequence + 1;
+  this->pending_snapshot_.timestamp_ms = millis();
+  this->snapshot_ = this->pending_snapshot_;
+  this->snapshot_dirty_ = false;
+  this->snapshot_callback_.call(this->snapshot_);
+}
+
+// Poll cycle time runs from the first request to the last reply of the cycle, setpoint latency from a new
+// output voltage setpoint to the first read back within EMR48_SETPOINT_TOLERANCE_V; both are bounded below
+// by update_interval as every parameter is read once per cycle.
+void EmersonR48Component::track_reply_(const ParamDef *param, float value) {
+  uint32_t now = millis();
+  uint32_t bit = 1UL << param->id;
+  if (this->poll_outstanding_ & bit) {
+    this->poll_outstanding_ &= ~bit;
+    if (this->poll_outstanding_ == 0) {
+      const uint32_t poll_time = now - this->poll_started_;
+      ESP_LOGV(TAG, "Poll cycle completed in %u ms", (unsigned) poll_time);
+      this->poll_stats_.cycles++;
+      this->poll_stats_.poll_time_sum_ms += poll_time;
+      this->poll_stats_.poll_time_max_ms = std::max(this->poll_stats_.poll_time_max_ms, poll_time);
+#ifdef USE_EMERSON_R48_POLL_TIME_SENSOR
+      this->publish_sensor_state_(this->poll_time_sensor_, poll_time);
+#endif
+      this->publish_snapshot_();
     }
   }
+
+  if (param->id == EMR48_DATA_OUTPUT_V && this->setpoint_changed_ != 0 &&
+      fabsf(value - this->setpoint_target_) <= EMR48_SETPOINT_TOLERANCE_V) {
+    const uint32_t latency = now - this->setpoint_changed_;
+    ESP_LOGD(TAG, "Output voltage reached %.2f V after %u ms", this->setpoint_target_, (unsigned) latency);
+    this->poll_stats_.setpoints++;
+    this->poll_stats_.setpoint_latency_max_ms = std::max(this->poll_stats_.setpoint_latency_max_ms, latency);
+#ifdef USE_EMERSON_R48_SETPOINT_LATENCY_SENSOR
+    this->publish_sensor_state_(this->setpoint_latency_sensor_, latency);
+#endif
+    this->setpoint_changed_ = 0;
+  }
+}
+
+void EmersonR48Component::publish_heap_stats_() {
+  uint32_t free = 0, min_free = 0, max_block = 0;
+#if defined(USE_ESP8266)
+  free = ESP.getFreeHeap();
+  max_block = ESP.getMaxFreeBlockSize();
+  min_free = free;
+#elif defined(USE_ESP32)
+  free = heap_caps_get_free_size(MALLOC_CAP_INTERNAL);
+  max_block = heap_caps_get_largest_free_block(MALLOC_CAP_INTERNAL);
+  min_free = heap_caps_get_minimum_free_size(MALLOC_CAP_INTERNAL);
+#else
+  return;
+#endif
+  if (free == 0)
+    return;
+  ESP_LOGV(TAG, "Heap: free %u, largest block %u", (unsigned) free, (unsigned) max_block);
+
+#ifdef USE_EMERSON_R48_HEAP_FREE_SENSOR
+  this->publish_sensor_state_(this->heap_free_sensor_, free);
+#endif
+#ifdef USE_EMERSON_R48_HEAP_MIN_FREE_SENSOR
+  // ESP8266 has no allocator watermark, keep the lowest value sampled once per poll cycle
+  this->heap_min_free_ = std::min(this->heap_min_free_, min_free);
+  this->publish_sensor_state_(this->heap_min_free_sensor_, this->heap_min_free_);
+#endif
+#ifdef USE_EMERSON_R48_HEAP_MAX_BLOCK_SENSOR
+  this->publish_sensor_state_(this->heap_max_block_sensor_, max_block);
+#endif
+#ifdef USE_EMERSON_R48_HEAP_FRAGMENTATION_SENSOR
+  // same definition as ESP.getHeapFragmentation(): share of free heap not usable as one block
+  this->publish_sensor_state_(this->heap_fragmentation_sensor_, 100.0f - (100.0f * max_block) / free);
+#endif
 }
 
 void EmersonR48Component::publish_sensor_state_(sensor::Sensor *sensor, float value) {
@@ -406,6 +846,11 @@ void EmersonR48Component::publish_number_state_(number::Number *number, float va
   }
 }
 
+void EmersonR48Component::publish_switch_state_(switch_::Switch *sw, bool state) {
+  if (sw != nullptr && sw->state != state)
+    sw->publish_state(state);
+}
+
 }  // namespace huawei_r4850
 }  // namespace esphome
 
@@ -1,18 +1,183 @@
 #pragma once
 
+#include "esphome/core/automation.h"
+#include "esphome/core/base_automation.h"
 #include "esphome/core/component.h"
+#include "esphome/core/defines.h"
+#include "esphome/core/preferences.h"
 #include "esphome/components/sensor/sensor.h"
 #include "esphome/components/number/number.h"
 #include "esphome/components/switch/switch.h"
 #include "esphome/components/canbus/canbus.h"
+#include "esphome/components/canbus_ext/canbus_ext.h"
+#include "esphome/components/emerson_r48_protocol/emerson_r48_protocol.h"
 
 namespace esphome {
 namespace emerson_r48 {
 
-class EmersonR48Component : public PollingComponent {
+// Sensors present in the YAML config; sensor.py emits USE_EMERSON_R48_<NAME>_SENSOR for each of them.
+// Parameters without a configured sensor are neither polled nor given pointer storage.
+constexpr bool sensor_configured(SensorSlot slot) {
+  return false
+#ifdef USE_EMERSON_R48_INPUT_VOLTAGE_SENSOR
+         || slot == SENSOR_INPUT_VOLTAGE
+#endif
+#ifdef USE_EMERSON_R48_INPUT_FREQUENCY_SENSOR
+         || slot == SENSOR_INPUT_FREQUENCY
+#endif
+#ifdef USE_EMERSON_R48_INPUT_CURRENT_SENSOR
+         || slot == SENSOR_INPUT_CURRENT
+#endif
+#ifdef USE_EMERSON_R48_INPUT_POWER_SENSOR
+         || slot == SENSOR_INPUT_POWER
+#endif
+#ifdef USE_EMERSON_R48_INPUT_TEMP_SENSOR
+         || slot == SENSOR_INPUT_TEMP
+#endif
+#ifdef USE_EMERSON_R48_EFFICIENCY_SENSOR
+         || slot == SENSOR_EFFICIENCY
+#endif
+#ifdef USE_EMERSON_R48_OUTPUT_VOLTAGE_SENSOR
+         || slot == SENSOR_OUTPUT_VOLTAGE
+#endif
+#ifdef USE_EMERSON_R48_OUTPUT_CURRENT_SENSOR
+         || slot == SENSOR_OUTPUT_CURRENT
+#endif
+#ifdef USE_EMERSON_R48_MAX_OUTPUT_CURRENT_SENSOR
+         || slot == SENSOR_MAX_OUTPUT_CURRENT
+#endif
+#ifdef USE_EMERSON_R48_OUTPUT_POWER_SENSOR
+         || slot == SENSOR_OUTPUT_POWER
+#endif
+#ifdef USE_EMERSON_R48_OUTPUT_TEMP_SENSOR
+         || slot == SENSOR_OUTPUT_TEMP
+#endif
+      ;
+}
+
+static const uint8_t EMR48_SENSOR_UNUSED = 0xFF;
+
+// Maps a SensorSlot to its position in the compacted sensor storage, EMR48_SENSOR_UNUSED if not configured
+struct SensorIndex {
+  uint8_t index[SENSOR_COUNT];
+  uint8_t count;
+};
+
+constexpr SensorIndex make_sensor_index() {
+  SensorIndex map{};
+  for (uint8_t slot = 0; slot < SENSOR_COUNT; slot++) {
+    map.index[slot] = sensor_configured((SensorSlot) slot) ? map.count++ : EMR48_SENSOR_UNUSED;
+  }
+  return map;
+}
+
+static constexpr SensorIndex EMR48_SENSOR_INDEX = make_sensor_index();
+
+// Readable parameters that feed a configured sensor, in table order
+struct PollList {
+  uint8_t index[EMR48_READ_PARAM_COUNT > 0 ? EMR48_READ_PARAM_COUNT : 1];
+  uint8_t count;
+};
+
+constexpr PollList make_poll_list() {
+  PollList list{};
+  for (uint8_t i = 0; i < EMR48_PARAM_COUNT; i++) {
+    if (EMR48_PARAMS[i].direction == PARAM_READ && sensor_configured(EMR48_PARAMS[i].sensor))
+      list.index[list.count++] = i;
+  }
+  return list;
+}
+
+static constexpr PollList EMR48_POLL_LIST = make_poll_list();
+
+// One bit per parameter id of the poll list
+constexpr uint32_t make_poll_mask() {
+  uint32_t mask = 0;
+  for (uint8_t i = 0; i < EMR48_POLL_LIST.count; i++)
+    mask |= 1UL << EMR48_PARAMS[EMR48_POLL_LIST.index[i]].id;
+  return mask;
+}
+
+static constexpr uint32_t EMR48_POLL_MASK = make_poll_mask();
+
+// Reception time of the last sample and request-to-reply statistics of one polled parameter
+struct ParamTiming {
+  uint32_t sample_us;     // micros() at reception, see canbus_ext::FrameListener
+  uint32_t seen_ms;       // millis() at reception, 0 if never
+  uint32_t max_age_ms;    // sensor goes NAN without a reply for this long, 0: 10 update intervals
+  bool stale;
+  uint32_t requested_us;  // micros() when the outstanding request was sent, 0 if none
+  uint32_t count;
+  float response_mean_us;
+  float response_m2;  // sum of squared deviations (Welford), jitter = sqrt(m2 / (count - 1))
+  uint32_t response_min_us;
+  uint32_t response_max_us;
+};
+
+// Every polled value of one poll cycle, replaced as a whole when the cycle completes (or the next one starts
+// with replies missing). Indexed by SensorSlot; slots that are not polled stay NAN with sample_ms 0.
+struct TelemetrySnapshot {
+  uint32_t sequence;      // +1 per published snapshot, 0: none yet
+  uint32_t timestamp_ms;  // millis() at publication
+  float values[SENSOR_COUNT];
+  uint32_t sample_ms[SENSOR_COUNT];  // millis() at which the driver received each value, 0 if none
+  float get(SensorSlot slot) const { return this->values[slot]; }
+};
+
+// Poll cycle and setpoint delivery statistics since the last reset_poll_statistics(), for benchmarks such as
+// the emerson_r48_sim sweep
+struct PollStatistics {
+  uint32_t cycles;  // poll cycles in which every polled parameter answered
+  uint32_t missed;  // replies still outstanding when the next cycle started
+  uint32_t poll_time_max_ms;
+  uint64_t poll_time_sum_ms;
+  uint32_t setpoints;  // output voltage setpoints read back within tolerance
+  uint32_t setpoint_latency_max_ms;
+};
+
+// read_parameter() state of one parameter id
+struct ParamCacheEntry {
+  uint8_t id;
+  bool used;
+  float value;            // in user units, the table scale applied to ids in EMR48_PARAMS
+  uint32_t received_ms;   // millis() at the last reply, 0 if none
+  uint32_t requested_ms;  // millis() when the outstanding request was sent, 0 if none
+};
+
+static const uint8_t EMR48_PARAM_CACHE_SIZE = 16;
+static const uint8_t EMR48_MAX_PENDING_READS = 8;
+static const uint32_t EMR48_READ_TIMEOUT_MS = 1000;
+static const uint32_t EMR48_DEFAULT_READ_TTL_MS = 1000;
+
+using ParameterCallback = std::function<void(uint8_t param_id, float value)>;
+
+// Setpoints and control bits last asked for, kept in preferences and re-applied at boot. NAN: never set.
+// The offline flags tell how a setpoint was sent: an offline one is replayed offline and not refreshed.
+struct SetpointState {
+  float output_voltage;
+  float max_output_current;
+  float max_input_current;
+  bool ac_off;
+  bool dc_off;
+  bool fan_full;
+  bool flash_led;
+  bool output_voltage_offline;
+  bool max_output_current_offline;
+};
+
+class EmersonR48Component : public PollingComponent, public canbus_ext::FrameListener {
  public:
   EmersonR48Component(canbus::Canbus *canbus);
+  // Batched receive path, used instead of the catch-all trigger when the canbus driver provides it
+  void set_frame_source(canbus_ext::FrameSource *frame_source) { frame_source_ = frame_source; }
+  // Bus load in percent above which polling backs off, needs a frame source
+  void set_bus_load_threshold(float bus_load_threshold) { bus_load_threshold_ = bus_load_threshold; }
+  // Put the CAN controller to sleep once acOff_ has been set for this long, 0 disables, needs a frame source
+  void set_sleep_delay(uint32_t sleep_delay) { sleep_delay_ = sleep_delay; }
+  // Preference key of the persisted setpoints, 0 disables restoring them
+  void set_restore_key(uint32_t restore_key) { restore_key_ = restore_key; }
   void setup() override;
+  void loop() override;
   void update() override;
 
   void set_output_voltage(float value, bool offline = false);
@@ -20,74 +185,295 @@ class EmersonR48Component : public PollingComponent {
   void set_max_input_current(float value);
   void set_offline_values();
 
-  void set_input_voltage_sensor(sensor::Sensor *input_voltage_sensor) { input_voltage_sensor_ = input_voltage_sensor; }
+  // Age of the last value received for a read parameter (EMR48_DATA_*), UINT32_MAX if none yet
+  uint32_t get_sample_age_ms(uint8_t param_id) const;
+  const ParamTiming *get_timing(uint8_t param_id) const;
+  void set_max_age(SensorSlot slot, uint32_t max_age_ms);
+
+  // Value of any parameter id: answered from the cache when the last reply is at most ttl_ms old, otherwise
+  // from the reply to a read request, which concurrent reads of the same id share. The callback gets NAN if
+  // the rectifier does not answer within EMR48_READ_TIMEOUT_MS. False if the cache or the queue of pending
+  // reads is full, the callback is not called then.
+  bool read_parameter(uint8_t param_id, ParameterCallback &&callback, uint32_t ttl_ms = EMR48_DEFAULT_READ_TTL_MS);
+
+  // Values of the last poll cycle in one consistent copy
+  const TelemetrySnapshot &get_snapshot() const { return this->snapshot_; }
+  void add_on_snapshot_callback(std::function<void(const TelemetrySnapshot &)> &&callback) {
+    this->snapshot_callback_.add(std::move(callback));
+  }
+  // Latest value of every slot as decoded from the frames, ahead of the snapshot while a cycle runs
+  const TelemetrySnapshot &get_latest() const { return this->pending_snapshot_; }
+  // Setpoints last sent or restored
+  const SetpointState &get_setpoints() const { return this->setpoints_; }
+  const PollStatistics &get_poll_statistics() const { return this->poll_stats_; }
+  void reset_poll_statistics() { this->poll_stats_ = {}; }
+  void log_response_stats();
+
+  void set_input_voltage_sensor(sensor::Sensor *input_voltage_sensor) {
+    this->set_sensor_(SENSOR_INPUT_VOLTAGE, input_voltage_sensor);
+  }
   void set_input_frequency_sensor(sensor::Sensor *input_frequency_sensor) {
-    input_frequency_sensor_ = input_frequency_sensor;
+    this->set_sensor_(SENSOR_INPUT_FREQUENCY, input_frequency_sensor);
+  }
+  void set_input_current_sensor(sensor::Sensor *input_current_sensor) {
+    this->set_sensor_(SENSOR_INPUT_CURRENT, input_current_sensor);
+  }
+  void set_input_power_sensor(sensor::Sensor *input_power_sensor) {
+    this->set_sensor_(SENSOR_INPUT_POWER, input_power_sensor);
+  }
+  void set_input_temp_sensor(sensor::Sensor *input_temp_sensor) {
+    this->set_sensor_(SENSOR_INPUT_TEMP, input_temp_sensor);
+  }
+  void set_efficiency_sensor(sensor::Sensor *efficiency_sensor) {
+    this->set_sensor_(SENSOR_EFFICIENCY, efficiency_sensor);
   }
-  void set_input_current_sensor(sensor::Sensor *input_current_sensor) { input_current_sensor_ = input_current_sensor; }
-  void set_input_power_sensor(sensor::Sensor *input_power_sensor) { input_power_sensor_ = input_power_sensor; }
-  void set_input_temp_sensor(sensor::Sensor *input_temp_sensor) { input_temp_sensor_ = input_temp_sensor; }
-  void set_efficiency_sensor(sensor::Sensor *efficiency_sensor) { efficiency_sensor_ = efficiency_sensor; }
   void set_output_voltage_sensor(sensor::Sensor *output_voltage_sensor) {
-    output_voltage_sensor_ = output_voltage_sensor;
+    this->set_sensor_(SENSOR_OUTPUT_VOLTAGE, output_voltage_sensor);
   }
   void set_output_current_sensor(sensor::Sensor *output_current_sensor) {
-    output_current_sensor_ = output_current_sensor;
+    this->set_sensor_(SENSOR_OUTPUT_CURRENT, output_current_sensor);
   }
   void set_max_output_current_sensor(sensor::Sensor *max_output_current_sensor) {
-     max_output_current_sensor_ = max_output_current_sensor;
+    this->set_sensor_(SENSOR_MAX_OUTPUT_CURRENT, max_output_current_sensor);
+  }
+  void set_output_power_sensor(sensor::Sensor *output_power_sensor) {
+    this->set_sensor_(SENSOR_OUTPUT_POWER, output_power_sensor);
+  }
+  void set_output_temp_sensor(sensor::Sensor *output_temp_sensor) {
+    this->set_sensor_(SENSOR_OUTPUT_TEMP, output_temp_sensor);
   }
 
-  void set_output_power_sensor(sensor::Sensor *output_power_sensor) { output_power_sensor_ = output_power_sensor; }
-  void set_output_temp_sensor(sensor::Sensor *output_temp_sensor) { output_temp_sensor_ = output_temp_sensor; }
+#ifdef USE_EMERSON_R48_HEAP_FREE_SENSOR
+  void set_heap_free_sensor(sensor::Sensor *heap_free_sensor) { heap_free_sensor_ = heap_free_sensor; }
+#endif
+#ifdef USE_EMERSON_R48_HEAP_MIN_FREE_SENSOR
+  void set_heap_min_free_sensor(sensor::Sensor *heap_min_free_sensor) { heap_min_free_sensor_ = heap_min_free_sensor; }
+#endif
+#ifdef USE_EMERSON_R48_HEAP_MAX_BLOCK_SENSOR
+  void set_heap_max_block_sensor(sensor::Sensor *heap_max_block_sensor) {
+    heap_max_block_sensor_ = heap_max_block_sensor;
+  }
+#endif
+#ifdef USE_EMERSON_R48_HEAP_FRAGMENTATION_SENSOR
+  void set_heap_fragmentation_sensor(sensor::Sensor *heap_fragmentation_sensor) {
+    heap_fragmentation_sensor_ = heap_fragmentation_sensor;
+  }
+#endif
 
+#ifdef USE_EMERSON_R48_POLL_TIME_SENSOR
+  void set_poll_time_sensor(sensor::Sensor *poll_time_sensor) { poll_time_sensor_ = poll_time_sensor; }
+#endif
+#ifdef USE_EMERSON_R48_MISSED_REPLIES_SENSOR
+  void set_missed_replies_sensor(sensor::Sensor *missed_replies_sensor) {
+    missed_replies_sensor_ = missed_replies_sensor;
+  }
+#endif
+#ifdef USE_EMERSON_R48_SETPOINT_LATENCY_SENSOR
+  void set_setpoint_latency_sensor(sensor::Sensor *setpoint_latency_sensor) {
+    setpoint_latency_sensor_ = setpoint_latency_sensor;
+  }
+#endif
+
+#ifdef USE_EMERSON_R48_OUTPUT_VOLTAGE_NUMBER
   void set_output_voltage_number(number::Number *output_voltage_number) {
     output_voltage_number_ = output_voltage_number;
   }
+#endif
+#ifdef USE_EMERSON_R48_MAX_OUTPUT_CURRENT_NUMBER
   void set_max_output_current_number(number::Number *max_output_current_number) {
     max_output_current_number_ = max_output_current_number;
   }
+#endif
+#ifdef USE_EMERSON_R48_MAX_INPUT_CURRENT_NUMBER
   void set_max_input_current_number(number::Number *max_input_current_number) {
     max_input_current_number_ = max_input_current_number;
   }
+#endif
+
+  void set_ac_switch(switch_::Switch *ac_switch) { ac_switch_ = ac_switch; }
+  void set_dc_switch(switch_::Switch *dc_switch) { dc_switch_ = dc_switch; }
+  void set_fan_switch(switch_::Switch *fan_switch) { fan_switch_ = fan_switch; }
+  void set_led_switch(switch_::Switch *led_switch) { led_switch_ = led_switch; }
 
   void set_control(uint8_t msgv);
+  // Sets all four control flags at once (switches, Modbus): one control frame, saved, shown on the switches
+  void set_control_flags(bool ac_off, bool dc_off, bool fan_full, bool flash_led);
+  uint8_t control_bits() const;
 
   void sendSync();
   void sendSync2();
   void gimme5();
 
-  uint32_t lastCtlSent_;
-
-  boolean dcOff_ = 0;
-  boolean fanFull_ = 0;
-  boolean flashLed_ = 0;
-  boolean acOff_ = 0;
+  bool dcOff_ = false;
+  bool fanFull_ = false;
+  bool flashLed_ = false;
+  bool acOff_ = false;
 
  protected:
   canbus::Canbus *canbus;
-  uint32_t lastUpdate_;
-
-  sensor::Sensor *input_voltage_sensor_{nullptr};
-  sensor::Sensor *input_frequency_sensor_{nullptr};
-  sensor::Sensor *input_current_sensor_{nullptr};
-  sensor::Sensor *input_power_sensor_{nullptr};
-  sensor::Sensor *input_temp_sensor_{nullptr};
-  sensor::Sensor *efficiency_sensor_{nullptr};
-  sensor::Sensor *output_voltage_sensor_{nullptr};
-  sensor::Sensor *output_current_sensor_{nullptr};
-  sensor::Sensor *max_output_current_sensor_{nullptr};
-  sensor::Sensor *output_power_sensor_{nullptr};
-  sensor::Sensor *output_temp_sensor_{nullptr};
+  canbus_ext::FrameSource *frame_source_{nullptr};
+  // filled by the replies of the running cycle, copied to snapshot_ by publish_snapshot_()
+  TelemetrySnapshot pending_snapshot_{};
+  TelemetrySnapshot snapshot_{};
+  bool snapshot_dirty_{false};
+  CallbackManager<void(const TelemetrySnapshot &)> snapshot_callback_;
+
+  // staleness is measured from here for parameters not heard from since, reset at startup and resume
+  uint32_t stale_epoch_{0};
+  // resync attempts while no parameter answers at all, the interval doubles up to EMR48_MAX_RESYNC_INTERVAL_MS
+  uint32_t resync_interval_{0};
+  uint32_t last_resync_{0};
+  // last data frame of the rectifier, the liveness check when no parameter is polled
+  uint32_t last_reply_ms_{0};
+
+  ParamCacheEntry param_cache_[EMR48_PARAM_CACHE_SIZE]{};
+  struct PendingRead {
+    uint8_t id;
+    ParameterCallback callback;  // empty for a free slot
+  } pending_reads_[EMR48_MAX_PENDING_READS]{};
+  uint8_t pending_count_{0};
+
+  // Receive path and TX scratch buffer are owned by the component, nothing is allocated after setup()
+  using FrameArgs = std::vector<uint8_t>;
+  canbus::CanbusTrigger frame_trigger_;
+  Automation<FrameArgs, uint32_t, bool> frame_automation_;
+  LambdaAction<FrameArgs, uint32_t, bool> frame_action_;
+  std::vector<uint8_t> tx_data_;
+
+#ifdef USE_EMERSON_R48_HEAP_FREE_SENSOR
+  sensor::Sensor *heap_free_sensor_{nullptr};
+#endif
+#ifdef USE_EMERSON_R48_HEAP_MIN_FREE_SENSOR
+  sensor::Sensor *heap_min_free_sensor_{nullptr};
+  uint32_t heap_min_free_{UINT32_MAX};
+#endif
+#ifdef USE_EMERSON_R48_HEAP_MAX_BLOCK_SENSOR
+  sensor::Sensor *heap_max_block_sensor_{nullptr};
+#endif
+#ifdef USE_EMERSON_R48_HEAP_FRAGMENTATION_SENSOR
+  sensor::Sensor *heap_fragmentation_sensor_{nullptr};
+#endif
+
+#ifdef USE_EMERSON_R48_POLL_TIME_SENSOR
+  sensor::Sensor *poll_time_sensor_{nullptr};
+#endif
+#ifdef USE_EMERSON_R48_MISSED_REPLIES_SENSOR
+  sensor::Sensor *missed_replies_sensor_{nullptr};
+#endif
+#ifdef USE_EMERSON_R48_SETPOINT_LATENCY_SENSOR
+  sensor::Sensor *setpoint_latency_sensor_{nullptr};
+#endif
+
+  float bus_load_threshold_{NAN};
+  // poll ticks run on every 2^poll_backoff_-th update()
+  uint8_t poll_backoff_{0};
+  uint8_t poll_skip_{0};
+
+  uint32_t restore_key_{0};
+  ESPPreferenceObject setpoint_pref_;
+  SetpointState setpoints_{NAN, NAN, NAN, false, false, false, false, false, false};
+  SetpointState saved_setpoints_{NAN, NAN, NAN, false, false, false, false, false, false};
+  // boot sequence position, see run_startup_step_(); update() polls once it is done
+  uint8_t startup_step_{0};
+  uint32_t startup_last_{0};
+  // last send of the online voltage / current setpoint, 0 while there is none to refresh
+  uint32_t voltage_refreshed_{0};
+  uint32_t current_refreshed_{0};
+
+  uint32_t sleep_delay_{0};
+  uint32_t ac_off_since_{0};
+
+  ParamTiming timing_[EMR48_POLL_LIST.count > 0 ? EMR48_POLL_LIST.count : 1]{};
+  uint16_t poll_cycles_{0};
+  // update() ticks into the running poll cycle, 0 before the first one
+  uint8_t poll_index_{0};
 
+  // poll cycle bookkeeping: one bit per polled parameter id not answered yet in the running cycle
+  uint32_t poll_outstanding_{0};
+  uint32_t poll_started_{0};
+  // last output voltage setpoint and when it changed, 0 once the read back has reached it
+  float setpoint_target_{NAN};
+  uint32_t setpoint_changed_{0};
+  PollStatistics poll_stats_{};
+
+  // only configured sensors get a slot, see EMR48_SENSOR_INDEX
+  sensor::Sensor *sensors_[EMR48_SENSOR_INDEX.count > 0 ? EMR48_SENSOR_INDEX.count : 1]{};
+
+#ifdef USE_EMERSON_R48_OUTPUT_VOLTAGE_NUMBER
   number::Number *output_voltage_number_{nullptr};
+#endif
+#ifdef USE_EMERSON_R48_MAX_OUTPUT_CURRENT_NUMBER
   number::Number *max_output_current_number_{nullptr};
+#endif
+#ifdef USE_EMERSON_R48_MAX_INPUT_CURRENT_NUMBER
   number::Number *max_input_current_number_{nullptr};
+#endif
+  switch_::Switch *ac_switch_{nullptr};
+  switch_::Switch *dc_switch_{nullptr};
+  switch_::Switch *fan_switch_{nullptr};
+  switch_::Switch *led_switch_{nullptr};
+
+  sensor::Sensor *sensor_(SensorSlot slot) const {
+    uint8_t index = EMR48_SENSOR_INDEX.index[slot];
+    return index == EMR48_SENSOR_UNUSED ? nullptr : this->sensors_[index];
+  }
+  void set_sensor_(SensorSlot slot, sensor::Sensor *sensor) {
+    uint8_t index = EMR48_SENSOR_INDEX.index[slot];
+    if (index != EMR48_SENSOR_UNUSED)
+      this->sensors_[index] = sensor;
+  }
 
   void on_frame(uint32_t can_id, bool rtr, std::vector<uint8_t> &data);
+  void on_frames(const canbus::CanFrame *frames, const uint32_t *timestamps_us, size_t count) override;
+  void on_wake() override;
+  void handle_frame_(uint32_t can_id, const uint8_t *data, size_t length, uint32_t timestamp_us);
+  ParamTiming *find_timing_(uint8_t param_id);
 
+  void send_read_request_(uint8_t param, bool poll);
+  ParamCacheEntry *cache_entry_(uint8_t param_id, bool create);
+  void cache_reply_(uint8_t param_id, float raw_value);
+  void complete_reads_(uint8_t param_id, float value);
+  void expire_reads_();
+  bool send_frame_(uint32_t can_id, const uint8_t *data, const char *what = nullptr);
+  void log_frame_(const char *what, const uint8_t *data, size_t length);
+
+  void restore_setpoints_();
+  void save_setpoints_();
+  void refresh_online_setpoints_();
+  bool run_startup_step_(uint8_t step);
+
+  bool skip_poll_tick_();
+  void check_freshness_();
+  bool enter_sleep_();
+  void resume_();
+  void start_poll_cycle_();
+  void publish_snapshot_();
+  void track_reply_(const ParamDef *param, float value);
+  void publish_heap_stats_();
   void publish_sensor_state_(sensor::Sensor *sensor, float value);
   void publish_number_state_(number::Number *number, float value);
+  void publish_switch_state_(switch_::Switch *sw, bool state);
+};
+
+class SnapshotTrigger : public Trigger<const TelemetrySnapshot &> {
+ public:
+  explicit SnapshotTrigger(EmersonR48Component *parent) {
+    parent->add_on_snapshot_callback([this](const TelemetrySnapshot &snapshot) { this->trigger(snapshot); });
+  }
+};
+
+// Any readable parameter by id, for values without a dedicated sensor. Sensors of the same id share the
+// request and the cached reply.
+class EmersonR48ParameterSensor : public sensor::Sensor, public PollingComponent {
+ public:
+  EmersonR48ParameterSensor(EmersonR48Component *parent, uint8_t param_id) : parent_(parent), param_id_(param_id) {}
+  void set_ttl(uint32_t ttl_ms) { ttl_ms_ = ttl_ms; }
+  void update() override;
+
+ protected:
+  EmersonR48Component *parent_;
+  uint8_t param_id_;
+  uint32_t ttl_ms_{EMR48_DEFAULT_READ_TTL_MS};
 };
 
 }  // namespace emerson_r48
@@ -93,7 +93,7 @@ CONFIG_SCHEMA = cv.All(
 
 async def to_code(config):
     hub = await cg.get_variable(config[CONF_EMERSON_R48_ID])
-    if config[CONF_OUTPUT_VOLTAGE]:
+    if CONF_OUTPUT_VOLTAGE in config:
         conf = config[CONF_OUTPUT_VOLTAGE]
         var = cg.new_Pvariable(conf[CONF_ID])
         await cg.register_component(var, conf)
@@ -105,8 +105,9 @@ async def to_code(config):
             step=conf[CONF_STEP],
         )
         cg.add(getattr(hub, "set_output_voltage_number")(var))
+        cg.add_define("USE_EMERSON_R48_OUTPUT_VOLTAGE_NUMBER")
         cg.add(var.set_parent(hub, 0x0))
-    if config[CONF_MAX_OUTPUT_CURRENT]:
+    if CONF_MAX_OUTPUT_CURRENT in config:
         conf = config[CONF_MAX_OUTPUT_CURRENT]
         var = cg.new_Pvariable(conf[CONF_ID])
         await cg.register_component(var, conf)
@@ -118,8 +119,9 @@ async def to_code(config):
             step=conf[CONF_STEP],
         )
         cg.add(getattr(hub, "set_max_output_current_number")(var))
+        cg.add_define("USE_EMERSON_R48_MAX_OUTPUT_CURRENT_NUMBER")
         cg.add(var.set_parent(hub, 0x3))
-    if config[CONF_MAX_INPUT_CURRENT]:
+    if CONF_MAX_INPUT_CURRENT in config:
         conf = config[CONF_MAX_INPUT_CURRENT]
         var = cg.new_Pvariable(conf[CONF_ID])
         await cg.register_component(var, conf)
@@ -131,4 +133,5 @@ async def to_code(config):
             step=conf[CONF_STEP],
         )
         cg.add(getattr(hub, "set_max_input_current_number")(var))
+        cg.add_define("USE_EMERSON_R48_MAX_INPUT_CURRENT_NUMBER")
         cg.add(var.set_parent(hub, 0x4))
@@ -18,8 +18,13 @@ from esphome.const import (
     ICON_PERCENT,
     ICON_THERMOMETER,
     ICON_CURRENT_AC,
+    ICON_COUNTER,
+    ICON_TIMER,
+    UNIT_MILLISECOND,
+    ENTITY_CATEGORY_DIAGNOSTIC,
+    CONF_ID,
 )
-from . import EmersonR48Component, CONF_EMERSON_R48_ID
+from . import EmersonR48Component, CONF_EMERSON_R48_ID, emerson_r48_ns
 
 CONF_INPUT_VOLTAGE = "input_voltage"
 CONF_INPUT_FREQUENCY = "input_frequency"
@@ -32,9 +37,29 @@ CONF_OUTPUT_CURRENT = "output_current"
 CONF_MAX_OUTPUT_CURRENT = "max_output_current"
 CONF_OUTPUT_POWER = "output_power"
 CONF_OUTPUT_TEMP = "output_temp"
+CONF_HEAP_FREE = "heap_free"
+CONF_HEAP_MIN_FREE = "heap_min_free"
+CONF_HEAP_MAX_BLOCK = "heap_max_block"
+CONF_HEAP_FRAGMENTATION = "heap_fragmentation"
+CONF_POLL_TIME = "poll_time"
+CONF_MISSED_REPLIES = "missed_replies"
+CONF_SETPOINT_LATENCY = "setpoint_latency"
 
+CONF_MAX_AGE = "max_age"
+CONF_PARAMETERS = "parameters"
+CONF_PARAMETER = "parameter"
+CONF_TTL = "ttl"
 
-TYPES = [
+UNIT_BYTES = "B"
+
+SensorSlot = emerson_r48_ns.enum("SensorSlot")
+EmersonR48ParameterSensor = emerson_r48_ns.class_(
+    "EmersonR48ParameterSensor", sensor.Sensor, cg.PollingComponent
+)
+
+
+# sensors fed by a rectifier parameter, each key maps to SensorSlot SENSOR_<KEY>
+SLOT_TYPES = [
     CONF_INPUT_VOLTAGE,
     CONF_INPUT_FREQUENCY,
     CONF_INPUT_CURRENT,
@@ -48,12 +73,54 @@ TYPES = [
     CONF_OUTPUT_TEMP,
 ]
 
+TYPES = SLOT_TYPES + [
+    CONF_HEAP_FREE,
+    CONF_HEAP_MIN_FREE,
+    CONF_HEAP_MAX_BLOCK,
+    CONF_HEAP_FRAGMENTATION,
+    CONF_POLL_TIME,
+    CONF_MISSED_REPLIES,
+    CONF_SETPOINT_LATENCY,
+]
+
+
+def sensor_slot(key):
+    # a key without a matching enum member fails the C++ build instead of picking the wrong slot
+    return getattr(SensorSlot, f"SENSOR_{key.upper()}")
+
+
+def parameter_sensor_schema(**kwargs):
+    # sensors fed by a polled rectifier parameter (EMR48_POLL_LIST: output voltage, output current, max output
+    # current, output temperature, input voltage): NAN once the parameter has not been answered for this long,
+    # default 10 update intervals. The other slot sensors are not polled and take no max_age.
+    return sensor.sensor_schema(**kwargs).extend(
+        {cv.Optional(CONF_MAX_AGE): cv.positive_time_period_milliseconds}
+    )
+
+
+# any readable parameter by id; sensors of the same id share one request and the cached reply
+PARAMETER_SENSOR_SCHEMA = (
+    sensor.sensor_schema(
+        EmersonR48ParameterSensor,
+        accuracy_decimals=2,
+        state_class=STATE_CLASS_MEASUREMENT,
+    )
+    .extend(
+        {
+            cv.Required(CONF_PARAMETER): cv.hex_uint8_t,
+            # a reply at most this old is reused instead of asking the rectifier again
+            cv.Optional(CONF_TTL, default="1s"): cv.positive_time_period_milliseconds,
+        }
+    )
+    .extend(cv.polling_component_schema("10s"))
+)
+
 
 CONFIG_SCHEMA = cv.All(
     cv.Schema(
         {
             cv.GenerateID(CONF_EMERSON_R48_ID): cv.use_id(EmersonR48Component),
-            cv.Optional(CONF_INPUT_VOLTAGE): sensor.sensor_schema(
+            cv.Optional(CONF_INPUT_VOLTAGE): parameter_sensor_schema(
                 unit_of_measurement=UNIT_VOLT,
                 icon=ICON_FLASH,
                 accuracy_decimals=1,
@@ -94,21 +161,21 @@ CONFIG_SCHEMA = cv.All(
                 accuracy_decimals=0,
                 state_class=STATE_CLASS_MEASUREMENT,
             ),
-            cv.Optional(CONF_OUTPUT_VOLTAGE): sensor.sensor_schema(
+            cv.Optional(CONF_OUTPUT_VOLTAGE): parameter_sensor_schema(
                 unit_of_measurement=UNIT_VOLT,
                 icon=ICON_FLASH,
                 accuracy_decimals=2,
                 device_class=DEVICE_CLASS_VOLTAGE,
                 state_class=STATE_CLASS_MEASUREMENT,
             ),
-            cv.Optional(CONF_OUTPUT_CURRENT): sensor.sensor_schema(
+            cv.Optional(CONF_OUTPUT_CURRENT): parameter_sensor_schema(
                 unit_of_measurement=UNIT_AMPERE,
                 icon=ICON_CURRENT_AC,
                 accuracy_decimals=2,
                 device_class=DEVICE_CLASS_CURRENT,
                 state_class=STATE_CLASS_MEASUREMENT,
             ),
-            cv.Optional(CONF_MAX_OUTPUT_CURRENT): sensor.sensor_schema(
+            cv.Optional(CONF_MAX_OUTPUT_CURRENT): parameter_sensor_schema(
                 unit_of_measurement=UNIT_AMPERE,
                 icon=ICON_CURRENT_AC,
                 accuracy_decimals=2,
@@ -122,13 +189,62 @@ CONFIG_SCHEMA = cv.All(
                 device_class=DEVICE_CLASS_POWER,
                 state_class=STATE_CLASS_MEASUREMENT,
             ),
-            cv.Optional(CONF_OUTPUT_TEMP): sensor.sensor_schema(
+            cv.Optional(CONF_OUTPUT_TEMP): parameter_sensor_schema(
                 unit_of_measurement=UNIT_CELSIUS,
                 icon=ICON_THERMOMETER,
                 accuracy_decimals=1,
                 device_class=DEVICE_CLASS_TEMPERATURE,
                 state_class=STATE_CLASS_MEASUREMENT,
             ),
+            cv.Optional(CONF_PARAMETERS): cv.ensure_list(PARAMETER_SENSOR_SCHEMA),
+            cv.Optional(CONF_HEAP_FREE): sensor.sensor_schema(
+                unit_of_measurement=UNIT_BYTES,
+                icon=ICON_COUNTER,
+                accuracy_decimals=0,
+                state_class=STATE_CLASS_MEASUREMENT,
+                entity_category=ENTITY_CATEGORY_DIAGNOSTIC,
+            ),
+            cv.Optional(CONF_HEAP_MIN_FREE): sensor.sensor_schema(
+                unit_of_measurement=UNIT_BYTES,
+                icon=ICON_COUNTER,
+                accuracy_decimals=0,
+                state_class=STATE_CLASS_MEASUREMENT,
+                entity_category=ENTITY_CATEGORY_DIAGNOSTIC,
+            ),
+            cv.Optional(CONF_HEAP_MAX_BLOCK): sensor.sensor_schema(
+                unit_of_measurement=UNIT_BYTES,
+                icon=ICON_COUNTER,
+                accuracy_decimals=0,
+                state_class=STATE_CLASS_MEASUREMENT,
+                entity_category=ENTITY_CATEGORY_DIAGNOSTIC,
+            ),
+            cv.Optional(CONF_HEAP_FRAGMENTATION): sensor.sensor_schema(
+                unit_of_measurement=UNIT_PERCENT,
+                icon=ICON_PERCENT,
+                accuracy_decimals=0,
+                state_class=STATE_CLASS_MEASUREMENT,
+                entity_category=ENTITY_CATEGORY_DIAGNOSTIC,
+            ),
+            cv.Optional(CONF_POLL_TIME): sensor.sensor_schema(
+                unit_of_measurement=UNIT_MILLISECOND,
+                icon=ICON_TIMER,
+                accuracy_decimals=0,
+                state_class=STATE_CLASS_MEASUREMENT,
+                entity_category=ENTITY_CATEGORY_DIAGNOSTIC,
+            ),
+            cv.Optional(CONF_MISSED_REPLIES): sensor.sensor_schema(
+                icon=ICON_COUNTER,
+                accuracy_decimals=0,
+                state_class=STATE_CLASS_MEASUREMENT,
+                entity_category=ENTITY_CATEGORY_DIAGNOSTIC,
+            ),
+            cv.Optional(CONF_SETPOINT_LATENCY): sensor.sensor_schema(
+                unit_of_measurement=UNIT_MILLISECOND,
+                icon=ICON_TIMER,
+                accuracy_decimals=0,
+                state_class=STATE_CLASS_MEASUREMENT,
+                entity_category=ENTITY_CATEGORY_DIAGNOSTIC,
+            ),
         }
     ).extend(cv.COMPONENT_SCHEMA)
 )
@@ -139,9 +255,18 @@ async def setup_conf(config, key, hub):
         conf = config[key]
         sens = await sensor.new_sensor(conf)
         cg.add(getattr(hub, f"set_{key}_sensor")(sens))
+        # unconfigured sensors are compiled out of the component (no storage, no polling)
+        cg.add_define(f"USE_EMERSON_R48_{key.upper()}_SENSOR")
+        if CONF_MAX_AGE in conf:
+            cg.add(hub.set_max_age(sensor_slot(key), conf[CONF_MAX_AGE]))
 
 
 async def to_code(config):
     hub = await cg.get_variable(config[CONF_EMERSON_R48_ID])
     for key in TYPES:
         await setup_conf(config, key, hub)
+    for conf in config.get(CONF_PARAMETERS, []):
+        var = cg.new_Pvariable(conf[CONF_ID], hub, conf[CONF_PARAMETER])
+        await cg.register_component(var, conf)
+        await sensor.register_sensor(var, conf)
+        cg.add(var.set_ttl(conf[CONF_TTL]))
@@ -96,7 +96,7 @@ async def to_code(config):
             var,
             conf
         )
-#        cg.add(getattr(hub, "set_output_voltage_number")(var))
+        cg.add(hub.set_ac_switch(var))
         cg.add(var.set_parent(hub, 0x0))
 
     if config[CONF_DC_SWITCH]:
@@ -107,7 +107,7 @@ async def to_code(config):
             var,
             conf,
         )
-#        cg.add(getattr(hub, "set_max_output_current_number")(var))
+        cg.add(hub.set_dc_switch(var))
         cg.add(var.set_parent(hub, 0x1))
 
     if config[CONF_FAN_SWITCH]:
@@ -118,7 +118,7 @@ async def to_code(config):
             var,
             conf,
         )
-#        cg.add(getattr(hub, "set_max_output_current_number")(var))
+        cg.add(hub.set_fan_switch(var))
         cg.add(var.set_parent(hub, 0x2))
 
     if config[CONF_LED_SWITCH]:
@@ -129,6 +129,6 @@ async def to_code(config):
             var,
             conf,
         )
-#        cg.add(getattr(hub, "set_max_output_current_number")(var))
+        cg.add(hub.set_led_switch(var))
         cg.add(var.set_parent(hub, 0x3))
 
@@ -14,42 +14,52 @@ static const int8_t SET_LED_FUNCTION = 0x3;
 
 
 void EmersonR48Switch::setup() {
+    // the parent has restored the control bits in its own setup() by now
+    switch (this->functionCode_) {
+        case SET_AC_FUNCTION:
+            this->publish_state(parent_->acOff_);
+            break;
+        case SET_DC_FUNCTION:
+            this->publish_state(parent_->dcOff_);
+            break;
+        case SET_FAN_FUNCTION:
+            this->publish_state(parent_->fanFull_);
+            break;
+        case SET_LED_FUNCTION:
+            this->publish_state(parent_->flashLed_);
+            break;
 
+        default:
+        break;
+    }
 }
 
 void EmersonR48Switch::write_state(bool state) {
     ESP_LOGD(TAG, "-> new switch state: %d", state);
-    uint8_t msgv = 0;
 
+    bool ac_off = parent_->acOff_;
+    bool dc_off = parent_->dcOff_;
+    bool fan_full = parent_->fanFull_;
+    bool flash_led = parent_->flashLed_;
     switch (this->functionCode_) {
         case SET_AC_FUNCTION:
-            parent_->acOff_ = state;
-            msgv = parent_->dcOff_ << 7 | parent_->fanFull_ << 4 | parent_->flashLed_ << 3 | parent_->acOff_ << 2 | 1;
-            parent_->set_control(msgv);
-            this->publish_state(state);
+            ac_off = state;
             break;
         case SET_DC_FUNCTION:
-            parent_->dcOff_ = state;
-            msgv = parent_->dcOff_ << 7 | parent_->fanFull_ << 4 | parent_->flashLed_ << 3 | parent_->acOff_ << 2 | 1;
-            parent_->set_control(msgv);
-            this->publish_state(state);
+            dc_off = state;
             break;
         case SET_FAN_FUNCTION:
-            parent_->fanFull_ = state;
-            msgv = parent_->dcOff_ << 7 | parent_->fanFull_ << 4 | parent_->flashLed_ << 3 | parent_->acOff_ << 2 | 1;
-            parent_->set_control(msgv);
-            this->publish_state(state);
+            fan_full = state;
             break;
         case SET_LED_FUNCTION:
-            parent_->flashLed_ = state;
-            msgv = parent_->dcOff_ << 7 | parent_->fanFull_ << 4 | parent_->flashLed_ << 3 | parent_->acOff_ << 2 | 1;
-            parent_->set_control(msgv);
-            this->publish_state(state);
+            flash_led = state;
             break;
 
         default:
-        break;
+        return;
     }
+    // sends, saves and publishes the state of this and the other control switches
+    parent_->set_control_flags(ac_off, dc_off, fan_full, flash_led);
 }
 
 void EmersonR48Switch::dump_config(){
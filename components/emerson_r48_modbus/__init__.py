@@ -0,0 +1,31 @@
+import esphome.codegen as cg
+import esphome.config_validation as cv
+from esphome.components.emerson_r48 import EmersonR48Component, CONF_EMERSON_R48_ID
+from esphome.const import CONF_ID, CONF_PORT
+
+CODEOWNERS = ["@leodesigner"]
+DEPENDENCIES = ["network", "emerson_r48"]
+AUTO_LOAD = ["socket"]
+
+CONF_MAX_CLIENTS = "max_clients"
+
+emerson_r48_modbus_ns = cg.esphome_ns.namespace("emerson_r48_modbus")
+EmersonR48Modbus = emerson_r48_modbus_ns.class_("EmersonR48Modbus", cg.Component)
+
+CONFIG_SCHEMA = cv.Schema(
+    {
+        cv.GenerateID(): cv.declare_id(EmersonR48Modbus),
+        cv.GenerateID(CONF_EMERSON_R48_ID): cv.use_id(EmersonR48Component),
+        cv.Optional(CONF_PORT, default=502): cv.port,
+        # keep in sync with MODBUS_MAX_CLIENTS
+        cv.Optional(CONF_MAX_CLIENTS, default=2): cv.int_range(min=1, max=4),
+    }
+).extend(cv.COMPONENT_SCHEMA)
+
+
+async def to_code(config):
+    parent = await cg.get_variable(config[CONF_EMERSON_R48_ID])
+    var = cg.new_Pvariable(config[CONF_ID], parent)
+    await cg.register_component(var, config)
+    cg.add(var.set_port(config[CONF_PORT]))
+    cg.add(var.set_max_clients(config[CONF_MAX_CLIENTS]))
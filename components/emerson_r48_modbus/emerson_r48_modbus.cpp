@@ -0,0 +1,289 @@
+#include "emerson_r48_modbus.h"
+#include "esphome/core/hal.h"
+#include "esphome/core/log.h"
+
+#include <cerrno>
+#include <cmath>
+#include <cstring>
+
+namespace esphome {
+namespace emerson_r48_modbus {
+
+static const char *const TAG = "emerson_r48_modbus";
+
+static const uint8_t FC_READ_HOLDING = 0x03;
+static const uint8_t FC_READ_INPUT = 0x04;
+static const uint8_t FC_WRITE_SINGLE = 0x06;
+static const uint8_t FC_WRITE_MULTIPLE = 0x10;
+
+static const uint8_t EX_ILLEGAL_FUNCTION = 0x01;
+static const uint8_t EX_ILLEGAL_ADDRESS = 0x02;
+static const uint8_t EX_ILLEGAL_VALUE = 0x03;
+
+static const size_t MBAP_SIZE = 7;
+static const uint16_t MAX_READ_COUNT = 125;
+static const uint16_t MAX_WRITE_COUNT = 123;
+
+static uint16_t get_u16(const uint8_t *pos) { return (pos[0] << 8) | pos[1]; }
+
+static void put_u16(uint8_t *pos, uint16_t value) {
+  pos[0] = value >> 8;
+  pos[1] = value;
+}
+
+static uint16_t float_word(float value, bool high) {
+  uint32_t bits;
+  memcpy(&bits, &value, sizeof(bits));
+  return high ? bits >> 16 : bits;
+}
+
+// float setpoints are written as a whole, i.e. both registers in one request
+static bool is_float_register(uint16_t address) { return address < MODBUS_HOLDING_CONTROL; }
+
+static bool param_in_range(uint8_t param, float value) {
+  const ParamDef &def = EMR48_PARAMS[param_index(param, PARAM_WRITE)];
+  return value >= def.min && value <= def.max;
+}
+
+void EmersonR48Modbus::setup() {
+  this->listener_ = socket::socket_ip(SOCK_STREAM, 0);
+  if (this->listener_ == nullptr) {
+    ESP_LOGE(TAG, "Could not create socket");
+    this->mark_failed();
+    return;
+  }
+  int enable = 1;
+  this->listener_->setsockopt(SOL_SOCKET, SO_REUSEADDR, &enable, sizeof(enable));
+  this->listener_->setblocking(false);
+
+  struct sockaddr_storage server;
+  socklen_t len = socket::set_sockaddr_any((struct sockaddr *) &server, sizeof(server), this->port_);
+  if (len == 0 || this->listener_->bind((struct sockaddr *) &server, len) != 0 ||
+      this->listener_->listen(MODBUS_MAX_CLIENTS) != 0) {
+    ESP_LOGE(TAG, "Could not listen on port %u: errno %d", this->port_, errno);
+    this->listener_.reset();
+    this->mark_failed();
+  }
+}
+
+void EmersonR48Modbus::dump_config() {
+  ESP_LOGCONFIG(TAG, "Emerson R48 Modbus TCP server:");
+  ESP_LOGCONFIG(TAG, "  Port: %u", this->port_);
+  ESP_LOGCONFIG(TAG, "  Max clients: %u", this->max_clients_);
+}
+
+void EmersonR48Modbus::loop() {
+  if (this->listener_ == nullptr)
+    return;
+  this->accept_();
+  for (uint8_t i = 0; i < this->max_clients_; i++) {
+    Client &client = this->clients_[i];
+    if (client.socket != nullptr && !this->service_(client)) {
+      client.socket.reset();
+      client.rx_length = 0;
+    }
+  }
+}
+
+void EmersonR48Modbus::accept_() {
+  while (true) {
+    struct sockaddr_storage peer;
+    socklen_t peer_len = sizeof(peer);
+    std::unique_ptr<socket::Socket> socket = this->listener_->accept((struct sockaddr *) &peer, &peer_len);
+    if (socket == nullptr)
+      return;
+    Client *slot = nullptr;
+    for (uint8_t i = 0; i < this->max_clients_ && slot == nullptr; i++) {
+      if (this->clients_[i].socket == nullptr)
+        slot = &this->clients_[i];
+    }
+    if (slot == nullptr) {
+      ESP_LOGW(TAG, "Connection refused, %u clients already connected", this->max_clients_);
+      continue;  // closed when socket goes out of scope
+    }
+    socket->setblocking(false);
+    slot->socket = std::move(socket);
+    slot->rx_length = 0;
+    ESP_LOGD(TAG, "Client connected");
+  }
+}
+
+// Answers every complete request received so far. False closes the connection: peer gone, malformed frame,
+// or a response the socket cannot take at once (nothing is queued for slow clients).
+bool EmersonR48Modbus::service_(Client &client) {
+  ssize_t received = client.socket->read(client.rx + client.rx_length, sizeof(client.rx) - client.rx_length);
+  if (received == 0)
+    return false;
+  if (received < 0)
+    return errno == EAGAIN || errno == EWOULDBLOCK;
+  client.rx_length += received;
+
+  uint8_t tx[MODBUS_MAX_ADU];
+  while (client.rx_length >= MBAP_SIZE) {
+    const uint16_t length = get_u16(client.rx + 4);  // unit id + PDU
+    if (get_u16(client.rx + 2) != 0 || length < 2 || MBAP_SIZE - 1 + length > MODBUS_MAX_ADU) {
+      ESP_LOGW(TAG, "Malformed frame, closing connection");
+      return false;
+    }
+    const size_t frame_length = MBAP_SIZE - 1 + length;
+    if (client.rx_length < frame_length)
+      break;
+
+    memcpy(tx, client.rx, MBAP_SIZE);  // transaction id, protocol id and unit id are echoed
+    size_t pdu_length = this->handle_pdu_(client.rx + MBAP_SIZE, length - 1, tx + MBAP_SIZE);
+    put_u16(tx + 4, pdu_length + 1);
+    if (client.socket->write(tx, MBAP_SIZE + pdu_length) != (ssize_t) (MBAP_SIZE + pdu_length)) {
+      ESP_LOGW(TAG, "Client not reading, closing connection");
+      return false;
+    }
+
+    client.rx_length -= frame_length;
+    memmove(client.rx, client.rx + frame_length, client.rx_length);
+  }
+  return true;
+}
+
+size_t EmersonR48Modbus::handle_pdu_(const uint8_t *request, size_t length, uint8_t *response) {
+  const uint8_t function = request[0];
+  uint8_t exception = 0;
+  response[0] = function;
+
+  if (function == FC_READ_HOLDING || function == FC_READ_INPUT) {
+    if (length != 5) {
+      exception = EX_ILLEGAL_VALUE;
+    } else {
+      const uint16_t address = get_u16(request + 1);
+      const uint16_t count = get_u16(request + 3);
+      if (count == 0 || count > MAX_READ_COUNT) {
+        exception = EX_ILLEGAL_VALUE;
+      } else {
+        uint16_t value;
+        for (uint16_t i = 0; i < count && exception == 0; i++) {
+          const bool ok = function == FC_READ_INPUT ? this->input_register_(address + i, &value)
+                                                    : this->holding_register_(address + i, &value);
+          if (ok) {
+            put_u16(response + 2 + 2 * i, value);
+          } else {
+            exception = EX_ILLEGAL_ADDRESS;
+          }
+        }
+        if (exception == 0) {
+          response[1] = count * 2;
+          return 2 + count * 2;
+        }
+      }
+    }
+  } else if (function == FC_WRITE_SINGLE) {
+    exception = length == 5 ? this->write_holding_(get_u16(request + 1), 1, request + 3) : EX_ILLEGAL_VALUE;
+    if (exception == 0) {
+      memcpy(response + 1, request + 1, 4);
+      return 5;
+    }
+  } else if (function == FC_WRITE_MULTIPLE) {
+    const uint16_t count = length >= 6 ? get_u16(request + 3) : 0;
+    if (count == 0 || count > MAX_WRITE_COUNT || request[5] != count * 2 || length != 6u + count * 2) {
+      exception = EX_ILLEGAL_VALUE;
+    } else {
+      exception = this->write_holding_(get_u16(request + 1), count, request + 6);
+    }
+    if (exception == 0) {
+      memcpy(response + 1, request + 1, 4);
+      return 5;
+    }
+  } else {
+    exception = EX_ILLEGAL_FUNCTION;
+  }
+
+  response[0] = function | 0x80;
+  response[1] = exception;
+  return 2;
+}
+
+bool EmersonR48Modbus::input_register_(uint16_t address, uint16_t *value) const {
+  const TelemetrySnapshot &latest = this->parent_->get_latest();
+  if (address >= MODBUS_INPUT_VALUES && address < MODBUS_INPUT_VALUES + 2 * (SENSOR_COUNT - 1)) {
+    const uint16_t offset = address - MODBUS_INPUT_VALUES;
+    *value = float_word(latest.values[1 + offset / 2], offset % 2 == 0);
+    return true;
+  }
+  if (address >= MODBUS_INPUT_AGES && address < MODBUS_INPUT_AGES + SENSOR_COUNT - 1) {
+    const uint32_t sample_ms = latest.sample_ms[1 + address - MODBUS_INPUT_AGES];
+    const uint32_t age = (millis() - sample_ms) / 100;
+    *value = sample_ms == 0 || age > 0xFFFE ? 0xFFFF : age;
+    return true;
+  }
+  return false;
+}
+
+bool EmersonR48Modbus::holding_register_(uint16_t address, uint16_t *value) const {
+  const SetpointState &setpoints = this->parent_->get_setpoints();
+  switch (address) {
+    case MODBUS_HOLDING_OUTPUT_VOLTAGE:
+    case MODBUS_HOLDING_OUTPUT_VOLTAGE + 1:
+      *value = float_word(setpoints.output_voltage, address == MODBUS_HOLDING_OUTPUT_VOLTAGE);
+      return true;
+    case MODBUS_HOLDING_MAX_OUTPUT_CURRENT:
+    case MODBUS_HOLDING_MAX_OUTPUT_CURRENT + 1:
+      *value = float_word(setpoints.max_output_current, address == MODBUS_HOLDING_MAX_OUTPUT_CURRENT);
+      return true;
+    case MODBUS_HOLDING_MAX_INPUT_CURRENT:
+    case MODBUS_HOLDING_MAX_INPUT_CURRENT + 1:
+      *value = float_word(setpoints.max_input_current, address == MODBUS_HOLDING_MAX_INPUT_CURRENT);
+      return true;
+    case MODBUS_HOLDING_CONTROL:
+      *value = (this->parent_->acOff_ ? 0x01 : 0) | (this->parent_->dcOff_ ? 0x02 : 0) |
+               (this->parent_->fanFull_ ? 0x04 : 0) | (this->parent_->flashLed_ ? 0x08 : 0);
+      return true;
+    default:
+      return false;
+  }
+}
+
+// The whole request is validated before anything is sent, so a rejected write changes nothing
+uint8_t EmersonR48Modbus::write_holding_(uint16_t address, uint16_t count, const uint8_t *values) {
+  const uint32_t end = uint32_t(address) + count;
+  if (end > MODBUS_HOLDING_COUNT)
+    return EX_ILLEGAL_ADDRESS;
+  if ((is_float_register(address) && address % 2 != 0) || (is_float_register(end - 1) && end % 2 != 0))
+    return EX_ILLEGAL_ADDRESS;
+
+  float floats[MODBUS_HOLDING_CONTROL / 2];
+  for (uint16_t reg = address; reg < end && is_float_register(reg); reg += 2) {
+    const uint8_t *pos = values + 2 * (reg - address);
+    const uint32_t bits = (uint32_t(get_u16(pos)) << 16) | get_u16(pos + 2);
+    memcpy(&floats[reg / 2], &bits, sizeof(bits));
+    const float value = floats[reg / 2];
+    bool ok;
+    if (reg == MODBUS_HOLDING_OUTPUT_VOLTAGE) {
+      ok = param_in_range(EMR48_SET_OUTPUT_V_ONLINE, value);
+    } else if (reg == MODBUS_HOLDING_MAX_OUTPUT_CURRENT) {
+      ok = param_in_range(EMR48_SET_OUTPUT_AL_ONLINE, value);
+    } else {
+      ok = std::isfinite(value) && value >= 0;
+    }
+    if (!ok)
+      return EX_ILLEGAL_VALUE;
+  }
+  uint16_t control = 0;
+  if (end > MODBUS_HOLDING_CONTROL) {
+    control = get_u16(values + 2 * (MODBUS_HOLDING_CONTROL - address));
+    if (control > 0x0F)
+      return EX_ILLEGAL_VALUE;
+  }
+
+  for (uint16_t reg = address; reg < end; reg += is_float_register(reg) ? 2 : 1) {
+    if (reg == MODBUS_HOLDING_OUTPUT_VOLTAGE) {
+      this->parent_->set_output_voltage(floats[reg / 2]);
+    } else if (reg == MODBUS_HOLDING_MAX_OUTPUT_CURRENT) {
+      this->parent_->set_max_output_current(floats[reg / 2]);
+    } else if (reg == MODBUS_HOLDING_MAX_INPUT_CURRENT) {
+      this->parent_->set_max_input_current(floats[reg / 2]);
+    } else {
+      this->parent_->set_control_flags(control & 0x01, control & 0x02, control & 0x04, control & 0x08);
+    }
+  }
+  return 0;
+}
+
+}  // namespace emerson_r48_modbus
+}  // namespace esphome
@@ -0,0 +1,71 @@
+#pragma once
+
+#include "esphome/core/component.h"
+#include "esphome/components/emerson_r48/emerson_r48.h"
+#include "esphome/components/socket/socket.h"
+
+#include <memory>
+
+namespace esphome {
+namespace emerson_r48_modbus {
+
+using namespace emerson_r48;
+
+// Register map, floats take two registers, high word first:
+//   input    0..21    values of SensorSlot 1..11 (float32, NaN if none)
+//   input    100..110 age of each value in 0.1 s (u16, 0xFFFF if none or older)
+//   holding  0..1     output voltage setpoint (float32, V)
+//   holding  2..3     output current limit (float32, % of rated)
+//   holding  4..5     input current limit (float32, A)
+//   holding  6        control bits: 0 AC off, 1 DC off, 2 fan full, 3 flash LED
+static const uint16_t MODBUS_INPUT_VALUES = 0;
+static const uint16_t MODBUS_INPUT_AGES = 100;
+static const uint16_t MODBUS_HOLDING_OUTPUT_VOLTAGE = 0;
+static const uint16_t MODBUS_HOLDING_MAX_OUTPUT_CURRENT = 2;
+static const uint16_t MODBUS_HOLDING_MAX_INPUT_CURRENT = 4;
+static const uint16_t MODBUS_HOLDING_CONTROL = 6;
+static const uint16_t MODBUS_HOLDING_COUNT = 7;
+
+static const size_t MODBUS_MAX_CLIENTS = 4;
+// MBAP header + PDU, the largest Modbus TCP frame
+static const size_t MODBUS_MAX_ADU = 260;
+
+// Modbus TCP server answering from the component's cached values. Requests are handled in loop() as they
+// arrive and never wait for the bus; writes are forwarded to the setters, which send the CAN frame.
+class EmersonR48Modbus : public Component {
+ public:
+  EmersonR48Modbus(EmersonR48Component *parent) : parent_(parent) {}
+  void set_port(uint16_t port) { this->port_ = port; }
+  void set_max_clients(uint8_t max_clients) { this->max_clients_ = max_clients; }
+
+  void setup() override;
+  void loop() override;
+  void dump_config() override;
+  float get_setup_priority() const override { return setup_priority::AFTER_WIFI; }
+
+ protected:
+  struct Client {
+    std::unique_ptr<socket::Socket> socket;
+    uint8_t rx[MODBUS_MAX_ADU];
+    size_t rx_length;
+  };
+
+  void accept_();
+  bool service_(Client &client);
+  // Handles one request PDU, writes the response PDU, returns its length
+  size_t handle_pdu_(const uint8_t *request, size_t length, uint8_t *response);
+  // Returns the Modbus exception code, 0 on success
+  uint8_t write_holding_(uint16_t address, uint16_t count, const uint8_t *values);
+  // false: no such register
+  bool input_register_(uint16_t address, uint16_t *value) const;
+  bool holding_register_(uint16_t address, uint16_t *value) const;
+
+  EmersonR48Component *parent_;
+  uint16_t port_{502};
+  uint8_t max_clients_{2};
+  std::unique_ptr<socket::Socket> listener_;
+  Client clients_[MODBUS_MAX_CLIENTS]{};
+};
+
+}  // namespace emerson_r48_modbus
+}  // namespace esphome
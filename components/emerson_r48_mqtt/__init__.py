@@ -0,0 +1,29 @@
+import esphome.codegen as cg
+import esphome.config_validation as cv
+from esphome.components.emerson_r48 import EmersonR48Component, CONF_EMERSON_R48_ID
+from esphome.const import CONF_ID, CONF_QOS, CONF_RETAIN, CONF_TOPIC
+
+CODEOWNERS = ["@leodesigner"]
+DEPENDENCIES = ["mqtt", "emerson_r48"]
+
+emerson_r48_mqtt_ns = cg.esphome_ns.namespace("emerson_r48_mqtt")
+EmersonR48Mqtt = emerson_r48_mqtt_ns.class_("EmersonR48Mqtt", cg.Component)
+
+CONFIG_SCHEMA = cv.Schema(
+    {
+        cv.GenerateID(): cv.declare_id(EmersonR48Mqtt),
+        cv.GenerateID(CONF_EMERSON_R48_ID): cv.use_id(EmersonR48Component),
+        cv.Required(CONF_TOPIC): cv.publish_topic,
+        cv.Optional(CONF_QOS, default=0): cv.mqtt_qos,
+        cv.Optional(CONF_RETAIN, default=False): cv.boolean,
+    }
+).extend(cv.COMPONENT_SCHEMA)
+
+
+async def to_code(config):
+    parent = await cg.get_variable(config[CONF_EMERSON_R48_ID])
+    var = cg.new_Pvariable(config[CONF_ID], parent)
+    await cg.register_component(var, config)
+    cg.add(var.set_topic(config[CONF_TOPIC]))
+    cg.add(var.set_qos(config[CONF_QOS]))
+    cg.add(var.set_retain(config[CONF_RETAIN]))
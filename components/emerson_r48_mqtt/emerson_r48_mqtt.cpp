@@ -0,0 +1,67 @@
+#include "emerson_r48_mqtt.h"
+#include "esphome/components/mqtt/mqtt_client.h"
+#include "esphome/core/log.h"
+
+#include <cmath>
+#include <cstdio>
+
+namespace esphome {
+namespace emerson_r48_mqtt {
+
+static const char *const TAG = "emerson_r48_mqtt";
+
+void EmersonR48Mqtt::setup() {
+  this->parent_->add_on_snapshot_callback([this](const TelemetrySnapshot &snapshot) { this->publish_(snapshot); });
+}
+
+void EmersonR48Mqtt::dump_config() {
+  ESP_LOGCONFIG(TAG, "Emerson R48 MQTT batch:");
+  ESP_LOGCONFIG(TAG, "  Topic: %s", this->topic_.c_str());
+  ESP_LOGCONFIG(TAG, "  QoS: %u, retain: %s", this->qos_, this->retain_ ? "yes" : "no");
+}
+
+void EmersonR48Mqtt::publish_(const TelemetrySnapshot &snapshot) {
+  if (mqtt::global_mqtt_client == nullptr || !mqtt::global_mqtt_client->is_connected())
+    return;
+  size_t length = this->format_(snapshot);
+  if (length == 0) {
+    ESP_LOGW(TAG, "Snapshot #%u does not fit %u bytes", (unsigned) snapshot.sequence, (unsigned) MQTT_PAYLOAD_SIZE);
+    return;
+  }
+  if (mqtt::global_mqtt_client->publish(this->topic_, this->payload_, length, this->qos_, this->retain_))
+    this->published_++;
+}
+
+// Values never received are left out, stale ones are null; the age is relative to the snapshot. 0 if the
+// buffer is too small.
+size_t EmersonR48Mqtt::format_(const TelemetrySnapshot &snapshot) {
+  char *const end = this->payload_ + sizeof(this->payload_);
+  char *pos = this->payload_;
+  int n = snprintf(pos, end - pos, "{\"seq\":%u,\"ms\":%u,\"values\":{", (unsigned) snapshot.sequence,
+                   (unsigned) snapshot.timestamp_ms);
+  bool first = true;
+  for (uint8_t slot = 1; slot < SENSOR_COUNT && n >= 0 && n < end - pos; slot++) {
+    pos += n;
+    n = 0;
+    if (snapshot.sample_ms[slot] == 0)
+      continue;
+    const char *sep = first ? "" : ",";
+    first = false;
+    const unsigned age = snapshot.timestamp_ms - snapshot.sample_ms[slot];
+    if (std::isnan(snapshot.values[slot])) {
+      n = snprintf(pos, end - pos, "%s\"%s\":[null,%u]", sep, EMR48_SENSOR_KEYS[slot], age);
+    } else {
+      n = snprintf(pos, end - pos, "%s\"%s\":[%.3f,%u]", sep, EMR48_SENSOR_KEYS[slot], snapshot.values[slot], age);
+    }
+  }
+  if (n < 0 || n >= end - pos)
+    return 0;
+  pos += n;
+  n = snprintf(pos, end - pos, "}}");
+  if (n < 0 || n >= end - pos)
+    return 0;
+  return pos + n - this->payload_;
+}
+
+}  // namespace emerson_r48_mqtt
+}  // namespace esphome
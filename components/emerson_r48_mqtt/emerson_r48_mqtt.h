@@ -0,0 +1,42 @@
+#pragma once
+
+#include "esphome/core/component.h"
+#include "esphome/components/emerson_r48/emerson_r48.h"
+
+#include <string>
+
+namespace esphome {
+namespace emerson_r48_mqtt {
+
+using namespace emerson_r48;
+
+// {"seq":N,"ms":T,"values":{"<key>":[value,age_ms],...}} for every polled value fits comfortably
+static const size_t MQTT_PAYLOAD_SIZE = 512;
+
+// Publishes each TelemetrySnapshot as one JSON document instead of one MQTT message per sensor. The document
+// is formatted into a member buffer, nothing is allocated per publish.
+class EmersonR48Mqtt : public Component {
+ public:
+  EmersonR48Mqtt(EmersonR48Component *parent) : parent_(parent) {}
+  void set_topic(const std::string &topic) { topic_ = topic; }
+  void set_qos(uint8_t qos) { qos_ = qos; }
+  void set_retain(bool retain) { retain_ = retain; }
+
+  void setup() override;
+  void dump_config() override;
+  float get_setup_priority() const override { return setup_priority::AFTER_CONNECTION; }
+
+ protected:
+  void publish_(const TelemetrySnapshot &snapshot);
+  size_t format_(const TelemetrySnapshot &snapshot);
+
+  EmersonR48Component *parent_;
+  std::string topic_;
+  uint8_t qos_{0};
+  bool retain_{false};
+  char payload_[MQTT_PAYLOAD_SIZE];
+  uint32_t published_{0};
+};
+
+}  // namespace emerson_r48_mqtt
+}  // namespace esphome
@@ -0,0 +1,10 @@
+import esphome.config_validation as cv
+
+# Shared Emerson R48 protocol codec, auto-loaded by emerson_r48 and emerson_r48_sim
+CODEOWNERS = ["@leodesigner"]
+
+CONFIG_SCHEMA = cv.Schema({})
+
+
+async def to_code(config):
+    pass
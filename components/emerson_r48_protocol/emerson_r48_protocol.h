@@ -0,0 +1,276 @@
+#pragma once
+
+// Emerson / Vertiv R48 CAN protocol: frame layout, identifiers and encode / decode helpers.
+// Kept free of any ESPHome dependency so the codec can be compiled and exercised on the host.
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+
+namespace esphome {
+namespace emerson_r48 {
+
+static constexpr float EMR48_OUTPUT_VOLTAGE_MIN = 41.0;
+static constexpr float EMR48_OUTPUT_VOLTAGE_MAX = 58.5;
+
+static constexpr float EMR48_OUTPUT_CURRENT_RATED_VALUE = 62.5;
+static constexpr float EMR48_OUTPUT_CURRENT_RATED_PERCENTAGE_MIN = 10;
+static constexpr float EMR48_OUTPUT_CURRENT_RATED_PERCENTAGE_MAX = 121;
+static constexpr float EMR48_OUTPUT_CURRENT_RATED_PERCENTAGE = 121;
+static constexpr float EMR48_OUTPUT_CURRENT_MIN = 5.5;  // 10%, rounded up to nearest 0.5A
+static constexpr float EMR48_OUTPUT_CURRENT_MAX = EMR48_OUTPUT_CURRENT_RATED_VALUE;
+
+static const uint32_t CAN_ID_REQUEST = 0x06000783;
+static const uint32_t CAN_ID_DATA = 0x60f8003;  // 0x0707F803;
+static const uint32_t CAN_ID_DATA2 = 0x60f8007;
+static const uint32_t CAN_ID_SET = 0x0607FF83;      // set voltage and max current
+static const uint32_t CAN_ID_SET2 = 0x0677FF83;     // set voltage and max current
+static const uint32_t CAN_ID_SET_CTL = 0x06080783;  // set control
+static const uint32_t CAN_ID_SYNC = 0x0707FF83;
+static const uint32_t CAN_ID_SYNC2 = 0x0717FF83;
+static const uint32_t CAN_ID_GIMME5 = 0x06080783;
+
+// 29 bit ids: protocol 0x060 (bits 28..20), point to point (19), destination (18..11), source address (10..3),
+// count and reserved bits (2..0). Each rectifier replies with its own address as the source, CAN_ID_DATA is
+// the reply of address 0. The decoders below only take CAN_ID_DATA: emerson_r48 keeps one set of values and
+// timings, replies of several units would overwrite each other. The address helpers are for the simulator and
+// the bus tools.
+static const uint8_t EMR48_ADDRESS_SHIFT = 3;
+static const uint32_t EMR48_ADDRESS_MASK = 0xFFUL << EMR48_ADDRESS_SHIFT;
+
+constexpr uint32_t data_reply_id(uint8_t address) {
+  return CAN_ID_DATA | ((uint32_t) address << EMR48_ADDRESS_SHIFT);
+}
+constexpr bool is_data_reply(uint32_t can_id) { return (can_id & ~EMR48_ADDRESS_MASK) == CAN_ID_DATA; }
+constexpr uint8_t reply_address(uint32_t can_id) {
+  return (can_id & EMR48_ADDRESS_MASK) >> EMR48_ADDRESS_SHIFT;
+}
+
+static const uint8_t EMR48_DATA_OUTPUT_V = 0x01;
+static const uint8_t EMR48_DATA_OUTPUT_A = 0x02;
+static const uint8_t EMR48_DATA_OUTPUT_AL = 0x03;
+static const uint8_t EMR48_DATA_OUTPUT_T = 0x04;
+static const uint8_t EMR48_DATA_OUTPUT_IV = 0x05;
+
+static const uint8_t EMR48_SET_OUTPUT_V_ONLINE = 0x21;
+static const uint8_t EMR48_SET_OUTPUT_V_OFFLINE = 0x24;
+static const uint8_t EMR48_SET_OUTPUT_AL_ONLINE = 0x22;
+static const uint8_t EMR48_SET_OUTPUT_AL_OFFLINE = 0x19;
+static const uint8_t EMR48_SET_INPUT_AL = 0x1A;
+
+static const uint8_t EMR48_FRAME_LENGTH = 8;
+
+// Reads all of the parameters and a few more at once, sent on CAN_ID_REQUEST
+static const uint8_t EMR48_READ_ALL[EMR48_FRAME_LENGTH] = {0x00, 0xF0, 0x00, 0x80, 0x46, 0xA5, 0x34, 0x00};
+
+// Online setpoints fall back to the offline values unless repeated within this time
+static const uint32_t EMR48_ONLINE_COMMAND_TIMEOUT_MS = 30000;
+
+// Function to convert float to byte array (big endian IEEE 754, bytes 4..7 of a parameter frame)
+inline void float_to_bytearray(float value, uint8_t *bytes) {
+  uint32_t temp;
+  memcpy(&temp, &value, sizeof(temp));
+  bytes[0] = (temp >> 24) & 0xFF;  // Most significant byte
+  bytes[1] = (temp >> 16) & 0xFF;
+  bytes[2] = (temp >> 8) & 0xFF;
+  bytes[3] = temp & 0xFF;  // Least significant byte
+}
+
+inline float bytearray_to_float(const uint8_t *bytes) {
+  uint32_t temp = ((uint32_t) bytes[0] << 24) | ((uint32_t) bytes[1] << 16) | ((uint32_t) bytes[2] << 8) | bytes[3];
+  float value;
+  memcpy(&value, &temp, sizeof(value));
+  return value;
+}
+
+// Control byte as sent in data[2] of a CAN_ID_SET_CTL frame
+inline uint8_t encode_control_bits(bool dc_off, bool fan_full, bool flash_led, bool ac_off) {
+  return dc_off << 7 | fan_full << 4 | flash_led << 3 | ac_off << 2 | 1;
+}
+
+// data: 0x01, 0xF0, 0x00, p, 0x00, 0x00, 0x00, 0x00
+inline void encode_read_request(uint8_t param, uint8_t *data) {
+  const uint8_t frame[EMR48_FRAME_LENGTH] = {0x01, 0xF0, 0x00, param, 0x00, 0x00, 0x00, 0x00};
+  memcpy(data, frame, EMR48_FRAME_LENGTH);
+}
+
+// data: 0x03, 0xF0, 0x00, p, <float, big endian>
+inline void encode_set_parameter(uint8_t param, float value, uint8_t *data) {
+  data[0] = 0x03;
+  data[1] = 0xF0;
+  data[2] = 0x00;
+  data[3] = param;
+  float_to_bytearray(value, &data[4]);
+}
+
+// Sensor a decoded parameter is published to
+enum SensorSlot : uint8_t {
+  SENSOR_NONE = 0,
+  SENSOR_INPUT_VOLTAGE,
+  SENSOR_INPUT_FREQUENCY,
+  SENSOR_INPUT_CURRENT,
+  SENSOR_INPUT_POWER,
+  SENSOR_INPUT_TEMP,
+  SENSOR_EFFICIENCY,
+  SENSOR_OUTPUT_VOLTAGE,
+  SENSOR_OUTPUT_CURRENT,
+  SENSOR_MAX_OUTPUT_CURRENT,
+  SENSOR_OUTPUT_POWER,
+  SENSOR_OUTPUT_TEMP,
+  SENSOR_COUNT,
+};
+
+// YAML key of each sensor, also used as field name wherever values are exported
+static constexpr const char *EMR48_SENSOR_KEYS[SENSOR_COUNT] = {
+    "",           "input_voltage",  "input_frequency", "input_current",      "input_power", "input_temp",
+    "efficiency", "output_voltage", "output_current",  "max_output_current", "output_power", "output_temp",
+};
+
+enum ParamDirection : uint8_t { PARAM_READ, PARAM_WRITE };
+
+struct ParamDef {
+  uint8_t id;
+  ParamDirection direction;
+  const char *name;
+  float scale;  // user value = wire value * scale
+  float min;    // accepted user value range for writes, inclusive
+  float max;
+  SensorSlot sensor;
+};
+
+static constexpr float EMR48_UNBOUNDED = std::numeric_limits<float>::infinity();
+
+// Every parameter the component knows about. Adding a parameter is one entry here:
+// reads are polled in table order and decoded into `sensor`, writes get a range-checked encoder.
+static constexpr ParamDef EMR48_PARAMS[] = {
+    {EMR48_DATA_OUTPUT_V, PARAM_READ, "Output voltage", 1.0f, 0, 0, SENSOR_OUTPUT_VOLTAGE},
+    {EMR48_DATA_OUTPUT_A, PARAM_READ, "Output current", 1.0f, 0, 0, SENSOR_OUTPUT_CURRENT},
+    {EMR48_DATA_OUTPUT_AL, PARAM_READ, "Output current limit", 100.0f, 0, 0, SENSOR_MAX_OUTPUT_CURRENT},
+    {EMR48_DATA_OUTPUT_T, PARAM_READ, "Temperature", 1.0f, 0, 0, SENSOR_OUTPUT_TEMP},
+    {EMR48_DATA_OUTPUT_IV, PARAM_READ, "Input voltage", 1.0f, 0, 0, SENSOR_INPUT_VOLTAGE},
+    {EMR48_SET_OUTPUT_V_ONLINE, PARAM_WRITE, "Output voltage (online)", 1.0f, EMR48_OUTPUT_VOLTAGE_MIN,
+     EMR48_OUTPUT_VOLTAGE_MAX, SENSOR_NONE},
+    {EMR48_SET_OUTPUT_V_OFFLINE, PARAM_WRITE, "Output voltage (offline)", 1.0f, EMR48_OUTPUT_VOLTAGE_MIN,
+     EMR48_OUTPUT_VOLTAGE_MAX, SENSOR_NONE},
+    {EMR48_SET_OUTPUT_AL_ONLINE, PARAM_WRITE, "Output current limit (online)", 100.0f,
+     EMR48_OUTPUT_CURRENT_RATED_PERCENTAGE_MIN, EMR48_OUTPUT_CURRENT_RATED_PERCENTAGE_MAX, SENSOR_NONE},
+    {EMR48_SET_OUTPUT_AL_OFFLINE, PARAM_WRITE, "Output current limit (offline)", 100.0f,
+     EMR48_OUTPUT_CURRENT_RATED_PERCENTAGE_MIN, EMR48_OUTPUT_CURRENT_RATED_PERCENTAGE_MAX, SENSOR_NONE},
+    {EMR48_SET_INPUT_AL, PARAM_WRITE, "Input current limit", 1.0f, 0, std::numeric_limits<float>::max(), SENSOR_NONE},
+};
+
+static constexpr size_t EMR48_PARAM_COUNT = sizeof(EMR48_PARAMS) / sizeof(EMR48_PARAMS[0]);
+
+// Index of a parameter in EMR48_PARAMS, EMR48_PARAM_COUNT if unknown
+constexpr size_t param_index(uint8_t id, ParamDirection direction) {
+  for (size_t i = 0; i < EMR48_PARAM_COUNT; i++) {
+    if (EMR48_PARAMS[i].id == id && EMR48_PARAMS[i].direction == direction)
+      return i;
+  }
+  return EMR48_PARAM_COUNT;
+}
+
+constexpr size_t count_params(ParamDirection direction) {
+  size_t n = 0;
+  for (size_t i = 0; i < EMR48_PARAM_COUNT; i++) {
+    if (EMR48_PARAMS[i].direction == direction)
+      n++;
+  }
+  return n;
+}
+
+static constexpr size_t EMR48_READ_PARAM_COUNT = count_params(PARAM_READ);
+
+// n-th readable parameter in poll order
+constexpr const ParamDef &read_param(size_t n) {
+  size_t i = 0;
+  for (; i < EMR48_PARAM_COUNT - 1; i++) {
+    if (EMR48_PARAMS[i].direction == PARAM_READ && n-- == 0)
+      break;
+  }
+  return EMR48_PARAMS[i];
+}
+
+// Range check and scaling are resolved at compile time for the given parameter id.
+// Returns false (and leaves data untouched) when the value is out of range.
+template<uint8_t ID> inline bool encode_parameter(float value, uint8_t *data) {
+  constexpr size_t index = param_index(ID, PARAM_WRITE);
+  static_assert(index < EMR48_PARAM_COUNT, "parameter is not a writable entry of EMR48_PARAMS");
+  constexpr ParamDef def = EMR48_PARAMS[index];
+  if (!(value >= def.min && value <= def.max))
+    return false;
+  encode_set_parameter(ID, def.scale == 1.0f ? value : value / def.scale, data);
+  return true;
+}
+
+inline bool encode_output_voltage(float value, bool offline, uint8_t *data) {
+  return offline ? encode_parameter<EMR48_SET_OUTPUT_V_OFFLINE>(value, data)
+                 : encode_parameter<EMR48_SET_OUTPUT_V_ONLINE>(value, data);
+}
+
+// value is the current limit in percent of the rated current (10% - 121%)
+inline bool encode_max_output_current(float value, bool offline, uint8_t *data) {
+  return offline ? encode_parameter<EMR48_SET_OUTPUT_AL_OFFLINE>(value, data)
+                 : encode_parameter<EMR48_SET_OUTPUT_AL_ONLINE>(value, data);
+}
+
+// value in A, any finite non-negative limit
+inline bool encode_max_input_current(float value, uint8_t *data) {
+  return encode_parameter<EMR48_SET_INPUT_AL>(value, data);
+}
+
+// data: 0x00, 0xF0, msgv, 0x80, 0x00, 0x00, 0x00, 0x00
+inline void encode_control(uint8_t msgv, uint8_t *data) {
+  const uint8_t frame[EMR48_FRAME_LENGTH] = {0x00, 0xF0, msgv, 0x80, 0x00, 0x00, 0x00, 0x00};
+  memcpy(data, frame, EMR48_FRAME_LENGTH);
+}
+
+// Rectifier side of a read: data: 0x41, 0xF0, 0x00, p, <float, big endian>, sent on CAN_ID_DATA.
+// value is in user units, the table scale is applied on the wire.
+inline bool encode_data_reply(uint8_t param, float value, uint8_t *data) {
+  size_t index = param_index(param, PARAM_READ);
+  if (index == EMR48_PARAM_COUNT)
+    return false;
+  encode_set_parameter(param, value / EMR48_PARAMS[index].scale, data);
+  data[0] = 0x41;
+  return true;
+}
+
+// Rectifier side of a write on CAN_ID_SET, value in user units
+inline const ParamDef *decode_set_frame(uint32_t can_id, const uint8_t *data, size_t length, float *value) {
+  if (can_id != CAN_ID_SET || length < EMR48_FRAME_LENGTH || data[0] != 0x03)
+    return nullptr;
+  size_t index = param_index(data[3], PARAM_WRITE);
+  if (index == EMR48_PARAM_COUNT)
+    return nullptr;
+  *value = bytearray_to_float(&data[4]) * EMR48_PARAMS[index].scale;
+  return &EMR48_PARAMS[index];
+}
+
+// Decodes a parameter reply of rectifier address 0 into its table entry and scaled value.
+// Returns nullptr for other ids, short frames and parameters missing from EMR48_PARAMS.
+inline const ParamDef *decode_data_frame(uint32_t can_id, const uint8_t *data, size_t length, float *value) {
+  if (can_id != CAN_ID_DATA || length < EMR48_FRAME_LENGTH)
+    return nullptr;
+  size_t index = param_index(data[3], PARAM_READ);
+  if (index == EMR48_PARAM_COUNT)
+    return nullptr;
+  const ParamDef &def = EMR48_PARAMS[index];
+  *value = bytearray_to_float(&data[4]);
+  if (def.scale != 1.0f)
+    *value = *value * def.scale;
+  return &def;
+}
+
+// Any parameter reply, including ids missing from EMR48_PARAMS: the id and the value as sent, unscaled
+inline bool decode_data_reply(uint32_t can_id, const uint8_t *data, size_t length, uint8_t *param, float *value) {
+  if (can_id != CAN_ID_DATA || length < EMR48_FRAME_LENGTH)
+    return false;
+  *param = data[3];
+  *value = bytearray_to_float(&data[4]);
+  return true;
+}
+
+}  // namespace emerson_r48
+}  // namespace esphome
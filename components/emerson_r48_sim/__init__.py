@@ -0,0 +1,117 @@
+import esphome.codegen as cg
+import esphome.config_validation as cv
+from esphome.components.canbus import CanbusComponent
+from esphome.components.canbus_ext import frame_source
+from esphome.components.emerson_r48 import EmersonR48Component
+from esphome.const import CONF_ID
+
+CODEOWNERS = ["@leodesigner"]
+AUTO_LOAD = ["canbus_ext", "emerson_r48_protocol"]
+
+CONF_CANBUS_ID = "canbus_id"
+CONF_RESPONSE_DELAY = "response_delay"
+CONF_LOSS = "loss"
+CONF_SEED = "seed"
+CONF_UNITS = "units"
+CONF_REPORT_INTERVAL = "report_interval"
+CONF_AC_VOLTAGE = "ac_voltage"
+CONF_LOAD_RESISTANCE = "load_resistance"
+CONF_AMBIENT_TEMPERATURE = "ambient_temperature"
+CONF_SWEEP = "sweep"
+CONF_STEP_DURATION = "step_duration"
+CONF_MAX_LATENCY = "max_latency"
+CONF_MAX_LOSS = "max_loss"
+CONF_EXIT_WHEN_DONE = "exit_when_done"
+CONF_CONTROLLER_ID = "controller_id"
+CONF_MAX_POLL_TIME = "max_poll_time"
+CONF_MAX_SETPOINT_LATENCY = "max_setpoint_latency"
+
+emerson_r48_sim_ns = cg.esphome_ns.namespace("emerson_r48_sim")
+EmersonR48Simulator = emerson_r48_sim_ns.class_("EmersonR48Simulator", cg.Component)
+
+SWEEP_SCHEMA = cv.Schema(
+    {
+        cv.Required(CONF_UNITS): cv.ensure_list(cv.int_range(min=1, max=60)),
+        cv.Optional(CONF_STEP_DURATION, default="30s"): cv.positive_time_period_milliseconds,
+        cv.Optional(CONF_MAX_LATENCY, default="100ms"): cv.positive_time_period_milliseconds,
+        cv.Optional(CONF_MAX_LOSS, default="0%"): cv.percentage,
+        cv.Optional(CONF_EXIT_WHEN_DONE, default=False): cv.boolean,
+        # controller limits, need controller_id
+        cv.Optional(CONF_MAX_POLL_TIME): cv.positive_time_period_milliseconds,
+        cv.Optional(CONF_MAX_SETPOINT_LATENCY): cv.positive_time_period_milliseconds,
+    }
+)
+
+
+def _validate_controller_limits(config):
+    sweep = config.get(CONF_SWEEP, {})
+    if CONF_CONTROLLER_ID not in config and (
+        CONF_MAX_POLL_TIME in sweep or CONF_MAX_SETPOINT_LATENCY in sweep
+    ):
+        raise cv.Invalid(
+            f"{CONF_MAX_POLL_TIME} and {CONF_MAX_SETPOINT_LATENCY} need {CONF_CONTROLLER_ID}"
+        )
+    return config
+
+
+CONFIG_SCHEMA = cv.All(
+    cv.Schema(
+        {
+            cv.GenerateID(): cv.declare_id(EmersonR48Simulator),
+            cv.Required(CONF_CANBUS_ID): cv.use_id(CanbusComponent),
+            # the emerson_r48 hub under test: its poll time and setpoint latency go into the reports and the sweep
+            cv.Optional(CONF_CONTROLLER_ID): cv.use_id(EmersonR48Component),
+            cv.Optional(
+                CONF_RESPONSE_DELAY, default="5ms"
+            ): cv.positive_time_period_milliseconds,
+            cv.Optional(CONF_LOSS, default="0%"): cv.percentage,
+            cv.Optional(CONF_SEED, default=1): cv.uint32_t,
+            cv.Optional(CONF_UNITS, default=1): cv.int_range(min=1, max=60),
+            cv.Optional(CONF_REPORT_INTERVAL, default="0s"): cv.positive_time_period_milliseconds,
+            cv.Optional(CONF_AC_VOLTAGE, default=230.0): cv.positive_float,
+            cv.Optional(CONF_LOAD_RESISTANCE, default=10.0): cv.positive_not_null_float,
+            cv.Optional(CONF_AMBIENT_TEMPERATURE, default=25.0): cv.float_,
+            cv.Optional(CONF_SWEEP): SWEEP_SCHEMA,
+        }
+    ).extend(cv.COMPONENT_SCHEMA),
+    _validate_controller_limits,
+)
+
+
+async def to_code(config):
+    canbus = await cg.get_variable(config[CONF_CANBUS_ID])
+    var = cg.new_Pvariable(config[CONF_ID], canbus)
+    cg.add(var.set_frame_source(frame_source(canbus)))
+    await cg.register_component(var, config)
+    cg.add(var.set_response_delay(config[CONF_RESPONSE_DELAY]))
+    cg.add(var.set_loss(config[CONF_LOSS]))
+    cg.add(var.set_seed(config[CONF_SEED]))
+    cg.add(var.set_units(config[CONF_UNITS]))
+    cg.add(var.set_report_interval(config[CONF_REPORT_INTERVAL]))
+    cg.add(var.set_ac_voltage(config[CONF_AC_VOLTAGE]))
+    cg.add(var.set_load_resistance(config[CONF_LOAD_RESISTANCE]))
+    cg.add(var.set_ambient_temperature(config[CONF_AMBIENT_TEMPERATURE]))
+    if CONF_CONTROLLER_ID in config:
+        cg.add_define("USE_EMERSON_R48_SIM_CONTROLLER")
+        controller = await cg.get_variable(config[CONF_CONTROLLER_ID])
+        cg.add(var.set_controller(controller))
+
+    if CONF_SWEEP in config:
+        sweep = config[CONF_SWEEP]
+        for units in sweep[CONF_UNITS]:
+            cg.add(var.add_sweep_step(units))
+        cg.add(
+            var.set_sweep_limits(
+                sweep[CONF_STEP_DURATION],
+                sweep[CONF_MAX_LATENCY],
+                sweep[CONF_MAX_LOSS],
+            )
+        )
+        cg.add(var.set_exit_when_done(sweep[CONF_EXIT_WHEN_DONE]))
+        if CONF_CONTROLLER_ID in config:
+            cg.add(
+                var.set_sweep_controller_limits(
+                    sweep.get(CONF_MAX_POLL_TIME, 0),
+                    sweep.get(CONF_MAX_SETPOINT_LATENCY, 0),
+                )
+            )
@@ -0,0 +1,416 @@
+#include "emerson_r48_sim.h"
+#include "esphome/core/log.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+
+namespace esphome {
+namespace emerson_r48_sim {
+
+static const char *const TAG = "emerson_r48_sim";
+
+// model constants, loosely fitted to an R48-3000e
+static const float SIM_EFFICIENCY = 0.95f;
+static const float SIM_VOLTAGE_TAU_S = 0.2f;
+static const float SIM_HEAT_CAPACITY = 400.0f;  // J/K
+static const float SIM_THERMAL_TAU_S = 120.0f;
+static const float SIM_THERMAL_TAU_FAN_FULL_S = 45.0f;
+
+static const uint8_t CTL_DC_OFF = 1 << 7;
+static const uint8_t CTL_FAN_FULL = 1 << 4;
+static const uint8_t CTL_AC_OFF = 1 << 2;
+
+#ifdef USE_EMERSON_R48_SIM_CONTROLLER
+// output voltage setpoints given to the controller at the start of alternate sweep steps
+static const float SWEEP_SETPOINTS[2] = {52.0f, 53.5f};
+#endif
+
+void EmersonR48Simulator::setup() {
+  if (this->frame_source_ == nullptr) {
+    ESP_LOGE(TAG, "The canbus platform does not provide a frame source");
+    this->mark_failed();
+    return;
+  }
+  this->frame_source_->add_frame_listener(this);
+  uint8_t max_units = this->units_;
+  for (uint8_t units : this->sweep_units_)
+    max_units = std::max(max_units, units);
+  this->pending_capacity_ = (size_t) max_units * MAX_PENDING_REPLIES;
+  this->pending_.reserve(this->pending_capacity_);
+  this->sweep_results_.reserve(this->sweep_units_.size());
+  this->last_step_ = millis();
+  this->last_report_ = this->last_step_;
+  if (!this->sweep_units_.empty())
+    this->start_sweep_step_(this->last_step_);
+}
+
+void EmersonR48Simulator::dump_config() {
+  ESP_LOGCONFIG(TAG, "Emerson R48 simulator:");
+  ESP_LOGCONFIG(TAG, "  Units: %u", this->units_);
+  ESP_LOGCONFIG(TAG, "  Response delay: %u ms", (unsigned) this->response_delay_);
+  ESP_LOGCONFIG(TAG, "  Loss: %.1f %%", this->loss_ * 100.0f);
+  ESP_LOGCONFIG(TAG, "  AC voltage: %.1f V, load: %.2f Ohm, ambient: %.1f C", this->ac_voltage_,
+                this->load_resistance_, this->ambient_temperature_);
+  if (!this->sweep_units_.empty()) {
+    ESP_LOGCONFIG(TAG, "  Sweep: %u steps of %u ms, max latency: %u ms, max loss: %.1f %%",
+                  (unsigned) this->sweep_units_.size(), (unsigned) this->sweep_step_duration_,
+                  (unsigned) this->sweep_max_latency_, this->sweep_max_loss_ * 100.0f);
+  }
+}
+
+void EmersonR48Simulator::loop() {
+  uint32_t now = millis();
+  this->step_model_(now);
+  this->send_due_replies_(now);
+  if (this->sweep_step_ < this->sweep_units_.size()) {
+    if (now - this->sweep_step_start_ >= this->sweep_step_duration_)
+      this->finish_sweep_step_(now);
+  } else if (this->report_interval_ > 0 && now - this->last_report_ >= this->report_interval_) {
+    this->report();
+  }
+}
+
+float EmersonR48Simulator::bus_load_(uint32_t now) const {
+  uint32_t elapsed = now - this->last_report_;
+  if (elapsed == 0 || this->frame_source_ == nullptr)
+    return NAN;
+  return 100.0f * this->bus_bits_ / (elapsed / 1000.0f * this->frame_source_->get_bit_rate_bps());
+}
+
+void EmersonR48Simulator::report() {
+  uint32_t now = millis();
+  uint32_t elapsed = now - this->last_report_;
+  float bus_load = this->bus_load_(now);
+  uint32_t latency_avg = this->replies_sent_ > 0 ? this->latency_sum_ / this->replies_sent_ : 0;
+  // the controller's poll cycles and setpoint read backs over the same interval
+  char controller[192] = "";
+#ifdef USE_EMERSON_R48_SIM_CONTROLLER
+  if (this->controller_ != nullptr) {
+    const emerson_r48::PollStatistics &stats = this->controller_->get_poll_statistics();
+    snprintf(controller, sizeof(controller),
+             ",\"poll_cycles\":%u,\"poll_missed\":%u,\"poll_time_avg_ms\":%u,\"poll_time_max_ms\":%u,"
+             "\"setpoints\":%u,\"setpoint_latency_max_ms\":%u",
+             (unsigned) stats.cycles, (unsigned) stats.missed,
+             (unsigned) (stats.cycles > 0 ? stats.poll_time_sum_ms / stats.cycles : 0),
+             (unsigned) stats.poll_time_max_ms, (unsigned) stats.setpoints, (unsigned) stats.setpoint_latency_max_ms);
+    this->controller_->reset_poll_statistics();
+  }
+#endif
+  ESP_LOGI(TAG,
+           "report: {\"units\":%u,\"elapsed_ms\":%u,\"frames_received\":%u,\"replies_sent\":%u,"
+           "\"replies_lost\":%u,\"replies_dropped\":%u,\"tx_errors\":%u,\"pending_peak\":%u,"
+           "\"latency_avg_ms\":%u,\"latency_max_ms\":%u,\"bus_bits\":%u,\"bus_load\":%.2f%s}",
+           this->units_, (unsigned) elapsed, (unsigned) this->frames_received_, (unsigned) this->replies_sent_,
+           (unsigned) this->replies_lost_, (unsigned) this->replies_dropped_, (unsigned) this->tx_errors_,
+           (unsigned) this->pending_peak_, (unsigned) latency_avg, (unsigned) this->latency_max_,
+           (unsigned) this->bus_bits_, bus_load, controller);
+  this->bus_bits_ = 0;
+  this->latency_max_ = 0;
+  this->latency_sum_ = 0;
+  this->last_report_ = now;
+}
+
+void EmersonR48Simulator::reset_counters_(uint32_t now) {
+  this->frames_received_ = 0;
+  this->replies_sent_ = 0;
+  this->replies_lost_ = 0;
+  this->replies_dropped_ = 0;
+  this->tx_errors_ = 0;
+  this->pending_peak_ = 0;
+  this->bus_bits_ = 0;
+  this->latency_max_ = 0;
+  this->latency_sum_ = 0;
+  this->last_report_ = now;
+#ifdef USE_EMERSON_R48_SIM_CONTROLLER
+  if (this->controller_ != nullptr)
+    this->controller_->reset_poll_statistics();
+#endif
+}
+
+void EmersonR48Simulator::start_sweep_step_(uint32_t now) {
+  this->units_ = this->sweep_units_[this->sweep_step_];
+  // replies queued for the previous bank size would count against this one
+  this->pending_.clear();
+  this->reset_counters_(now);
+  this->sweep_step_start_ = now;
+  ESP_LOGI(TAG, "Sweep step %u/%u: %u units", (unsigned) this->sweep_step_ + 1,
+           (unsigned) this->sweep_units_.size(), this->units_);
+#ifdef USE_EMERSON_R48_SIM_CONTROLLER
+  // a new setpoint per step, its read back by the controller is the step's setpoint latency
+  if (this->controller_ != nullptr)
+    this->controller_->set_output_voltage(SWEEP_SETPOINTS[this->sweep_step_ % 2]);
+#endif
+}
+
+void EmersonR48Simulator::finish_sweep_step_(uint32_t now) {
+  // injected loss is the configured fault, not a capacity problem: only replies the simulator could not
+  // queue count as lost here. Replies still waiting for the bus at the end of the step count as late.
+  uint32_t expected = this->replies_sent_ + this->replies_dropped_;
+  float loss = expected > 0 ? (float) this->replies_dropped_ / expected : 0.0f;
+  uint32_t latency_max = this->latency_max_;
+  for (const PendingReply &reply : this->pending_)
+    latency_max = std::max(latency_max, now - reply.received);
+  SweepResult result{};
+  result.units = this->units_;
+  result.requests = this->frames_received_;
+  result.replies = expected;
+  result.loss = loss;
+  result.latency_max_ms = latency_max;
+  result.bus_load = this->bus_load_(now);
+  bool passed =
+      this->frames_received_ > 0 && latency_max <= this->sweep_max_latency_ && loss <= this->sweep_max_loss_;
+  bool controller_passed = true;
+#ifdef USE_EMERSON_R48_SIM_CONTROLLER
+  if (this->controller_ != nullptr) {
+    // a step in which the controller completed no poll cycle or never read its setpoint back fails as well
+    const emerson_r48::PollStatistics &stats = this->controller_->get_poll_statistics();
+    result.poll_cycles = stats.cycles;
+    result.poll_missed = stats.missed;
+    result.poll_time_max_ms = stats.poll_time_max_ms;
+    result.setpoints = stats.setpoints;
+    result.setpoint_latency_max_ms = stats.setpoint_latency_max_ms;
+    controller_passed = stats.cycles > 0 && stats.setpoints > 0 &&
+                        (this->sweep_max_poll_time_ == 0 || stats.poll_time_max_ms <= this->sweep_max_poll_time_) &&
+                        (this->sweep_max_setpoint_latency_ == 0 ||
+                         stats.setpoint_latency_max_ms <= this->sweep_max_setpoint_latency_);
+  }
+#endif
+  passed = passed && controller_passed;
+  result.passed = passed;
+  this->sweep_results_.push_back(result);
+  this->report();
+  ESP_LOGI(TAG,
+           "sweep: {\"units\":%u,\"requests\":%u,\"replies\":%u,\"loss\":%.4f,\"latency_max_ms\":%u,"
+           "\"bus_load\":%.2f,\"poll_cycles\":%u,\"poll_missed\":%u,\"poll_time_max_ms\":%u,\"setpoints\":%u,"
+           "\"setpoint_latency_max_ms\":%u,\"passed\":%s}",
+           result.units, (unsigned) result.requests, (unsigned) result.replies, result.loss,
+           (unsigned) result.latency_max_ms, result.bus_load, (unsigned) result.poll_cycles,
+           (unsigned) result.poll_missed, (unsigned) result.poll_time_max_ms, (unsigned) result.setpoints,
+           (unsigned) result.setpoint_latency_max_ms, passed ? "true" : "false");
+  if (passed) {
+    this->sweep_max_units_passed_ = std::max(this->sweep_max_units_passed_, this->units_);
+  } else {
+    if (this->frames_received_ == 0) {
+      ESP_LOGE(TAG, "Sweep step with %u units saw no frames, is emerson_r48 polling?", this->units_);
+    } else if (!controller_passed) {
+      ESP_LOGE(TAG, "Sweep step with %u units failed on the controller: %u poll cycles (max %u ms), %u setpoints "
+               "read back (max %u ms)", this->units_, (unsigned) result.poll_cycles,
+               (unsigned) result.poll_time_max_ms, (unsigned) result.setpoints,
+               (unsigned) result.setpoint_latency_max_ms);
+    } else {
+      ESP_LOGE(TAG, "Sweep step with %u units failed: latency %u ms (max %u), loss %.2f %% (max %.2f)",
+               this->units_, (unsigned) latency_max, (unsigned) this->sweep_max_latency_, loss * 100.0f,
+               this->sweep_max_loss_ * 100.0f);
+    }
+    this->sweep_passed_ = false;
+    this->status_set_warning();
+  }
+
+  if (++this->sweep_step_ < this->sweep_units_.size()) {
+    this->start_sweep_step_(now);
+    return;
+  }
+  ESP_LOGI(TAG, "sweep_done: {\"steps\":%u,\"passed\":%s,\"max_units_passed\":%u}",
+           (unsigned) this->sweep_units_.size(), this->sweep_passed_ ? "true" : "false",
+           this->sweep_max_units_passed_);
+#ifdef USE_HOST
+  if (this->exit_when_done_)
+    exit(this->sweep_passed_ ? 0 : 1);
+#endif
+}
+
+void EmersonR48Simulator::on_frames(const canbus::CanFrame *frames, const uint32_t *timestamps_us,
+                                    size_t count) {
+  for (size_t i = 0; i < count; i++) {
+    const canbus::CanFrame &frame = frames[i];
+    this->bus_bits_ += canbus_ext::frame_bits(frame);
+    if (!frame.use_extended_id || frame.remote_transmission_request)
+      continue;
+    this->handle_frame_(frame.can_id, frame.data, frame.can_data_length_code);
+  }
+}
+
+void EmersonR48Simulator::handle_frame_(uint32_t can_id, const uint8_t *data, size_t length) {
+  if (length < EMR48_FRAME_LENGTH)
+    return;
+  this->frames_received_++;
+  uint32_t now = millis();
+
+  if (can_id == CAN_ID_REQUEST) {
+    // every unit on the bus answers
+    for (uint8_t unit = 0; unit < this->units_; unit++) {
+      if (memcmp(data, EMR48_READ_ALL, EMR48_FRAME_LENGTH) == 0) {
+        for (uint8_t i = 0; i < EMR48_READ_PARAM_COUNT; i++)
+          this->queue_reply_(read_param(i).id, unit, now);
+      } else if (data[0] == 0x01) {
+        this->queue_reply_(data[3], unit, now);
+      }
+    }
+    return;
+  }
+
+  float value;
+  const ParamDef *param = decode_set_frame(can_id, data, length, &value);
+  if (param != nullptr) {
+    if (!(value >= param->min && value <= param->max)) {
+      ESP_LOGW(TAG, "%s out of range: %f", param->name, value);
+      return;
+    }
+    switch (param->id) {
+      case EMR48_SET_OUTPUT_V_ONLINE:
+        this->online_voltage_ = value;
+        this->online_voltage_until_ = now + EMR48_ONLINE_COMMAND_TIMEOUT_MS;
+        break;
+      case EMR48_SET_OUTPUT_V_OFFLINE:
+        this->offline_voltage_ = value;
+        break;
+      case EMR48_SET_OUTPUT_AL_ONLINE:
+        this->online_current_limit_ = value;
+        this->online_current_limit_until_ = now + EMR48_ONLINE_COMMAND_TIMEOUT_MS;
+        break;
+      case EMR48_SET_OUTPUT_AL_OFFLINE:
+        this->offline_current_limit_ = value;
+        break;
+      case EMR48_SET_INPUT_AL:
+        this->input_current_limit_ = value;
+        break;
+      default:
+        break;
+    }
+    ESP_LOGD(TAG, "%s <- %f", param->name, value);
+    return;
+  }
+
+  // control frame: 0x00, 0xF0, msgv, 0x80, ... (gimme5 shares the id but starts with 0x20)
+  if (can_id == CAN_ID_SET_CTL && data[0] == 0x00 && data[3] == 0x80) {
+    if (this->control_ != data[2])
+      ESP_LOGD(TAG, "Control bits <- 0x%02X", data[2]);
+    this->control_ = data[2];
+  }
+}
+
+void EmersonR48Simulator::queue_reply_(uint8_t param, uint8_t unit, uint32_t now) {
+  if (param_index(param, PARAM_READ) == EMR48_PARAM_COUNT)
+    return;
+  if (this->pending_.size() >= this->pending_capacity_) {
+    this->replies_dropped_++;
+    return;
+  }
+  this->pending_.push_back({now, now + this->response_delay_, param, unit});
+  this->pending_peak_ = std::max(this->pending_peak_, this->pending_.size());
+}
+
+void EmersonR48Simulator::send_due_replies_(uint32_t now) {
+  size_t kept = 0;
+  bool tx_busy = false;
+  for (size_t i = 0; i < this->pending_.size(); i++) {
+    const PendingReply &reply = this->pending_[i];
+    // once the driver refuses a frame the rest waits for the next loop, like a transceiver waiting for the bus
+    if (tx_busy || (int32_t) (now - reply.due) < 0) {
+      this->pending_[kept++] = reply;
+      continue;
+    }
+    if (this->lose_frame_()) {
+      this->replies_lost_++;
+      continue;
+    }
+    if (!this->send_reply_(reply, now)) {
+      tx_busy = true;
+      this->pending_[kept++] = reply;
+    }
+  }
+  this->pending_.resize(kept);
+}
+
+bool EmersonR48Simulator::send_reply_(const PendingReply &reply, uint32_t now) {
+  canbus::CanFrame frame{};
+  frame.can_id = data_reply_id(reply.unit);
+  frame.use_extended_id = true;
+  frame.can_data_length_code = EMR48_FRAME_LENGTH;
+  encode_data_reply(reply.param, this->read_value_(reply.param, now), frame.data);
+  std::vector<uint8_t> data(frame.data, frame.data + EMR48_FRAME_LENGTH);
+  if (this->canbus_->send_data(frame.can_id, true, data) != canbus::ERROR_OK) {
+    this->tx_errors_++;
+    return false;
+  }
+  this->bus_bits_ += canbus_ext::frame_bits(frame);
+  this->replies_sent_++;
+  uint32_t latency = now - reply.received;
+  this->latency_max_ = std::max(this->latency_max_, latency);
+  this->latency_sum_ += latency;
+  return true;
+}
+
+float EmersonR48Simulator::read_value_(uint8_t param, uint32_t now) const {
+  switch (param) {
+    case EMR48_DATA_OUTPUT_V:
+      return this->output_voltage_;
+    case EMR48_DATA_OUTPUT_A:
+      return this->output_current_;
+    case EMR48_DATA_OUTPUT_AL:
+      return this->current_limit_(now);
+    case EMR48_DATA_OUTPUT_T:
+      return this->temperature_;
+    case EMR48_DATA_OUTPUT_IV:
+      return this->ac_voltage_;
+    default:
+      return NAN;
+  }
+}
+
+float EmersonR48Simulator::voltage_setpoint_(uint32_t now) const {
+  return (int32_t) (now - this->online_voltage_until_) < 0 ? this->online_voltage_ : this->offline_voltage_;
+}
+
+float EmersonR48Simulator::current_limit_(uint32_t now) const {
+  return (int32_t) (now - this->online_current_limit_until_) < 0 ? this->online_current_limit_
+                                                                 : this->offline_current_limit_;
+}
+
+void EmersonR48Simulator::step_model_(uint32_t now) {
+  float dt = (now - this->last_step_) / 1000.0f;
+  if (dt <= 0.0f)
+    return;
+  this->last_step_ = now;
+
+  // steady state operating point of the bank: voltage source, then current limit, then input power limit.
+  // Units share the load equally.
+  float target_v = 0.0f;
+  if (!(this->control_ & (CTL_DC_OFF | CTL_AC_OFF)) && this->ac_voltage_ > 0.0f) {
+    float r = this->load_resistance_;
+    target_v = this->voltage_setpoint_(now);
+    float max_i = this->units_ * this->current_limit_(now) / EMR48_OUTPUT_CURRENT_RATED_PERCENTAGE *
+                  EMR48_OUTPUT_CURRENT_RATED_VALUE;
+    if (target_v / r > max_i)
+      target_v = max_i * r;
+    float max_p = this->units_ * this->ac_voltage_ * this->input_current_limit_ * SIM_EFFICIENCY;
+    if (target_v * target_v / r > max_p)
+      target_v = sqrtf(max_p * r);
+  }
+
+  float alpha = dt / (SIM_VOLTAGE_TAU_S + dt);
+  this->output_voltage_ += (target_v - this->output_voltage_) * alpha;
+  this->output_current_ = this->output_voltage_ / this->load_resistance_ / this->units_;
+
+  float loss = this->output_voltage_ * this->output_current_ * (1.0f / SIM_EFFICIENCY - 1.0f);
+  float tau = (this->control_ & CTL_FAN_FULL) ? SIM_THERMAL_TAU_FAN_FULL_S : SIM_THERMAL_TAU_S;
+  this->temperature_ +=
+      dt * (loss / SIM_HEAT_CAPACITY - (this->temperature_ - this->ambient_temperature_) / tau);
+}
+
+// xorshift32, seeded from the config so lossy runs are reproducible
+bool EmersonR48Simulator::lose_frame_() {
+  if (this->loss_ <= 0.0f)
+    return false;
+  uint32_t x = this->rng_state_;
+  x ^= x << 13;
+  x ^= x >> 17;
+  x ^= x << 5;
+  this->rng_state_ = x;
+  return (x / 4294967296.0f) < this->loss_;
+}
+
+}  // namespace emerson_r48_sim
+}  // namespace esphome
@@ -0,0 +1,183 @@
+#pragma once
+
+#include "esphome/core/component.h"
+#include "esphome/components/canbus/canbus.h"
+#include "esphome/components/canbus_ext/canbus_ext.h"
+#include "esphome/components/emerson_r48_protocol/emerson_r48_protocol.h"
+#ifdef USE_EMERSON_R48_SIM_CONTROLLER
+#include "esphome/components/emerson_r48/emerson_r48.h"
+#endif
+
+#include <vector>
+
+namespace esphome {
+namespace emerson_r48_sim {
+
+using namespace emerson_r48;
+
+// per simulated unit
+static const uint8_t MAX_PENDING_REPLIES = 16;
+static const uint8_t MAX_UNITS = 60;
+
+// Outcome of one sweep step, as logged in its "sweep: {...}" line. The poll_* and setpoint_* fields are the
+// controller's own view and stay 0 without a controller.
+struct SweepResult {
+  uint8_t units;
+  uint32_t requests;
+  uint32_t replies;
+  float loss;
+  uint32_t latency_max_ms;
+  float bus_load;
+  uint32_t poll_cycles;
+  uint32_t poll_missed;
+  uint32_t poll_time_max_ms;
+  uint32_t setpoints;
+  uint32_t setpoint_latency_max_ms;
+  bool passed;
+};
+
+// Behavioral model of an Emerson / Vertiv R48 rectifier answering the protocol spoken by emerson_r48:
+// parameter reads, READ_ALL, online / offline setpoint writes with the 30 s online expiry and control frames.
+// The electrical side is a voltage source with current and input power limits into a resistive load,
+// the thermal side a single time constant towards ambient.
+// With units > 1 the simulator stands in for a bank of identical rectifiers sharing the bus and the load:
+// setpoints and control frames are broadcast, every unit answers every read with its own address (0 to
+// units - 1) in the source bits of the reply id.
+class EmersonR48Simulator : public Component, public canbus_ext::FrameListener {
+ public:
+  EmersonR48Simulator(canbus::Canbus *canbus) : canbus_(canbus) {}
+  void set_frame_source(canbus_ext::FrameSource *frame_source) { frame_source_ = frame_source; }
+
+  void set_response_delay(uint32_t response_delay) { response_delay_ = response_delay; }
+  void set_loss(float loss) { loss_ = loss; }
+  void set_units(uint8_t units) { units_ = units; }
+  // Capacity sweep: runs each bank size for step_duration and checks the reply latency and loss of the step
+  void add_sweep_step(uint8_t units) { sweep_units_.push_back(units); }
+  void set_sweep_limits(uint32_t step_duration, uint32_t max_latency, float max_loss) {
+    sweep_step_duration_ = step_duration;
+    sweep_max_latency_ = max_latency;
+    sweep_max_loss_ = max_loss;
+  }
+#ifdef USE_EMERSON_R48_SIM_CONTROLLER
+  // The emerson_r48 hub on the same bus: its poll cycle time and setpoint latency go into the reports, and every
+  // sweep step starts with a new output voltage setpoint on it and also fails on the controller limits (0: none)
+  void set_controller(emerson_r48::EmersonR48Component *controller) { controller_ = controller; }
+  void set_sweep_controller_limits(uint32_t max_poll_time, uint32_t max_setpoint_latency) {
+    sweep_max_poll_time_ = max_poll_time;
+    sweep_max_setpoint_latency_ = max_setpoint_latency;
+  }
+#endif
+  // host only: exit the process when the sweep is done, status 0 if every step passed
+  void set_exit_when_done(bool exit_when_done) { exit_when_done_ = exit_when_done; }
+  void set_report_interval(uint32_t report_interval) { report_interval_ = report_interval; }
+  void set_seed(uint32_t seed) { rng_state_ = seed != 0 ? seed : 1; }
+  void set_ac_voltage(float ac_voltage) { ac_voltage_ = ac_voltage; }
+  void set_load_resistance(float load_resistance) { load_resistance_ = load_resistance; }
+  void set_ambient_temperature(float ambient_temperature) {
+    ambient_temperature_ = ambient_temperature;
+    temperature_ = ambient_temperature;
+  }
+
+  void setup() override;
+  void loop() override;
+  void dump_config() override;
+  float get_setup_priority() const override { return setup_priority::DATA; }
+
+  void on_frames(const canbus::CanFrame *frames, const uint32_t *timestamps_us, size_t count) override;
+
+  float get_output_voltage() const { return output_voltage_; }
+  float get_output_current() const { return output_current_; }
+  float get_temperature() const { return temperature_; }
+
+  // Logs the counters and bus utilisation since the last report as one JSON line
+  void report();
+  bool is_sweep_done() const { return !sweep_units_.empty() && sweep_step_ >= sweep_units_.size(); }
+  const std::vector<SweepResult> &get_sweep_results() const { return sweep_results_; }
+
+ protected:
+  struct PendingReply {
+    uint32_t received;  // request reception
+    uint32_t due;
+    uint8_t param;
+    uint8_t unit;
+  };
+
+  canbus::Canbus *canbus_;
+  canbus_ext::FrameSource *frame_source_{nullptr};
+
+  uint8_t units_{1};
+  uint32_t report_interval_{0};
+  uint32_t response_delay_{0};
+  float loss_{0.0f};
+  uint32_t rng_state_{1};
+  float ac_voltage_{230.0f};
+  float load_resistance_{10.0f};
+  float ambient_temperature_{25.0f};
+
+  // setpoints, the online values win until they expire
+  float offline_voltage_{53.5f};
+  float offline_current_limit_{EMR48_OUTPUT_CURRENT_RATED_PERCENTAGE};
+  float online_voltage_{0.0f};
+  float online_current_limit_{0.0f};
+  uint32_t online_voltage_until_{0};
+  uint32_t online_current_limit_until_{0};
+  float input_current_limit_{EMR48_UNBOUNDED};
+  uint8_t control_{0x01};
+
+  // model state
+  float output_voltage_{0.0f};
+  float output_current_{0.0f};  // per unit
+  float temperature_{25.0f};
+  uint32_t last_step_{0};
+
+  // sized for all units in setup(), never grows afterwards
+  std::vector<PendingReply> pending_;
+  size_t pending_capacity_{0};
+  size_t pending_peak_{0};
+
+  uint32_t frames_received_{0};
+  uint32_t replies_sent_{0};
+  uint32_t replies_lost_{0};
+  uint32_t replies_dropped_{0};
+  uint32_t tx_errors_{0};  // driver refused the frame, retried on the next loop
+  // bits seen on the bus (received and sent) since the last report
+  uint32_t bus_bits_{0};
+  uint32_t last_report_{0};
+
+  // request to reply time of the replies sent since the last report (bus and TX queueing included)
+  uint32_t latency_max_{0};
+  uint64_t latency_sum_{0};
+
+  std::vector<uint8_t> sweep_units_;
+  uint32_t sweep_step_duration_{30000};
+  uint32_t sweep_max_latency_{100};
+  float sweep_max_loss_{0.0f};
+  bool exit_when_done_{false};
+  size_t sweep_step_{0};
+  uint32_t sweep_step_start_{0};
+  bool sweep_passed_{true};
+  uint8_t sweep_max_units_passed_{0};
+  std::vector<SweepResult> sweep_results_;
+#ifdef USE_EMERSON_R48_SIM_CONTROLLER
+  emerson_r48::EmersonR48Component *controller_{nullptr};
+  uint32_t sweep_max_poll_time_{0};
+  uint32_t sweep_max_setpoint_latency_{0};
+#endif
+
+  void handle_frame_(uint32_t can_id, const uint8_t *data, size_t length);
+  void queue_reply_(uint8_t param, uint8_t unit, uint32_t now);
+  void send_due_replies_(uint32_t now);
+  bool send_reply_(const PendingReply &reply, uint32_t now);
+  void start_sweep_step_(uint32_t now);
+  void finish_sweep_step_(uint32_t now);
+  void reset_counters_(uint32_t now);
+  float bus_load_(uint32_t now) const;
+  void step_model_(uint32_t now);
+  float read_value_(uint8_t param, uint32_t now) const;
+  float voltage_setpoint_(uint32_t now) const;
+  float current_limit_(uint32_t now) const;
+  bool lose_frame_();
+};
+
+}  // namespace emerson_r48_sim
+}  // namespace esphome
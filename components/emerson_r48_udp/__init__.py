@@ -0,0 +1,63 @@
+import esphome.codegen as cg
+import esphome.config_validation as cv
+from esphome.components.emerson_r48 import EmersonR48Component, CONF_EMERSON_R48_ID
+from esphome.components.emerson_r48.sensor import SLOT_TYPES, sensor_slot
+from esphome.const import CONF_ADDRESS, CONF_ID, CONF_PORT
+
+CODEOWNERS = ["@leodesigner"]
+DEPENDENCIES = ["network", "emerson_r48"]
+AUTO_LOAD = ["socket"]
+
+CONF_SAMPLES_PER_PACKET = "samples_per_packet"
+CONF_VALUES = "values"
+CONF_FLUSH_TIMEOUT = "flush_timeout"
+
+# keep in sync with emerson_r48_udp.h
+UDP_HEADER_SIZE = 12
+UDP_MAX_DATAGRAM = 1400
+
+emerson_r48_udp_ns = cg.esphome_ns.namespace("emerson_r48_udp")
+EmersonR48Udp = emerson_r48_udp_ns.class_("EmersonR48Udp", cg.Component)
+
+
+def validate_datagram_size(config):
+    values = len(set(config[CONF_VALUES]))
+    sample_size = 4 + 4 * values
+    max_samples = (UDP_MAX_DATAGRAM - UDP_HEADER_SIZE) // sample_size
+    if config[CONF_SAMPLES_PER_PACKET] > max_samples:
+        raise cv.Invalid(
+            f"{values} values allow at most {max_samples} samples per packet"
+        )
+    return config
+
+
+CONFIG_SCHEMA = cv.All(
+    cv.Schema(
+        {
+            cv.GenerateID(): cv.declare_id(EmersonR48Udp),
+            cv.GenerateID(CONF_EMERSON_R48_ID): cv.use_id(EmersonR48Component),
+            cv.Required(CONF_ADDRESS): cv.ipv4address,
+            cv.Optional(CONF_PORT, default=4848): cv.port,
+            cv.Optional(
+                CONF_VALUES, default=["output_voltage", "output_current"]
+            ): cv.All(cv.ensure_list(cv.one_of(*SLOT_TYPES, lower=True)), cv.Length(min=1)),
+            cv.Optional(CONF_SAMPLES_PER_PACKET, default=10): cv.int_range(min=1, max=255),
+            # a partial batch goes out once its first sample is this old, e.g. when polling stops
+            cv.Optional(
+                CONF_FLUSH_TIMEOUT, default="30s"
+            ): cv.positive_time_period_milliseconds,
+        }
+    ).extend(cv.COMPONENT_SCHEMA),
+    validate_datagram_size,
+)
+
+
+async def to_code(config):
+    parent = await cg.get_variable(config[CONF_EMERSON_R48_ID])
+    var = cg.new_Pvariable(config[CONF_ID], parent)
+    await cg.register_component(var, config)
+    cg.add(var.set_address(str(config[CONF_ADDRESS]), config[CONF_PORT]))
+    for key in config[CONF_VALUES]:
+        cg.add(var.add_slot(sensor_slot(key)))
+    cg.add(var.set_samples_per_packet(config[CONF_SAMPLES_PER_PACKET]))
+    cg.add(var.set_flush_timeout(config[CONF_FLUSH_TIMEOUT]))
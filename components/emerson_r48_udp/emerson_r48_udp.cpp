@@ -0,0 +1,105 @@
+#include "emerson_r48_udp.h"
+#include "esphome/core/log.h"
+
+#include <cerrno>
+#include <cstring>
+
+namespace esphome {
+namespace emerson_r48_udp {
+
+static const char *const TAG = "emerson_r48_udp";
+
+static uint8_t *put_u16(uint8_t *pos, uint16_t value) {
+  pos[0] = value;
+  pos[1] = value >> 8;
+  return pos + 2;
+}
+
+static uint8_t *put_u32(uint8_t *pos, uint32_t value) {
+  pos[0] = value;
+  pos[1] = value >> 8;
+  pos[2] = value >> 16;
+  pos[3] = value >> 24;
+  return pos + 4;
+}
+
+static uint8_t *put_float(uint8_t *pos, float value) {
+  uint32_t bits;
+  memcpy(&bits, &value, sizeof(bits));
+  return put_u32(pos, bits);
+}
+
+void EmersonR48Udp::setup() {
+  this->socket_ = socket::socket_ip(SOCK_DGRAM, IPPROTO_UDP);
+  if (this->socket_ == nullptr) {
+    ESP_LOGE(TAG, "Could not create socket");
+    this->mark_failed();
+    return;
+  }
+  this->socket_->setblocking(false);
+  this->destination_len_ = socket::set_sockaddr((struct sockaddr *) &this->destination_, sizeof(this->destination_),
+                                                this->address_, this->port_);
+  if (this->destination_len_ == 0) {
+    ESP_LOGE(TAG, "Invalid address %s", this->address_.c_str());
+    this->mark_failed();
+    return;
+  }
+  this->parent_->add_on_snapshot_callback([this](const TelemetrySnapshot &snapshot) { this->add_sample_(snapshot); });
+}
+
+// snapshots stop with the polling (rectifiers gone, node asleep), the batch collected so far still goes out
+void EmersonR48Udp::loop() {
+  if (this->sample_count_ > 0 && millis() - this->first_sample_ms_ >= this->flush_timeout_)
+    this->send_();
+}
+
+void EmersonR48Udp::dump_config() {
+  ESP_LOGCONFIG(TAG, "Emerson R48 UDP stream:");
+  ESP_LOGCONFIG(TAG, "  Destination: %s:%u", this->address_.c_str(), this->port_);
+  ESP_LOGCONFIG(TAG, "  Slot mask: 0x%04X, %u samples of %u bytes per datagram", this->slot_mask_,
+                this->samples_per_packet_, (unsigned) this->sample_size_());
+  ESP_LOGCONFIG(TAG, "  Flush timeout: %u ms", (unsigned) this->flush_timeout_);
+}
+
+size_t EmersonR48Udp::sample_size_() const {
+  size_t size = 4;
+  for (uint8_t slot = 1; slot < SENSOR_COUNT; slot++) {
+    if (this->slot_mask_ & (1u << slot))
+      size += 4;
+  }
+  return size;
+}
+
+void EmersonR48Udp::add_sample_(const TelemetrySnapshot &snapshot) {
+  if (this->sample_count_ == 0)
+    this->first_sample_ms_ = millis();
+  uint8_t *pos = this->datagram_ + UDP_HEADER_SIZE + this->sample_count_ * this->sample_size_();
+  pos = put_u32(pos, snapshot.timestamp_ms);
+  for (uint8_t slot = 1; slot < SENSOR_COUNT; slot++) {
+    if (this->slot_mask_ & (1u << slot))
+      pos = put_float(pos, snapshot.values[slot]);
+  }
+  if (++this->sample_count_ >= this->samples_per_packet_)
+    this->send_();
+}
+
+void EmersonR48Udp::send_() {
+  uint8_t *pos = this->datagram_;
+  memcpy(pos, "R48T", 4);
+  pos += 4;
+  *pos++ = UDP_FORMAT_VERSION;
+  *pos++ = this->sample_count_;
+  pos = put_u16(pos, this->slot_mask_);
+  put_u32(pos, this->sequence_++);
+
+  const size_t length = UDP_HEADER_SIZE + this->sample_count_ * this->sample_size_();
+  this->sample_count_ = 0;
+  // non-blocking: a datagram the stack cannot take right now is dropped, the sequence gap shows it
+  ssize_t sent = this->socket_->sendto(this->datagram_, length, 0, (struct sockaddr *) &this->destination_,
+                                       this->destination_len_);
+  if (sent != (ssize_t) length && (this->send_errors_++ % 100) == 0)
+    ESP_LOGW(TAG, "sendto failed: errno %d (%u failures)", errno, (unsigned) this->send_errors_);
+}
+
+}  // namespace emerson_r48_udp
+}  // namespace esphome
@@ -0,0 +1,66 @@
+#pragma once
+
+#include "esphome/core/component.h"
+#include "esphome/components/emerson_r48/emerson_r48.h"
+#include "esphome/components/socket/socket.h"
+
+#include <memory>
+#include <string>
+
+namespace esphome {
+namespace emerson_r48_udp {
+
+using namespace emerson_r48;
+
+// Datagram layout, all fields little endian:
+//   header  "R48T", version, sample count, slot mask (u16), datagram sequence (u32)
+//   sample  snapshot timestamp in ms (u32), one float per slot set in the mask, in SensorSlot order
+// Every datagram of a config has the same sample size, only the count varies on a flush.
+static const uint8_t UDP_FORMAT_VERSION = 1;
+static const size_t UDP_HEADER_SIZE = 12;
+// stays below the Ethernet MTU, __init__.py limits samples_per_packet accordingly
+static const size_t UDP_MAX_DATAGRAM = 1400;
+static_assert(SENSOR_COUNT <= 16, "the slot mask is 16 bits wide");
+
+class EmersonR48Udp : public Component {
+ public:
+  EmersonR48Udp(EmersonR48Component *parent) : parent_(parent) {}
+  void set_address(const std::string &address, uint16_t port) {
+    this->address_ = address;
+    this->port_ = port;
+  }
+  // __init__.py names the slots by enum member, the mask never depends on a copy of the SensorSlot order
+  void add_slot(SensorSlot slot) { this->slot_mask_ |= 1u << slot; }
+  void set_samples_per_packet(uint8_t samples_per_packet) { this->samples_per_packet_ = samples_per_packet; }
+  void set_flush_timeout(uint32_t flush_timeout) { this->flush_timeout_ = flush_timeout; }
+
+  void setup() override;
+  void loop() override;
+  void dump_config() override;
+  float get_setup_priority() const override { return setup_priority::AFTER_WIFI; }
+
+ protected:
+  void add_sample_(const TelemetrySnapshot &snapshot);
+  void send_();
+  size_t sample_size_() const;
+
+  EmersonR48Component *parent_;
+  std::string address_;
+  uint16_t port_{0};
+  uint16_t slot_mask_{0};
+  uint8_t samples_per_packet_{10};
+  uint32_t flush_timeout_{30000};
+
+  std::unique_ptr<socket::Socket> socket_;
+  struct sockaddr_storage destination_{};
+  socklen_t destination_len_{0};
+
+  uint8_t datagram_[UDP_MAX_DATAGRAM];
+  uint8_t sample_count_{0};
+  uint32_t first_sample_ms_{0};  // millis() of the oldest sample in the batch
+  uint32_t sequence_{0};
+  uint32_t send_errors_{0};
+};
+
+}  // namespace emerson_r48_udp
+}  // namespace esphome
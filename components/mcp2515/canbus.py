@@ -1,25 +1,47 @@
 import esphome.codegen as cg
 import esphome.config_validation as cv
-from esphome.components import spi, canbus
-from esphome.const import CONF_ID, CONF_MODE
-from esphome.components.canbus import CanbusComponent
+import esphome.final_validate as fv
+from esphome import pins
+from esphome.components import spi, canbus, sensor
+from esphome.const import (
+    CONF_ID,
+    CONF_INTERRUPT_PIN,
+    CONF_MODE,
+    CONF_PRIORITY,
+    CONF_SPI_ID,
+    CONF_TIMEOUT,
+    ENTITY_CATEGORY_DIAGNOSTIC,
+    ICON_COUNTER,
+    ICON_TIMER,
+    STATE_CLASS_MEASUREMENT,
+    UNIT_MICROSECOND,
+)
+from esphome.components.canbus import CAN_SPEEDS, CONF_BIT_RATE, CanbusComponent
+from esphome.components.canbus_ext import FRAME_SOURCE_SCHEMA, register_frame_source
 
 CODEOWNERS = ["@mvturnho", "@danielschramm"]
 DEPENDENCIES = ["spi"]
+AUTO_LOAD = ["canbus_ext", "sensor"]
 
 CONF_CLOCK = "clock"
+CONF_TASK = "task"
+CONF_CORE = "core"
+CONF_SAMPLE_POINT = "sample_point"
+CONF_AUTODETECT = "bit_rate_autodetect"
+CONF_CANDIDATES = "candidates"
+CONF_LISTEN_TIME = "listen_time"
+CONF_SELF_TEST = "self_test"
+CONF_FRAMES = "frames"
+CONF_SPI_THROUGHPUT = "spi_throughput"
+CONF_LOOPBACK_LATENCY = "loopback_latency"
+CONF_LOOPBACK_ERRORS = "loopback_errors"
 
 mcp2515_ns = cg.esphome_ns.namespace("mcp2515")
 mcp2515 = mcp2515_ns.class_("MCP2515", CanbusComponent, spi.SPIDevice)
-CanClock = mcp2515_ns.enum("CAN_CLOCK")
 McpMode = mcp2515_ns.enum("CANCTRL_REQOP_MODE")
 
-CAN_CLOCK = {
-    "8MHZ": CanClock.MCP_8MHZ,
-    "12MHZ": CanClock.MCP_12MHZ,
-    "16MHZ": CanClock.MCP_16MHZ,
-    "20MHZ": CanClock.MCP_20MHZ,
-}
+# tried in this order after the configured bit_rate
+AUTODETECT_CANDIDATES = ["125KBPS", "250KBPS", "500KBPS", "1000KBPS", "100KBPS", "50KBPS"]
 
 MCP_MODE = {
     "NORMAL": McpMode.CANCTRL_REQOP_NORMAL,
@@ -27,24 +49,158 @@ MCP_MODE = {
     "LISTENONLY": McpMode.CANCTRL_REQOP_LISTENONLY,
 }
 
-CONFIG_SCHEMA = canbus.CANBUS_SCHEMA.extend(
-    {
-        cv.GenerateID(): cv.declare_id(mcp2515),
-        cv.Optional(CONF_CLOCK, default="8MHZ"): cv.enum(CAN_CLOCK, upper=True),
-        cv.Optional(CONF_MODE, default="NORMAL"): cv.enum(MCP_MODE, upper=True),
-    }
-).extend(spi.spi_device_schema(True))
+
+
+def validate_interrupt_pin(config):
+    if CONF_INTERRUPT_PIN in config and CONF_TASK not in config:
+        raise cv.Invalid(f"{CONF_INTERRUPT_PIN} is only used by the CAN {CONF_TASK}")
+    return config
+
+
+def _find_spi_devices(node, found):
+    if isinstance(node, dict):
+        if CONF_SPI_ID in node:
+            found.append(node)
+        for value in node.values():
+            _find_spi_devices(value, found)
+    elif isinstance(node, list):
+        for value in node:
+            _find_spi_devices(value, found)
+
+
+def validate_dedicated_spi_bus(config):
+    # the CAN task's mutex only orders the transactions to this chip, not those of other devices on the bus
+    if CONF_TASK not in config:
+        return config
+    found = []
+    _find_spi_devices(fv.full_config.get(), found)
+    for device in found:
+        if device is config or device.get(CONF_ID) == config[CONF_ID]:
+            continue
+        if device[CONF_SPI_ID] == config[CONF_SPI_ID]:
+            raise cv.Invalid(
+                f"The mcp2515 {CONF_TASK} needs a dedicated SPI bus, "
+                f"'{device.get(CONF_ID)}' also uses spi_id '{config[CONF_SPI_ID]}'"
+            )
+    return config
+
+
+FINAL_VALIDATE_SCHEMA = validate_dedicated_spi_bus
+
+
+CONFIG_SCHEMA = cv.All(
+    canbus.CANBUS_SCHEMA.extend(
+        {
+            cv.GenerateID(): cv.declare_id(mcp2515),
+            # any crystal the chip supports, the bit timing is computed at setup
+            cv.Optional(CONF_CLOCK, default="8MHZ"): cv.All(
+                cv.frequency, cv.Range(min=1e6, max=40e6)
+            ),
+            cv.Optional(CONF_SAMPLE_POINT, default="87.5%"): cv.All(
+                cv.percentage, cv.Range(min=0.5, max=0.9)
+            ),
+            cv.Optional(CONF_MODE, default="NORMAL"): cv.enum(MCP_MODE, upper=True),
+            # pick the bus bit rate in listen-only mode at boot, bit_rate is the fallback
+            cv.Optional(CONF_AUTODETECT): cv.Schema(
+                {
+                    cv.Optional(CONF_CANDIDATES): cv.ensure_list(
+                        cv.enum(CAN_SPEEDS, upper=True)
+                    ),
+                    cv.Optional(
+                        CONF_LISTEN_TIME, default="250ms"
+                    ): cv.positive_time_period_milliseconds,
+                    cv.Optional(
+                        CONF_TIMEOUT, default="10s"
+                    ): cv.positive_time_period_milliseconds,
+                }
+            ),
+            # loopback round trip and SPI read-back at boot, before the configured mode starts
+            cv.Optional(CONF_SELF_TEST): cv.Schema(
+                {
+                    cv.Optional(CONF_FRAMES, default=32): cv.int_range(min=1, max=255),
+                    cv.Optional(CONF_SPI_THROUGHPUT): sensor.sensor_schema(
+                        unit_of_measurement="kB/s",
+                        icon="mdi:speedometer",
+                        accuracy_decimals=1,
+                        state_class=STATE_CLASS_MEASUREMENT,
+                        entity_category=ENTITY_CATEGORY_DIAGNOSTIC,
+                    ),
+                    cv.Optional(CONF_LOOPBACK_LATENCY): sensor.sensor_schema(
+                        unit_of_measurement=UNIT_MICROSECOND,
+                        icon=ICON_TIMER,
+                        accuracy_decimals=0,
+                        state_class=STATE_CLASS_MEASUREMENT,
+                        entity_category=ENTITY_CATEGORY_DIAGNOSTIC,
+                    ),
+                    cv.Optional(CONF_LOOPBACK_ERRORS): sensor.sensor_schema(
+                        icon=ICON_COUNTER,
+                        accuracy_decimals=0,
+                        entity_category=ENTITY_CATEGORY_DIAGNOSTIC,
+                    ),
+                }
+            ),
+            # service the chip from a dedicated FreeRTOS task instead of the main loop
+            cv.Optional(CONF_TASK): cv.All(
+                cv.Schema(
+                    {
+                        cv.Optional(CONF_CORE, default=1): cv.int_range(min=0, max=1),
+                        cv.Optional(CONF_PRIORITY, default=5): cv.int_range(
+                            min=1, max=24
+                        ),
+                    }
+                ),
+                cv.only_on_esp32,
+            ),
+            cv.Optional(CONF_INTERRUPT_PIN): pins.internal_gpio_input_pin_schema,
+        }
+    )
+    .extend(FRAME_SOURCE_SCHEMA)
+    .extend(spi.spi_device_schema(True)),
+    validate_interrupt_pin,
+)
 
 
 async def to_code(config):
     rhs = mcp2515.new()
     var = cg.Pvariable(config[CONF_ID], rhs)
     await canbus.register_canbus(var, config)
-    if CONF_CLOCK in config:
-        canclock = CAN_CLOCK[config[CONF_CLOCK]]
-        cg.add(var.set_mcp_clock(canclock))
+    await register_frame_source(var, config)
+    cg.add(var.set_mcp_clock_hz(int(config[CONF_CLOCK])))
+    cg.add(var.set_sample_point(round(config[CONF_SAMPLE_POINT] * 1000)))
     if CONF_MODE in config:
         mode = MCP_MODE[config[CONF_MODE]]
         cg.add(var.set_mcp_mode(mode))
 
     await spi.register_spi_device(var, config)
+
+    if CONF_SELF_TEST in config:
+        cg.add_define("USE_MCP2515_SELF_TEST")
+        self_test = config[CONF_SELF_TEST]
+        cg.add(var.set_self_test_frames(self_test[CONF_FRAMES]))
+        for key in (CONF_SPI_THROUGHPUT, CONF_LOOPBACK_LATENCY, CONF_LOOPBACK_ERRORS):
+            if key in self_test:
+                sens = await sensor.new_sensor(self_test[key])
+                cg.add(getattr(var, f"set_{key}_sensor")(sens))
+
+    if CONF_AUTODETECT in config:
+        cg.add_define("USE_MCP2515_AUTODETECT")
+        autodetect = config[CONF_AUTODETECT]
+        candidates = [config[CONF_BIT_RATE]]
+        for speed in autodetect.get(CONF_CANDIDATES, AUTODETECT_CANDIDATES):
+            if speed not in candidates:
+                candidates.append(speed)
+        for speed in candidates:
+            cg.add(var.add_autodetect_candidate(CAN_SPEEDS[speed]))
+        cg.add(
+            var.set_autodetect_times(
+                autodetect[CONF_LISTEN_TIME], autodetect[CONF_TIMEOUT]
+            )
+        )
+
+    if CONF_TASK in config:
+        cg.add_define("USE_MCP2515_TASK")
+        task = config[CONF_TASK]
+        cg.add(var.set_task(task[CONF_CORE], task[CONF_PRIORITY]))
+        if CONF_INTERRUPT_PIN in config:
+            pin = await cg.gpio_pin_expression(config[CONF_INTERRUPT_PIN])
+            cg.add(var.set_interrupt_pin(pin))
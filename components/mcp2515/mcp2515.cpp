@@ -1,6 +1,8 @@
 #include "mcp2515.h"
 #include "esphome/core/log.h"
 
+#include <cstring>
+
 namespace esphome {
 namespace mcp2515 {
 
@@ -10,23 +12,89 @@ const struct MCP2515::TxBnRegs MCP2515::TXB[N_TXBUFFERS] = {{MCP_TXB0CTRL, MCP_T
                                                             {MCP_TXB1CTRL, MCP_TXB1SIDH, MCP_TXB1DATA},
                                                             {MCP_TXB2CTRL, MCP_TXB2SIDH, MCP_TXB2DATA}};
 
+// Buffer instructions address SIDH directly and save the register address byte; READ RX BUFFER also clears
+// RXnIF when CS goes high, RTS replaces a read-modify-write of TXBnCTRL.
+static const uint8_t LOAD_TX[N_TXBUFFERS] = {INSTRUCTION_LOAD_TX0, INSTRUCTION_LOAD_TX1, INSTRUCTION_LOAD_TX2};
+static const uint8_t RTS_TX[N_TXBUFFERS] = {INSTRUCTION_RTS_TX0, INSTRUCTION_RTS_TX1, INSTRUCTION_RTS_TX2};
+static const uint8_t TXREQ_STATUS[N_TXBUFFERS] = {STAT_TX0REQ, STAT_TX1REQ, STAT_TX2REQ};
+static const uint8_t READ_RX[N_RXBUFFERS] = {INSTRUCTION_READ_RX0, INSTRUCTION_READ_RX1};
+
 const struct MCP2515::RxBnRegs MCP2515::RXB[N_RXBUFFERS] = {{MCP_RXB0CTRL, MCP_RXB0SIDH, MCP_RXB0DATA, CANINTF_RX0IF},
                                                             {MCP_RXB1CTRL, MCP_RXB1SIDH, MCP_RXB1DATA, CANINTF_RX1IF}};
 
 bool MCP2515::setup_internal() {
+#ifdef USE_MCP2515_TASK
+  this->spi_mutex_ = xSemaphoreCreateRecursiveMutex();
+#endif
   this->spi_setup();
 
   if (this->reset_() != canbus::ERROR_OK)
     return false;
-  if (this->set_bitrate_(this->bit_rate_, this->mcp_clock_) != canbus::ERROR_OK)
+#ifdef USE_MCP2515_SELF_TEST
+  if (this->set_bitrate_(this->get_bit_rate_bps()) == canbus::ERROR_OK)
+    this->self_test_();
+#endif
+#ifdef USE_MCP2515_AUTODETECT
+  if (!this->autodetect_candidates_.empty()) {
+    this->configured_bit_rate_ = this->bit_rate_;
+    this->detecting_ = true;
+    this->autodetect_start_ = millis();
+    this->autodetect_try_(0);
+    return true;
+  }
+#endif
+  if (this->set_bitrate_(this->get_bit_rate_bps()) != canbus::ERROR_OK)
     return false;
+  return this->start_();
+}
+
+// Leaves configuration mode with the bit timing already written
+bool MCP2515::start_() {
   if (this->set_mode_(this->mcp_mode_) != canbus::ERROR_OK)
     return false;
   uint8_t err_flags = this->get_error_flags_();
   ESP_LOGD(TAG, "mcp2515 setup done, error_flags = %02X", err_flags);
+
+#ifdef USE_MCP2515_TASK
+  if (xTaskCreatePinnedToCore(MCP2515::task_entry_, "mcp2515", 3072, this, this->task_priority_, &this->task_handle_,
+                              this->task_core_) != pdPASS) {
+    ESP_LOGE(TAG, "Could not start the CAN task");
+    this->task_handle_ = nullptr;
+    return false;
+  }
+  if (this->interrupt_pin_ != nullptr) {
+    this->interrupt_pin_->setup();
+    this->interrupt_pin_->attach_interrupt(MCP2515::gpio_intr_, this, gpio::INTERRUPT_FALLING_EDGE);
+  }
+#endif
   return true;
 }
 
+void MCP2515::dump_config() {
+  canbus::Canbus::dump_config();
+  ESP_LOGCONFIG(TAG, "  Clock: %u Hz", (unsigned) this->mcp_clock_hz_);
+  if (this->timing_.ok) {
+    ESP_LOGCONFIG(TAG, "  Bit timing: BRP %u, 1+%u+%u+%u TQ, SJW %u, sample point %.1f%%", this->timing_.brp,
+                  this->timing_.prop_seg, this->timing_.phase_seg1, this->timing_.phase_seg2, this->timing_.sjw,
+                  this->timing_.sample_point / 10.0f);
+  }
+#ifdef USE_MCP2515_SELF_TEST
+  ESP_LOGCONFIG(TAG, "  Self-test: SPI %.1f kB/s, %.0f us per loopback frame, %u errors", this->spi_throughput_,
+                this->loopback_latency_, (unsigned) this->self_test_errors_);
+#endif
+#ifdef USE_MCP2515_AUTODETECT
+  if (!this->autodetect_candidates_.empty()) {
+    ESP_LOGCONFIG(TAG, "  Bit rate autodetect: %u candidates, %u ms each, %u ms timeout",
+                  (unsigned) this->autodetect_candidates_.size(), (unsigned) this->autodetect_listen_ms_,
+                  (unsigned) this->autodetect_timeout_ms_);
+  }
+#endif
+#ifdef USE_MCP2515_TASK
+  ESP_LOGCONFIG(TAG, "  CAN task: core %u, priority %u", this->task_core_, this->task_priority_);
+  LOG_PIN("  Interrupt Pin: ", this->interrupt_pin_);
+#endif
+}
+
 canbus::Error MCP2515::reset_() {
   this->enable();
   this->transfer_byte(INSTRUCTION_RESET);
@@ -78,11 +146,8 @@ void MCP2515::read_registers_(const REGISTER reg, uint8_t values[], const uint8_
   this->enable();
   this->transfer_byte(INSTRUCTION_READ);
   this->transfer_byte(reg);
-  // this->transfer_array(values, n);
   // mcp2515 has auto - increment of address - pointer
-  for (uint8_t i = 0; i < n; i++) {
-    values[i] = this->transfer_byte(0x00);
-  }
+  this->read_array(values, n);
   this->disable();
 }
 
@@ -98,10 +163,7 @@ void MCP2515::set_registers_(const REGISTER reg, uint8_t values[], const uint8_t
   this->enable();
   this->transfer_byte(INSTRUCTION_WRITE);
   this->transfer_byte(reg);
-  // this->transfer_array(values, n);
-  for (uint8_t i = 0; i < n; i++) {
-    this->transfer_byte(values[i]);
-  }
+  this->write_array(values, n);
   this->disable();
 }
 
@@ -239,17 +301,24 @@ canbus::Error MCP2515::set_filter_(const RXF num, const bool extended, const uin
   return canbus::ERROR_OK;
 }
 
+// Two transactions: LOAD TX BUFFER with id, DLC and data, then RTS
 canbus::Error MCP2515::send_message_(TXBn txbn, struct canbus::CanFrame *frame) {
-  const struct TxBnRegs *txbuf = &TXB[txbn];
-
-  uint8_t data[13];
+  uint8_t buffer[1 + 13];
+  uint8_t *data = &buffer[1];
 
+  buffer[0] = LOAD_TX[txbn];
   prepare_id_(data, frame->use_extended_id, frame->can_id);
   data[MCP_DLC] =
       frame->remote_transmission_request ? (frame->can_data_length_code | RTR_MASK) : frame->can_data_length_code;
   memcpy(&data[MCP_DATA], frame->data, frame->can_data_length_code);
-  set_registers_(txbuf->SIDH, data, 5 + frame->can_data_length_code);
-  modify_register_(txbuf->CTRL, TXB_TXREQ, TXB_TXREQ);
+
+  this->enable();
+  this->write_array(buffer, 1 + 5 + frame->can_data_length_code);
+  this->disable();
+
+  this->enable();
+  this->transfer_byte(RTS_TX[txbn]);
+  this->disable();
 
   return canbus::ERROR_OK;
 }
@@ -258,12 +327,36 @@ canbus::Error MCP2515::send_message(struct canbus::CanFrame *frame) {
   if (frame->can_data_length_code > canbus::CAN_MAX_DATA_LENGTH) {
     return canbus::ERROR_FAILTX;
   }
+#ifdef USE_MCP2515_AUTODETECT
+  // the chip cannot transmit in listen-only mode, a frame left in a TX buffer would go out stale later
+  if (this->detecting_)
+    return canbus::ERROR_FAIL;
+#endif
+  if (this->sleeping_)
+    this->wake_();
+#ifdef USE_MCP2515_TASK
+  if (this->task_handle_ != nullptr) {
+    if (!this->tx_queue_.push(*frame))
+      return canbus::ERROR_ALLTXBUSY;
+    xTaskNotifyGive(this->task_handle_);
+    this->account_frame_(*frame);
+    return canbus::ERROR_OK;
+  }
+#endif
+  canbus::Error rc = this->send_now_(frame);
+  if (rc == canbus::ERROR_OK)
+    this->account_frame_(*frame);
+  return rc;
+}
+
+// Loads the first free TX buffer and requests transmission
+canbus::Error MCP2515::send_now_(struct canbus::CanFrame *frame) {
   TXBn tx_buffers[N_TXBUFFERS] = {TXB0, TXB1, TXB2};
 
+  // READ STATUS reports TXREQ of all three buffers at once
+  uint8_t status = this->get_status_();
   for (auto &tx_buffer : tx_buffers) {
-    const struct TxBnRegs *txbuf = &TXB[tx_buffer];
-    uint8_t ctrlval = read_register_(txbuf->CTRL);
-    if ((ctrlval & TXB_TXREQ) == 0) {
+    if ((status & TXREQ_STATUS[tx_buffer]) == 0) {
       return send_message_(tx_buffer, frame);
     }
   }
@@ -271,12 +364,18 @@ canbus::Error MCP2515::send_message(struct canbus::CanFrame *frame) {
   return canbus::ERROR_FAILTX;
 }
 
+// One READ RX BUFFER transaction: header, then as many data bytes as the DLC says. The chip clears RXnIF
+// when CS is released.
 canbus::Error MCP2515::read_message_(RXBn rxbn, struct canbus::CanFrame *frame) {
-  const struct RxBnRegs *rxb = &RXB[rxbn];
-
   uint8_t tbufdata[5];
 
-  read_registers_(rxb->SIDH, tbufdata, 5);
+  this->enable();
+  this->transfer_byte(READ_RX[rxbn]);
+  this->read_array(tbufdata, 5);
+  uint8_t dlc = (tbufdata[MCP_DLC] & DLC_MASK);
+  if (dlc <= canbus::CAN_MAX_DATA_LENGTH)
+    this->read_array(frame->data, dlc);
+  this->disable();
 
   uint32_t id = (tbufdata[MCP_SIDH] << 3) + (tbufdata[MCP_SIDL] >> 5);
   bool use_extended_id = false;
@@ -290,13 +389,12 @@ canbus::Error MCP2515::read_message_(RXBn rxbn, struct canbus::CanFrame *frame)
     use_extended_id = true;
   }
 
-  uint8_t dlc = (tbufdata[MCP_DLC] & DLC_MASK);
   if (dlc > canbus::CAN_MAX_DATA_LENGTH) {
     return canbus::ERROR_FAIL;
   }
 
-  uint8_t ctrl = read_register_(rxb->CTRL);
-  if (ctrl & RXB_CTRL_RTR) {
+  // same information as RXBnCTRL.RXRTR, without reading it: RTR bit in DLC for extended, SRR for standard ids
+  if (use_extended_id ? (tbufdata[MCP_DLC] & RTR_MASK) : (tbufdata[MCP_SIDL] & SIDL_SRR_MASK)) {
     // id |= canbus::CAN_RTR_FLAG;
     remote_transmission_request = true;
   }
@@ -306,26 +404,106 @@ canbus::Error MCP2515::read_message_(RXBn rxbn, struct canbus::CanFrame *frame)
   frame->use_extended_id = use_extended_id;
   frame->remote_transmission_request = remote_transmission_request;
 
-  read_registers_(rxb->DATA, frame->data, dlc);
-
-  modify_register_(MCP_CANINTF, rxb->CANINTF_RXnIF, 0);
-
   return canbus::ERROR_OK;
 }
 
+// Only hands out the batch loop() drained; the chip is read in read_messages() (or the CAN task) alone, so
+// every frame passes the listeners, the bus load accounting and gets its timestamp
 canbus::Error MCP2515::read_message(struct canbus::CanFrame *frame) {
-  canbus::Error rc;
-  uint8_t stat = get_status_();
+  if (this->rx_pending_pos_ >= this->rx_pending_count_)
+    return canbus::ERROR_NOMSG;
+  *frame = this->rx_pending_[this->rx_pending_pos_++];
+  return canbus::ERROR_OK;
+}
 
-  if (stat & STAT_RX0IF) {
-    rc = read_message_(RXB0, frame);
-  } else if (stat & STAT_RX1IF) {
-    rc = read_message_(RXB1, frame);
-  } else {
-    rc = canbus::ERROR_NOMSG;
+// Drains every full RX buffer reported by a single RX STATUS instruction.
+// With rollover enabled RXB0 always holds the older frame, so the batch is in bus order. The reception time
+// is only known to the polling granularity, both frames get the time of the status read.
+size_t MCP2515::read_messages(struct canbus::CanFrame *frames, size_t max_frames, uint32_t *timestamps_us) {
+  this->enable();
+  this->transfer_byte(INSTRUCTION_RX_STATUS);
+  uint8_t rx_status = this->transfer_byte(0x00);
+  this->disable();
+  uint32_t now = micros();
+
+  size_t count = 0;
+  if ((rx_status & RXSTATUS_RXB0) && count < max_frames && read_message_(RXB0, &frames[count]) == canbus::ERROR_OK)
+    count++;
+  if ((rx_status & RXSTATUS_RXB1) && count < max_frames && read_message_(RXB1, &frames[count]) == canbus::ERROR_OK)
+    count++;
+  if (timestamps_us != nullptr) {
+    for (size_t i = 0; i < count; i++)
+      timestamps_us[i] = now;
   }
+  return count;
+}
 
-  return rc;
+void MCP2515::loop() {
+#ifdef USE_MCP2515_AUTODETECT
+  if (this->detecting_) {
+    this->autodetect_loop_();
+    return;
+  }
+#endif
+  if (this->sleeping_) {
+    // the chip comes back by itself in listen-only mode, the frame that woke it is lost
+    if ((this->get_int_() & CANINTF_WAKIF) == 0)
+      return;
+    ESP_LOGD(TAG, "Woken by bus activity");
+    this->wake_();
+    this->notify_wake_();
+  }
+  this->update_bus_load_(millis());
+#ifdef USE_MCP2515_TASK
+  if (this->task_handle_ != nullptr) {
+    this->rx_pending_count_ = this->take_task_frames_();
+  } else
+#endif
+    this->rx_pending_count_ = this->read_messages(this->rx_pending_, N_RXBUFFERS, this->rx_timestamps_);
+  this->rx_pending_pos_ = 0;
+  if (this->rx_pending_count_ == 0)
+    return;
+
+  for (uint8_t i = 0; i < this->rx_pending_count_; i++)
+    this->account_frame_(this->rx_pending_[i]);
+
+  this->dispatch_frames_(this->rx_pending_, this->rx_timestamps_, this->rx_pending_count_);
+
+  // Canbus::loop() handles one frame per call and fetches it through read_message()
+  while (this->rx_pending_pos_ < this->rx_pending_count_)
+    canbus::Canbus::loop();
+}
+
+bool MCP2515::request_sleep() {
+  if (this->sleeping_)
+    return true;
+#ifdef USE_MCP2515_AUTODETECT
+  if (this->detecting_)
+    return false;
+#endif
+  // WAKIF is raised on the first dominant edge on RX once WAKIE is set
+  this->modify_register_(MCP_CANINTF, CANINTF_WAKIF, 0);
+  this->modify_register_(MCP_CANINTE, CANINTF_WAKIF, CANINTF_WAKIF);
+  if (this->set_mode_(CANCTRL_REQOP_SLEEP) != canbus::ERROR_OK) {
+    this->modify_register_(MCP_CANINTE, CANINTF_WAKIF, 0);
+    return false;
+  }
+  ESP_LOGD(TAG, "Sleeping until bus activity");
+  this->sleeping_ = true;
+  return true;
+}
+
+void MCP2515::request_wake() {
+  if (this->sleeping_)
+    this->wake_();
+}
+
+void MCP2515::wake_() {
+  this->modify_register_(MCP_CANINTE, CANINTF_WAKIF, 0);
+  this->modify_register_(MCP_CANINTF, CANINTF_WAKIF, 0);
+  if (this->set_mode_(this->mcp_mode_) != canbus::ERROR_OK)
+    this->status_set_warning();
+  this->sleeping_ = false;
 }
 
 bool MCP2515::check_receive_() {
@@ -371,321 +549,327 @@ void MCP2515::clear_errif_() {
   modify_register_(MCP_CANINTF, CANINTF_ERRIF, 0);
 }
 
-canbus::Error MCP2515::set_bitrate_(canbus::CanSpeed can_speed) { return this->set_bitrate_(can_speed, MCP_16MHZ); }
-
-canbus::Error MCP2515::set_bitrate_(canbus::CanSpeed can_speed, CanClock can_clock) {
-  canbus::Error error = set_mode_(CANCTRL_REQOP_CONFIG);
-  if (error != canbus::ERROR_OK) {
-    return error;
+// CNF values of the switch tables this solver replaced. Every one of them must still be reachable: the solver
+// has to hit the same bit rate at least as closely, for the same crystal.
+struct ReferenceTiming {
+  uint8_t clock_mhz;
+  uint32_t bit_rate;
+  uint8_t cfg1, cfg2, cfg3;
+};
+static constexpr ReferenceTiming REFERENCE_TIMINGS[] = {
+    {8, 5000, 0x1F, 0xBF, 0x87},
+    {8, 10000, 0x0F, 0xBF, 0x87},
+    {8, 20000, 0x07, 0xBF, 0x87},
+    {8, 31250, 0x07, 0xA4, 0x84},
+    {8, 33333, 0x47, 0xE2, 0x85},
+    {8, 40000, 0x03, 0xBF, 0x87},
+    {8, 50000, 0x03, 0xB4, 0x86},
+    {8, 80000, 0x01, 0xBF, 0x87},
+    {8, 100000, 0x01, 0xB4, 0x86},
+    {8, 125000, 0x01, 0xB1, 0x85},
+    {8, 200000, 0x00, 0xB4, 0x86},
+    {8, 250000, 0x00, 0xB1, 0x85},
+    {8, 500000, 0x00, 0x90, 0x82},
+    {8, 1000000, 0x00, 0x80, 0x80},
+    {12, 5000, 0x3B, 0xB6, 0x84},
+    {12, 10000, 0x31, 0x9B, 0x82},
+    {12, 20000, 0x0E, 0xB6, 0x84},
+    {12, 33333, 0x08, 0xB6, 0x84},
+    {12, 40000, 0x09, 0xA4, 0x83},
+    {12, 50000, 0x07, 0xA4, 0x83},
+    {12, 80000, 0x04, 0xA4, 0x83},
+    {12, 100000, 0x03, 0xA4, 0x83},
+    {12, 125000, 0x03, 0x9B, 0x82},
+    {12, 200000, 0x01, 0xA4, 0x83},
+    {12, 250000, 0x01, 0x9B, 0x82},
+    {12, 500000, 0x00, 0x9B, 0x82},
+    {12, 1000000, 0x00, 0x88, 0x81},
+    {16, 5000, 0x3F, 0xFF, 0x87},
+    {16, 10000, 0x1F, 0xFF, 0x87},
+    {16, 20000, 0x0F, 0xFF, 0x87},
+    {16, 33333, 0x4E, 0xF1, 0x85},
+    {16, 40000, 0x07, 0xFF, 0x87},
+    {16, 50000, 0x07, 0xFA, 0x87},
+    {16, 80000, 0x03, 0xFF, 0x87},
+    {16, 83333, 0x03, 0xBE, 0x07},
+    {16, 100000, 0x03, 0xFA, 0x87},
+    {16, 125000, 0x03, 0xF0, 0x86},
+    {16, 200000, 0x01, 0xFA, 0x87},
+    {16, 250000, 0x41, 0xF1, 0x85},
+    {16, 500000, 0x00, 0xF0, 0x86},
+    {16, 1000000, 0x00, 0xD0, 0x82},
+    {20, 33333, 0x0B, 0xFF, 0x87},
+    {20, 40000, 0x09, 0xFF, 0x87},
+    {20, 50000, 0x09, 0xFA, 0x87},
+    {20, 80000, 0x04, 0xFF, 0x87},
+    {20, 83333, 0x04, 0xFE, 0x87},
+    {20, 100000, 0x04, 0xFA, 0x87},
+    {20, 125000, 0x03, 0xFA, 0x87},
+    {20, 200000, 0x01, 0xFF, 0x87},
+    {20, 250000, 0x41, 0xFB, 0x86},
+    {20, 500000, 0x00, 0xFA, 0x87},
+    {20, 1000000, 0x00, 0xD9, 0x82},
+};
+
+static constexpr bool matches_reference_timings() {
+  for (const auto &ref : REFERENCE_TIMINGS) {
+    const uint32_t clock_hz = ref.clock_mhz * 1000000u;
+    const BitTiming timing = solve_bit_timing(clock_hz, ref.bit_rate);
+    if (!timing.ok)
+      return false;
+    const uint64_t brp = (ref.cfg1 & 0x3F) + 1;
+    const uint64_t tq = 1 + (ref.cfg2 & 0x07) + 1 + ((ref.cfg2 >> 3) & 0x07) + 1 + (ref.cfg3 & 0x07) + 1;
+    const uint64_t divider = 2 * brp * tq;
+    const uint64_t target = uint64_t(ref.bit_rate) * divider;
+    const uint64_t err = clock_hz > target ? clock_hz - target : target - clock_hz;
+    if (uint64_t(timing.error_ppm) * target > err * 1000000ull)
+      return false;
+    if (timing.phase_seg2 > 1 && timing.sjw >= timing.phase_seg2)
+      return false;
   }
+  return true;
+}
+static_assert(matches_reference_timings(), "bit timing solver regressed against the old CNF tables");
 
-  uint8_t set, cfg1, cfg2, cfg3;
-  set = 1;
-  switch (can_clock) {
-    case (MCP_8MHZ):
-      switch (can_speed) {
-        case (canbus::CAN_5KBPS):  //   5KBPS
-          cfg1 = MCP_8MHZ_5KBPS_CFG1;
-          cfg2 = MCP_8MHZ_5KBPS_CFG2;
-          cfg3 = MCP_8MHZ_5KBPS_CFG3;
-          break;
-        case (canbus::CAN_10KBPS):  //  10KBPS
-          cfg1 = MCP_8MHZ_10KBPS_CFG1;
-          cfg2 = MCP_8MHZ_10KBPS_CFG2;
-          cfg3 = MCP_8MHZ_10KBPS_CFG3;
-          break;
-        case (canbus::CAN_20KBPS):  //  20KBPS
-          cfg1 = MCP_8MHZ_20KBPS_CFG1;
-          cfg2 = MCP_8MHZ_20KBPS_CFG2;
-          cfg3 = MCP_8MHZ_20KBPS_CFG3;
-          break;
-        case (canbus::CAN_31K25BPS):  //  31.25KBPS
-          cfg1 = MCP_8MHZ_31K25BPS_CFG1;
-          cfg2 = MCP_8MHZ_31K25BPS_CFG2;
-          cfg3 = MCP_8MHZ_31K25BPS_CFG3;
-          break;
-        case (canbus::CAN_33KBPS):  //  33.333KBPS
-          cfg1 = MCP_8MHZ_33K3BPS_CFG1;
-          cfg2 = MCP_8MHZ_33K3BPS_CFG2;
-          cfg3 = MCP_8MHZ_33K3BPS_CFG3;
-          break;
-        case (canbus::CAN_40KBPS):  //  40Kbps
-          cfg1 = MCP_8MHZ_40KBPS_CFG1;
-          cfg2 = MCP_8MHZ_40KBPS_CFG2;
-          cfg3 = MCP_8MHZ_40KBPS_CFG3;
-          break;
-        case (canbus::CAN_50KBPS):  //  50Kbps
-          cfg1 = MCP_8MHZ_50KBPS_CFG1;
-          cfg2 = MCP_8MHZ_50KBPS_CFG2;
-          cfg3 = MCP_8MHZ_50KBPS_CFG3;
-          break;
-        case (canbus::CAN_80KBPS):  //  80Kbps
-          cfg1 = MCP_8MHZ_80KBPS_CFG1;
-          cfg2 = MCP_8MHZ_80KBPS_CFG2;
-          cfg3 = MCP_8MHZ_80KBPS_CFG3;
-          break;
-        case (canbus::CAN_100KBPS):  // 100Kbps
-          cfg1 = MCP_8MHZ_100KBPS_CFG1;
-          cfg2 = MCP_8MHZ_100KBPS_CFG2;
-          cfg3 = MCP_8MHZ_100KBPS_CFG3;
-          break;
-        case (canbus::CAN_125KBPS):  // 125Kbps
-          cfg1 = MCP_8MHZ_125KBPS_CFG1;
-          cfg2 = MCP_8MHZ_125KBPS_CFG2;
-          cfg3 = MCP_8MHZ_125KBPS_CFG3;
-          break;
-        case (canbus::CAN_200KBPS):  // 200Kbps
-          cfg1 = MCP_8MHZ_200KBPS_CFG1;
-          cfg2 = MCP_8MHZ_200KBPS_CFG2;
-          cfg3 = MCP_8MHZ_200KBPS_CFG3;
-          break;
-        case (canbus::CAN_250KBPS):  // 250Kbps
-          cfg1 = MCP_8MHZ_250KBPS_CFG1;
-          cfg2 = MCP_8MHZ_250KBPS_CFG2;
-          cfg3 = MCP_8MHZ_250KBPS_CFG3;
-          break;
-        case (canbus::CAN_500KBPS):  // 500Kbps
-          cfg1 = MCP_8MHZ_500KBPS_CFG1;
-          cfg2 = MCP_8MHZ_500KBPS_CFG2;
-          cfg3 = MCP_8MHZ_500KBPS_CFG3;
-          break;
-        case (canbus::CAN_1000KBPS):  //   1Mbps
-          cfg1 = MCP_8MHZ_1000KBPS_CFG1;
-          cfg2 = MCP_8MHZ_1000KBPS_CFG2;
-          cfg3 = MCP_8MHZ_1000KBPS_CFG3;
-          break;
-        default:
-          set = 0;
-          break;
-      }
+void MCP2515::set_mcp_clock(CanClock clock) {
+  switch (clock) {
+    case MCP_20MHZ:
+      this->mcp_clock_hz_ = 20000000;
       break;
-
-    case (MCP_12MHZ):
-      switch (can_speed) {
-        case (canbus::CAN_5KBPS):  //   5Kbps
-          cfg1 = MCP_12MHZ_5KBPS_CFG1;
-          cfg2 = MCP_12MHZ_5KBPS_CFG2;
-          cfg3 = MCP_12MHZ_5KBPS_CFG3;
-          break;
-        case (canbus::CAN_10KBPS):  //  10Kbps
-          cfg1 = MCP_12MHZ_10KBPS_CFG1;
-          cfg2 = MCP_12MHZ_10KBPS_CFG2;
-          cfg3 = MCP_12MHZ_10KBPS_CFG3;
-          break;
-        case (canbus::CAN_20KBPS):  //  20Kbps
-          cfg1 = MCP_12MHZ_20KBPS_CFG1;
-          cfg2 = MCP_12MHZ_20KBPS_CFG2;
-          cfg3 = MCP_12MHZ_20KBPS_CFG3;
-          break;
-        case (canbus::CAN_33KBPS):  //  33.333Kbps
-          cfg1 = MCP_12MHZ_33K3BPS_CFG1;
-          cfg2 = MCP_12MHZ_33K3BPS_CFG2;
-          cfg3 = MCP_12MHZ_33K3BPS_CFG3;
-          break;
-        case (canbus::CAN_40KBPS):  //  40Kbps
-          cfg1 = MCP_12MHZ_40KBPS_CFG1;
-          cfg2 = MCP_12MHZ_40KBPS_CFG2;
-          cfg3 = MCP_12MHZ_40KBPS_CFG3;
-          break;
-        case (canbus::CAN_50KBPS):  //  50Kbps
-          cfg2 = MCP_12MHZ_50KBPS_CFG2;
-          cfg3 = MCP_12MHZ_50KBPS_CFG3;
-          break;
-        case (canbus::CAN_80KBPS):  //  80Kbps
-          cfg1 = MCP_12MHZ_80KBPS_CFG1;
-          cfg2 = MCP_12MHZ_80KBPS_CFG2;
-          cfg3 = MCP_12MHZ_80KBPS_CFG3;
-          break;
-        case (canbus::CAN_100KBPS):  // 100Kbps
-          cfg1 = MCP_12MHZ_100KBPS_CFG1;
-          cfg2 = MCP_12MHZ_100KBPS_CFG2;
-          cfg3 = MCP_12MHZ_100KBPS_CFG3;
-          break;
-        case (canbus::CAN_125KBPS):  // 125Kbps
-          cfg1 = MCP_12MHZ_125KBPS_CFG1;
-          cfg2 = MCP_12MHZ_125KBPS_CFG2;
-          cfg3 = MCP_12MHZ_125KBPS_CFG3;
-          break;
-        case (canbus::CAN_200KBPS):  // 200Kbps
-          cfg1 = MCP_12MHZ_200KBPS_CFG1;
-          cfg2 = MCP_12MHZ_200KBPS_CFG2;
-          cfg3 = MCP_12MHZ_200KBPS_CFG3;
-          break;
-        case (canbus::CAN_250KBPS):  // 250Kbps
-          cfg1 = MCP_12MHZ_250KBPS_CFG1;
-          cfg2 = MCP_12MHZ_250KBPS_CFG2;
-          cfg3 = MCP_12MHZ_250KBPS_CFG3;
-          break;
-        case (canbus::CAN_500KBPS):  // 500Kbps
-          cfg1 = MCP_12MHZ_500KBPS_CFG1;
-          cfg2 = MCP_12MHZ_500KBPS_CFG2;
-          cfg3 = MCP_12MHZ_500KBPS_CFG3;
-          break;
-        case (canbus::CAN_1000KBPS):  //   1Mbps
-          cfg1 = MCP_12MHZ_1000KBPS_CFG1;
-          cfg2 = MCP_12MHZ_1000KBPS_CFG2;
-          cfg3 = MCP_12MHZ_1000KBPS_CFG3;
-          break;
-        default:
-          set = 0;
-          break;
-      }
+    case MCP_16MHZ:
+      this->mcp_clock_hz_ = 16000000;
       break;
-
-    case (MCP_16MHZ):
-      switch (can_speed) {
-        case (canbus::CAN_5KBPS):  //   5Kbps
-          cfg1 = MCP_16MHZ_5KBPS_CFG1;
-          cfg2 = MCP_16MHZ_5KBPS_CFG2;
-          cfg3 = MCP_16MHZ_5KBPS_CFG3;
-          break;
-        case (canbus::CAN_10KBPS):  //  10Kbps
-          cfg1 = MCP_16MHZ_10KBPS_CFG1;
-          cfg2 = MCP_16MHZ_10KBPS_CFG2;
-          cfg3 = MCP_16MHZ_10KBPS_CFG3;
-          break;
-        case (canbus::CAN_20KBPS):  //  20Kbps
-          cfg1 = MCP_16MHZ_20KBPS_CFG1;
-          cfg2 = MCP_16MHZ_20KBPS_CFG2;
-          cfg3 = MCP_16MHZ_20KBPS_CFG3;
-          break;
-        case (canbus::CAN_33KBPS):  //  33.333Kbps
-          cfg1 = MCP_16MHZ_33K3BPS_CFG1;
-          cfg2 = MCP_16MHZ_33K3BPS_CFG2;
-          cfg3 = MCP_16MHZ_33K3BPS_CFG3;
-          break;
-        case (canbus::CAN_40KBPS):  //  40Kbps
-          cfg1 = MCP_16MHZ_40KBPS_CFG1;
-          cfg2 = MCP_16MHZ_40KBPS_CFG2;
-          cfg3 = MCP_16MHZ_40KBPS_CFG3;
-          break;
-        case (canbus::CAN_50KBPS):  //  50Kbps
-          cfg2 = MCP_16MHZ_50KBPS_CFG2;
-          cfg3 = MCP_16MHZ_50KBPS_CFG3;
-          break;
-        case (canbus::CAN_80KBPS):  //  80Kbps
-          cfg1 = MCP_16MHZ_80KBPS_CFG1;
-          cfg2 = MCP_16MHZ_80KBPS_CFG2;
-          cfg3 = MCP_16MHZ_80KBPS_CFG3;
-          break;
-        case (canbus::CAN_83K3BPS):  //  83.333Kbps
-          cfg1 = MCP_16MHZ_83K3BPS_CFG1;
-          cfg2 = MCP_16MHZ_83K3BPS_CFG2;
-          cfg3 = MCP_16MHZ_83K3BPS_CFG3;
-          break;
-        case (canbus::CAN_100KBPS):  // 100Kbps
-          cfg1 = MCP_16MHZ_100KBPS_CFG1;
-          cfg2 = MCP_16MHZ_100KBPS_CFG2;
-          cfg3 = MCP_16MHZ_100KBPS_CFG3;
-          break;
-        case (canbus::CAN_125KBPS):  // 125Kbps
-          cfg1 = MCP_16MHZ_125KBPS_CFG1;
-          cfg2 = MCP_16MHZ_125KBPS_CFG2;
-          cfg3 = MCP_16MHZ_125KBPS_CFG3;
-          break;
-        case (canbus::CAN_200KBPS):  // 200Kbps
-          cfg1 = MCP_16MHZ_200KBPS_CFG1;
-          cfg2 = MCP_16MHZ_200KBPS_CFG2;
-          cfg3 = MCP_16MHZ_200KBPS_CFG3;
-          break;
-        case (canbus::CAN_250KBPS):  // 250Kbps
-          cfg1 = MCP_16MHZ_250KBPS_CFG1;
-          cfg2 = MCP_16MHZ_250KBPS_CFG2;
-          cfg3 = MCP_16MHZ_250KBPS_CFG3;
-          break;
-        case (canbus::CAN_500KBPS):  // 500Kbps
-          cfg1 = MCP_16MHZ_500KBPS_CFG1;
-          cfg2 = MCP_16MHZ_500KBPS_CFG2;
-          cfg3 = MCP_16MHZ_500KBPS_CFG3;
-          break;
-        case (canbus::CAN_1000KBPS):  //   1Mbps
-          cfg1 = MCP_16MHZ_1000KBPS_CFG1;
-          cfg2 = MCP_16MHZ_1000KBPS_CFG2;
-          cfg3 = MCP_16MHZ_1000KBPS_CFG3;
-          break;
-        default:
-          set = 0;
-          break;
-      }
+    case MCP_12MHZ:
+      this->mcp_clock_hz_ = 12000000;
       break;
-
-    case (MCP_20MHZ):
-      switch (can_speed) {
-        case (canbus::CAN_33KBPS):  //  33.333Kbps
-          cfg1 = MCP_20MHZ_33K3BPS_CFG1;
-          cfg2 = MCP_20MHZ_33K3BPS_CFG2;
-          cfg3 = MCP_20MHZ_33K3BPS_CFG3;
-          break;
-        case (canbus::CAN_40KBPS):  //  40Kbps
-          cfg1 = MCP_20MHZ_40KBPS_CFG1;
-          cfg2 = MCP_20MHZ_40KBPS_CFG2;
-          cfg3 = MCP_20MHZ_40KBPS_CFG3;
-          break;
-        case (canbus::CAN_50KBPS):  //  50Kbps
-          cfg1 = MCP_20MHZ_50KBPS_CFG1;
-          cfg2 = MCP_20MHZ_50KBPS_CFG2;
-          cfg3 = MCP_20MHZ_50KBPS_CFG3;
-          break;
-        case (canbus::CAN_80KBPS):  //  80Kbps
-          cfg1 = MCP_20MHZ_80KBPS_CFG1;
-          cfg2 = MCP_20MHZ_80KBPS_CFG2;
-          cfg3 = MCP_20MHZ_80KBPS_CFG3;
-          break;
-        case (canbus::CAN_83K3BPS):  //  83.333Kbps
-          cfg1 = MCP_20MHZ_83K3BPS_CFG1;
-          cfg2 = MCP_20MHZ_83K3BPS_CFG2;
-          cfg3 = MCP_20MHZ_83K3BPS_CFG3;
-          break;
-        case (canbus::CAN_100KBPS):  // 100Kbps
-          cfg1 = MCP_20MHZ_100KBPS_CFG1;
-          cfg2 = MCP_20MHZ_100KBPS_CFG2;
-          cfg3 = MCP_20MHZ_100KBPS_CFG3;
-          break;
-        case (canbus::CAN_125KBPS):  // 125Kbps
-          cfg1 = MCP_20MHZ_125KBPS_CFG1;
-          cfg2 = MCP_20MHZ_125KBPS_CFG2;
-          cfg3 = MCP_20MHZ_125KBPS_CFG3;
-          break;
-        case (canbus::CAN_200KBPS):  // 200Kbps
-          cfg1 = MCP_20MHZ_200KBPS_CFG1;
-          cfg2 = MCP_20MHZ_200KBPS_CFG2;
-          cfg3 = MCP_20MHZ_200KBPS_CFG3;
-          break;
-        case (canbus::CAN_250KBPS):  // 250Kbps
-          cfg1 = MCP_20MHZ_250KBPS_CFG1;
-          cfg2 = MCP_20MHZ_250KBPS_CFG2;
-          cfg3 = MCP_20MHZ_250KBPS_CFG3;
-          break;
-        case (canbus::CAN_500KBPS):  // 500Kbps
-          cfg1 = MCP_20MHZ_500KBPS_CFG1;
-          cfg2 = MCP_20MHZ_500KBPS_CFG2;
-          cfg3 = MCP_20MHZ_500KBPS_CFG3;
-          break;
-        case (canbus::CAN_1000KBPS):  //   1Mbps
-          cfg1 = MCP_20MHZ_1000KBPS_CFG1;
-          cfg2 = MCP_20MHZ_1000KBPS_CFG2;
-          cfg3 = MCP_20MHZ_1000KBPS_CFG3;
-          break;
-        default:
-          set = 0;
-          break;
-      }
+    case MCP_8MHZ:
+      this->mcp_clock_hz_ = 8000000;
       break;
+  }
+}
 
-    default:
-      set = 0;
-      break;
+canbus::Error MCP2515::set_bitrate_(uint32_t bit_rate) {
+  this->timing_ = solve_bit_timing(this->mcp_clock_hz_, bit_rate, this->sample_point_);
+  if (!this->timing_.ok) {
+    ESP_LOGE(TAG, "No bit timing for %u bit/s from a %u Hz clock", (unsigned) bit_rate,
+             (unsigned) this->mcp_clock_hz_);
+    return canbus::ERROR_FAIL;
+  }
+  if (this->timing_.error_ppm != 0) {
+    ESP_LOGW(TAG, "Bit rate %u bit/s is %u ppm off the requested %u bit/s", (unsigned) this->timing_.bit_rate,
+             (unsigned) this->timing_.error_ppm, (unsigned) bit_rate);
   }
 
-  if (set) {
-    set_register_(MCP_CNF1, cfg1);  // NOLINT
-    set_register_(MCP_CNF2, cfg2);  // NOLINT
-    set_register_(MCP_CNF3, cfg3);  // NOLINT
-    return canbus::ERROR_OK;
+  canbus::Error error = this->set_mode_(CANCTRL_REQOP_CONFIG);
+  if (error != canbus::ERROR_OK)
+    return error;
+  this->set_register_(MCP_CNF1, this->timing_.cfg1);
+  this->set_register_(MCP_CNF2, this->timing_.cfg2);
+  this->set_register_(MCP_CNF3, this->timing_.cfg3);
+  return canbus::ERROR_OK;
+}
+
+#ifdef USE_MCP2515_SELF_TEST
+void MCP2515::self_test_() {
+  static const uint8_t SPI_ROUNDS = 32;
+  static const uint32_t LOOPBACK_TIMEOUT_US = 10000;
+
+  // TXB0 data bytes are plain read/write registers while no transmission is pending
+  uint32_t errors = 0;
+  uint8_t pattern[canbus::CAN_MAX_DATA_LENGTH];
+  uint8_t readback[canbus::CAN_MAX_DATA_LENGTH];
+  const uint32_t spi_start = micros();
+  for (uint8_t round = 0; round < SPI_ROUNDS; round++) {
+    for (uint8_t i = 0; i < sizeof(pattern); i++)
+      pattern[i] = (round * sizeof(pattern) + i) ^ (round & 1 ? 0xAA : 0x55);
+    this->set_registers_(MCP_TXB0DATA, pattern, sizeof(pattern));
+    this->read_registers_(MCP_TXB0DATA, readback, sizeof(readback));
+    if (memcmp(pattern, readback, sizeof(pattern)) != 0)
+      errors++;
+  }
+  const uint32_t spi_us = micros() - spi_start;
+  // instruction and address byte on top of the data, both directions
+  const uint32_t spi_bytes = SPI_ROUNDS * 2 * (2 + sizeof(pattern));
+  this->spi_throughput_ = spi_us > 0 ? spi_bytes * 1000.0f / spi_us : NAN;
+
+  uint32_t latency_us = 0;
+  uint8_t received = 0;
+  if (this->set_mode_(CANCTRL_REQOP_LOOPBACK) == canbus::ERROR_OK) {
+    for (uint8_t n = 0; n < this->self_test_frames_; n++) {
+      canbus::CanFrame sent{};
+      sent.use_extended_id = n & 1;
+      sent.can_id = sent.use_extended_id ? 0x1A5A5A00 | n : 0x500 | (n & 0xFF);
+      sent.can_data_length_code = n % (canbus::CAN_MAX_DATA_LENGTH + 1);
+      for (uint8_t i = 0; i < sent.can_data_length_code; i++)
+        sent.data[i] = n * 31 + i;
+
+      const uint32_t start = micros();
+      if (this->send_now_(&sent) != canbus::ERROR_OK) {
+        errors++;
+        continue;
+      }
+      canbus::CanFrame echo;
+      size_t count = 0;
+      while (count == 0 && micros() - start < LOOPBACK_TIMEOUT_US)
+        count = this->read_messages(&echo, 1);
+      if (count == 0) {
+        errors++;
+        continue;
+      }
+      latency_us += micros() - start;
+      received++;
+      if (echo.can_id != sent.can_id || echo.use_extended_id != sent.use_extended_id ||
+          echo.can_data_length_code != sent.can_data_length_code ||
+          memcmp(echo.data, sent.data, sent.can_data_length_code) != 0)
+        errors++;
+    }
   } else {
-    ESP_LOGE(TAG, "Invalid frequency/bitrate combination: %d/%d", can_clock, can_speed);
-    return canbus::ERROR_FAIL;
+    errors++;
+  }
+  this->loopback_latency_ = received > 0 ? float(latency_us) / received : NAN;
+  this->self_test_errors_ = errors;
+  this->clear_int_();
+
+  if (errors > 0) {
+    ESP_LOGE(TAG, "Self-test: %u errors, check the SPI wiring and clock", (unsigned) errors);
+    this->status_set_warning();
+  }
+  ESP_LOGI(TAG, "Self-test: SPI %.1f kB/s, %u/%u loopback frames, %.0f us per frame", this->spi_throughput_,
+           received, this->self_test_frames_, this->loopback_latency_);
+  if (this->spi_throughput_sensor_ != nullptr)
+    this->spi_throughput_sensor_->publish_state(this->spi_throughput_);
+  if (this->loopback_latency_sensor_ != nullptr)
+    this->loopback_latency_sensor_->publish_state(this->loopback_latency_);
+  if (this->loopback_errors_sensor_ != nullptr)
+    this->loopback_errors_sensor_->publish_state(errors);
+}
+#endif
+
+#ifdef USE_MCP2515_AUTODETECT
+void MCP2515::autodetect_try_(size_t index) {
+  this->autodetect_index_ = index;
+  this->bit_rate_ = this->autodetect_candidates_[index];
+  this->candidate_start_ = millis();
+  this->candidate_frames_ = 0;
+  this->candidate_errors_ = 0;
+  if (this->set_bitrate_(this->get_bit_rate_bps()) != canbus::ERROR_OK ||
+      this->set_mode_(CANCTRL_REQOP_LISTENONLY) != canbus::ERROR_OK)
+    return;
+  this->clear_int_();
+  ESP_LOGV(TAG, "Listening at %u bit/s", (unsigned) this->get_bit_rate_bps());
+}
+
+// A couple of clean frames settle it, so does a couple of errors without a single frame; a quiet or mixed
+// window is decided when it ends. Candidates are retried in turn until the timeout.
+void MCP2515::autodetect_loop_() {
+  static const uint8_t DECISIVE = 2;
+  const uint32_t now = millis();
+  const uint8_t intf = this->get_int_();
+  // clearing RXnIF also frees the buffer for the next frame
+  this->modify_register_(MCP_CANINTF, CANINTF_RX0IF | CANINTF_RX1IF | CANINTF_MERRF | CANINTF_ERRIF, 0);
+  if ((intf & (CANINTF_RX0IF | CANINTF_RX1IF)) && this->candidate_frames_ < UINT8_MAX)
+    this->candidate_frames_++;
+  if ((intf & CANINTF_MERRF) && this->candidate_errors_ < UINT8_MAX)
+    this->candidate_errors_++;
+
+  const bool window_over = now - this->candidate_start_ >= this->autodetect_listen_ms_;
+  if ((this->candidate_frames_ >= DECISIVE || window_over) && this->candidate_frames_ > this->candidate_errors_) {
+    ESP_LOGI(TAG, "Detected bit rate %u bit/s (%u frames, %u errors)", (unsigned) this->get_bit_rate_bps(),
+             this->candidate_frames_, this->candidate_errors_);
+    this->autodetect_finish_();
+    return;
+  }
+  const bool rejected = this->candidate_frames_ == 0 && this->candidate_errors_ >= DECISIVE;
+  if (!rejected && !window_over)
+    return;
+
+  if (now - this->autodetect_start_ >= this->autodetect_timeout_ms_) {
+    this->bit_rate_ = this->configured_bit_rate_;
+    ESP_LOGW(TAG, "No bit rate detected within %u ms, using the configured %u bit/s",
+             (unsigned) this->autodetect_timeout_ms_, (unsigned) this->get_bit_rate_bps());
+    this->autodetect_finish_();
+    return;
+  }
+  // a candidate the crystal cannot produce just sits out its window in configuration mode
+  this->autodetect_try_((this->autodetect_index_ + 1) % this->autodetect_candidates_.size());
+}
+
+void MCP2515::autodetect_finish_() {
+  this->detecting_ = false;
+  if (this->set_bitrate_(this->get_bit_rate_bps()) != canbus::ERROR_OK) {
+    this->mark_failed();
+    return;
   }
+  this->clear_int_();
+  if (!this->start_())
+    this->mark_failed();
 }
+#endif
+
+#ifdef USE_MCP2515_TASK
+void MCP2515::enable() {
+  if (this->spi_mutex_ != nullptr)
+    xSemaphoreTakeRecursive(this->spi_mutex_, portMAX_DELAY);
+  spi::SPIDevice<spi::BIT_ORDER_MSB_FIRST, spi::CLOCK_POLARITY_LOW, spi::CLOCK_PHASE_LEADING,
+                 spi::DATA_RATE_8MHZ>::enable();
+}
+
+void MCP2515::disable() {
+  spi::SPIDevice<spi::BIT_ORDER_MSB_FIRST, spi::CLOCK_POLARITY_LOW, spi::CLOCK_PHASE_LEADING,
+                 spi::DATA_RATE_8MHZ>::disable();
+  if (this->spi_mutex_ != nullptr)
+    xSemaphoreGiveRecursive(this->spi_mutex_);
+}
+
+void IRAM_ATTR MCP2515::gpio_intr_(MCP2515 *arg) {
+  BaseType_t woken = pdFALSE;
+  vTaskNotifyGiveFromISR(arg->task_handle_, &woken);
+  if (woken)
+    portYIELD_FROM_ISR();
+}
+
+void MCP2515::task_entry_(void *arg) { static_cast<MCP2515 *>(arg)->task_loop_(); }
+
+// Sleeps until the INT pin fires or loop() queues a frame. Without the pin (or as a safety net for a missed
+// edge, INT is level triggered on the chip) the buffers are polled every tick.
+void MCP2515::task_loop_() {
+  const TickType_t idle_wait = this->interrupt_pin_ != nullptr ? pdMS_TO_TICKS(10) : 1;
+  canbus::CanFrame frames[N_RXBUFFERS];
+  uint32_t timestamps[N_RXBUFFERS];
+  bool busy = false;
+  while (true) {
+    if (!busy)
+      ulTaskNotifyTake(pdTRUE, idle_wait);
+
+    // a frame that finds all TX buffers busy stays at the head of the queue
+    canbus::CanFrame *tx;
+    while ((tx = this->tx_queue_.peek()) != nullptr && this->send_now_(tx) == canbus::ERROR_OK)
+      this->tx_queue_.drop();
+
+    size_t count = this->read_messages(frames, N_RXBUFFERS, timestamps);
+    for (size_t i = 0; i < count; i++) {
+      if (!this->rx_queue_.push({frames[i], timestamps[i]}))
+        this->rx_dropped_.fetch_add(1, std::memory_order_relaxed);
+    }
+    // keep going without sleeping while the bus delivers
+    busy = count > 0;
+  }
+}
+
+size_t MCP2515::take_task_frames_() {
+  size_t count = 0;
+  TimedFrame item;
+  while (count < RX_BATCH && this->rx_queue_.pop(&item)) {
+    this->rx_pending_[count] = item.frame;
+    this->rx_timestamps_[count] = item.timestamp_us;
+    count++;
+  }
+  uint32_t dropped = this->rx_dropped_.exchange(0, std::memory_order_relaxed);
+  if (dropped > 0)
+    ESP_LOGW(TAG, "RX queue full, %u frames dropped", (unsigned) dropped);
+  return count;
+}
+#endif
+
 }  // namespace mcp2515
 }  // namespace esphome
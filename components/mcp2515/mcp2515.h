@@ -1,16 +1,39 @@
 #pragma once
 
 #include "esphome/components/canbus/canbus.h"
+#include "esphome/components/canbus_ext/canbus_ext.h"
 #include "esphome/components/spi/spi.h"
 #include "esphome/core/component.h"
+#include "mcp2515_bittiming.h"
 #include "mcp2515_defs.h"
 
+#ifdef USE_MCP2515_AUTODETECT
+#include <vector>
+#endif
+#ifdef USE_MCP2515_SELF_TEST
+#include "esphome/components/sensor/sensor.h"
+#endif
+#ifdef USE_MCP2515_TASK
+#include "esphome/components/canbus_ext/spsc_queue.h"
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+#include <freertos/task.h>
+#include <atomic>
+#endif
+
 namespace esphome {
 namespace mcp2515 {
 static const uint32_t SPI_CLOCK = 10000000;  // 10MHz
 
 static const int N_TXBUFFERS = 3;
 static const int N_RXBUFFERS = 2;
+#ifdef USE_MCP2515_TASK
+// frames exchanged between the CAN task and loop(), and the most loop() hands to listeners at once
+static const size_t TASK_QUEUE_SIZE = 32;
+static const size_t RX_BATCH = 16;
+#else
+static const size_t RX_BATCH = N_RXBUFFERS;
+#endif
 enum CanClock { MCP_20MHZ, MCP_16MHZ, MCP_12MHZ, MCP_8MHZ };
 enum MASK { MASK0, MASK1 };
 enum RXF { RXF0 = 0, RXF1 = 1, RXF2 = 2, RXF3 = 3, RXF4 = 4, RXF5 = 5 };
@@ -47,18 +70,54 @@ enum EFLG : uint8_t {
   EFLG_EWARN = (1 << 0)
 };
 
-enum STAT : uint8_t { STAT_RX0IF = (1 << 0), STAT_RX1IF = (1 << 1) };
+enum STAT : uint8_t {
+  STAT_RX0IF = (1 << 0),
+  STAT_RX1IF = (1 << 1),
+  STAT_TX0REQ = (1 << 2),
+  STAT_TX1REQ = (1 << 4),
+  STAT_TX2REQ = (1 << 6)
+};
+
+enum RXSTATUS : uint8_t { RXSTATUS_RXB0 = (1 << 6), RXSTATUS_RXB1 = (1 << 7) };
 
 static const uint8_t STAT_RXIF_MASK = STAT_RX0IF | STAT_RX1IF;
 static const uint8_t EFLG_ERRORMASK = EFLG_RX1OVR | EFLG_RX0OVR | EFLG_TXBO | EFLG_TXEP | EFLG_RXEP;
 
 class MCP2515 : public canbus::Canbus,
+                public canbus_ext::FrameSource,
                 public spi::SPIDevice<spi::BIT_ORDER_MSB_FIRST, spi::CLOCK_POLARITY_LOW, spi::CLOCK_PHASE_LEADING,
                                       spi::DATA_RATE_8MHZ> {
  public:
   MCP2515(){};
-  void set_mcp_clock(CanClock clock) { this->mcp_clock_ = clock; };
+  void loop() override;
+  void set_mcp_clock(CanClock clock);
+  void set_mcp_clock_hz(uint32_t clock_hz) { this->mcp_clock_hz_ = clock_hz; }
+  void set_sample_point(uint16_t permille) { this->sample_point_ = permille; }
   void set_mcp_mode(const CanctrlReqopMode mode) { this->mcp_mode_ = mode; }
+  uint32_t get_bit_rate_bps() const override { return canbus_ext::speed_to_bps(this->bit_rate_); }
+  void dump_config() override;
+  bool request_sleep() override;
+  void request_wake() override;
+#ifdef USE_MCP2515_AUTODETECT
+  void add_autodetect_candidate(canbus::CanSpeed speed) { this->autodetect_candidates_.push_back(speed); }
+  void set_autodetect_times(uint32_t listen_time_ms, uint32_t timeout_ms) {
+    this->autodetect_listen_ms_ = listen_time_ms;
+    this->autodetect_timeout_ms_ = timeout_ms;
+  }
+#endif
+#ifdef USE_MCP2515_SELF_TEST
+  void set_self_test_frames(uint8_t frames) { this->self_test_frames_ = frames; }
+  void set_spi_throughput_sensor(sensor::Sensor *sens) { this->spi_throughput_sensor_ = sens; }
+  void set_loopback_latency_sensor(sensor::Sensor *sens) { this->loopback_latency_sensor_ = sens; }
+  void set_loopback_errors_sensor(sensor::Sensor *sens) { this->loopback_errors_sensor_ = sens; }
+#endif
+#ifdef USE_MCP2515_TASK
+  void set_task(uint8_t core, uint8_t priority) {
+    this->task_core_ = core;
+    this->task_priority_ = priority;
+  }
+  void set_interrupt_pin(InternalGPIOPin *interrupt_pin) { this->interrupt_pin_ = interrupt_pin; }
+#endif
   static const struct TxBnRegs {
     REGISTER CTRL;
     REGISTER SIDH;
@@ -73,9 +132,13 @@ class MCP2515 : public canbus::Canbus,
   } RXB[N_RXBUFFERS];
 
  protected:
-  CanClock mcp_clock_{MCP_8MHZ};
+  uint32_t mcp_clock_hz_{8000000};
+  uint16_t sample_point_{DEFAULT_SAMPLE_POINT_PERMILLE};
+  BitTiming timing_{};
   CanctrlReqopMode mcp_mode_ = CANCTRL_REQOP_NORMAL;
   bool setup_internal() override;
+  bool start_();
+  void wake_();
   canbus::Error set_mode_(CanctrlReqopMode mode);
 
   uint8_t read_register_(REGISTER reg);
@@ -87,14 +150,15 @@ class MCP2515 : public canbus::Canbus,
   void prepare_id_(uint8_t *buffer, bool extended, uint32_t id);
   canbus::Error reset_();
   canbus::Error set_clk_out_(CanClkOut divisor);
-  canbus::Error set_bitrate_(canbus::CanSpeed can_speed);
-  canbus::Error set_bitrate_(canbus::CanSpeed can_speed, CanClock can_clock);
+  canbus::Error set_bitrate_(uint32_t bit_rate);
   canbus::Error set_filter_mask_(MASK mask, bool extended, uint32_t ul_data);
   canbus::Error set_filter_(RXF num, bool extended, uint32_t ul_data);
   canbus::Error send_message_(TXBn txbn, struct canbus::CanFrame *frame);
   canbus::Error send_message(struct canbus::CanFrame *frame) override;
+  canbus::Error send_now_(struct canbus::CanFrame *frame);
   canbus::Error read_message_(RXBn rxbn, struct canbus::CanFrame *frame);
   canbus::Error read_message(struct canbus::CanFrame *frame) override;
+  size_t read_messages(struct canbus::CanFrame *frames, size_t max_frames, uint32_t *timestamps_us = nullptr);
   bool check_receive_();
   bool check_error_();
   uint8_t get_error_flags_();
@@ -107,6 +171,71 @@ class MCP2515 : public canbus::Canbus,
   void clear_rx_n_ovr_();
   void clear_merr_();
   void clear_errif_();
+
+  // frames drained by loop(), handed to the canbus triggers through read_message()
+  canbus::CanFrame rx_pending_[RX_BATCH];
+  uint32_t rx_timestamps_[RX_BATCH];
+  uint8_t rx_pending_count_{0};
+  uint8_t rx_pending_pos_{0};
+
+#ifdef USE_MCP2515_SELF_TEST
+  // Boot-time check in loopback mode: SPI write/read-back of a TX buffer, then frames round-tripped through the
+  // TX and RX buffers. Runs before the configured mode (or autodetect) starts.
+  void self_test_();
+
+  uint8_t self_test_frames_{32};
+  float spi_throughput_{NAN};   // kB/s
+  float loopback_latency_{NAN};  // us per frame
+  uint32_t self_test_errors_{0};
+  sensor::Sensor *spi_throughput_sensor_{nullptr};
+  sensor::Sensor *loopback_latency_sensor_{nullptr};
+  sensor::Sensor *loopback_errors_sensor_{nullptr};
+#endif
+
+#ifdef USE_MCP2515_AUTODETECT
+  // Listen-only trial of each candidate bit rate: received frames vote for it, MERRF (frames that fail on the
+  // wire at this rate) against it. Normal operation, and the CAN task, start once a rate is picked.
+  void autodetect_try_(size_t index);
+  void autodetect_loop_();
+  void autodetect_finish_();
+
+  std::vector<canbus::CanSpeed> autodetect_candidates_;
+  uint32_t autodetect_listen_ms_{250};
+  uint32_t autodetect_timeout_ms_{10000};
+  bool detecting_{false};
+  canbus::CanSpeed configured_bit_rate_{canbus::CAN_125KBPS};
+  size_t autodetect_index_{0};
+  uint32_t autodetect_start_{0};
+  uint32_t candidate_start_{0};
+  uint8_t candidate_frames_{0};
+  uint8_t candidate_errors_{0};
+#endif
+
+#ifdef USE_MCP2515_TASK
+  // With a CAN task all SPI traffic to the chip happens there once setup is done. The mutex covers every
+  // enable() / disable() pair so that calls still made from the loop task cannot interleave with it.
+  // It does not order against other devices on the bus, canbus.py rejects configs that share the SPI bus.
+  struct TimedFrame {
+    canbus::CanFrame frame;
+    uint32_t timestamp_us;
+  };
+
+  void enable();
+  void disable();
+  static void task_entry_(void *arg);
+  static void gpio_intr_(MCP2515 *arg);
+  void task_loop_();
+  size_t take_task_frames_();
+
+  uint8_t task_core_{1};
+  uint8_t task_priority_{5};
+  InternalGPIOPin *interrupt_pin_{nullptr};
+  TaskHandle_t task_handle_{nullptr};
+  SemaphoreHandle_t spi_mutex_{nullptr};
+  canbus_ext::SpscQueue<TimedFrame, TASK_QUEUE_SIZE> rx_queue_;  // CAN task -> loop()
+  canbus_ext::SpscQueue<canbus::CanFrame, TASK_QUEUE_SIZE> tx_queue_;  // loop() -> CAN task
+  std::atomic<uint32_t> rx_dropped_{0};
+#endif
 };
 }  // namespace mcp2515
 }  // namespace esphome
@@ -0,0 +1,102 @@
+#pragma once
+
+#include <cstdint>
+#include "mcp2515_defs.h"
+
+namespace esphome {
+namespace mcp2515 {
+
+// CAN bit timing for the MCP2515 (datasheet section 5). One time quantum is TQ = 2 * BRP / Fosc and a bit is
+// SyncSeg (1 TQ) + PropSeg + PS1 + PS2; the bus is sampled at the end of PS1.
+static const uint32_t DEFAULT_SAMPLE_POINT_PERMILLE = 875;  // CiA 301 recommendation
+// larger rate errors eat the oscillator tolerance budget of the whole bus
+static const uint32_t MAX_BIT_RATE_ERROR_PPM = 5000;
+
+struct BitTiming {
+  bool ok;
+  uint8_t cfg1;
+  uint8_t cfg2;
+  uint8_t cfg3;
+  uint8_t brp;
+  uint8_t prop_seg;
+  uint8_t phase_seg1;
+  uint8_t phase_seg2;
+  uint8_t sjw;
+  uint32_t bit_rate;      // what the registers actually give, rounded to bit/s
+  uint32_t error_ppm;     // |bit_rate - requested| relative to the request
+  uint16_t sample_point;  // permille
+};
+
+// Picks the timing with the smallest rate error, then the sample point closest to the target, then the most
+// quanta per bit (finer resynchronisation). Usable in constant expressions, so fixed configs can be checked
+// at build time.
+constexpr BitTiming solve_bit_timing(uint32_t clock_hz, uint32_t bit_rate,
+                                     uint32_t sample_point_permille = DEFAULT_SAMPLE_POINT_PERMILLE) {
+  BitTiming best{};
+  if (clock_hz == 0 || bit_rate == 0)
+    return best;
+  uint64_t best_err = UINT64_MAX;
+  uint64_t best_divider = 1;
+  uint32_t best_sp_diff = UINT32_MAX;
+  for (uint32_t brp = 1; brp <= 64; brp++) {
+    // 4 quanta per bit is below the datasheet minimum, but the only way to 1 Mbit/s from an 8 MHz crystal
+    for (uint32_t tq = 4; tq <= 25; tq++) {
+      const uint64_t divider = 2ull * brp * tq;
+      const uint64_t actual = clock_hz / divider;
+      const uint64_t rem = clock_hz % divider;
+      // error scaled by divider to stay in integers: |clock - bit_rate * divider|
+      const uint64_t target = uint64_t(bit_rate) * divider;
+      const uint64_t err = clock_hz > target ? clock_hz - target : target - clock_hz;
+      if (err * 1000000ull > uint64_t(MAX_BIT_RATE_ERROR_PPM) * target)
+        continue;
+
+      uint32_t ps2 = (tq * (1000 - sample_point_permille) + 500) / 1000;
+      if (tq == 4) {
+        ps2 = 1;
+      } else {
+        if (ps2 < 2)
+          ps2 = 2;
+        if (ps2 > 8)
+          ps2 = 8;
+        if (tq - 1 - ps2 > 16)
+          ps2 = tq - 1 - 16;
+      }
+      const uint32_t tseg1 = tq - 1 - ps2;
+      if (ps2 > 8 || tseg1 < ps2)
+        continue;
+      // PS1 takes what it can, it is what lengthens on resynchronisation
+      const uint32_t ps1 = tseg1 - 1 > 8 ? 8 : tseg1 - 1;
+      const uint32_t prop = tseg1 - ps1;
+      const uint32_t sp = (1 + tseg1) * 1000 / tq;
+      const uint32_t sp_diff = sp > sample_point_permille ? sp - sample_point_permille : sample_point_permille - sp;
+
+      // relative errors err / (bit_rate * divider), cross-multiplied
+      bool better = !best.ok || err * best_divider < best_err * divider;
+      if (best.ok && err * best_divider == best_err * divider)
+        better = sp_diff < best_sp_diff || (sp_diff == best_sp_diff && divider / brp > best_divider / best.brp);
+      if (!better)
+        continue;
+
+      const uint32_t sjw = ps2 > 4 ? 4 : (ps2 > 1 ? ps2 - 1 : 1);
+      best.ok = true;
+      best.brp = brp;
+      best.prop_seg = prop;
+      best.phase_seg1 = ps1;
+      best.phase_seg2 = ps2;
+      best.sjw = sjw;
+      best.cfg1 = uint8_t(((sjw - 1) << 6) | (brp - 1));
+      best.cfg2 = uint8_t(CNF2_BTLMODE | ((ps1 - 1) << 3) | (prop - 1));
+      best.cfg3 = uint8_t(CNF3_SOF | (ps2 - 1));
+      best.bit_rate = uint32_t(actual + (rem * 2 >= divider ? 1 : 0));
+      best.error_ppm = uint32_t(err * 1000000ull / target);
+      best.sample_point = uint16_t(sp);
+      best_err = err;
+      best_divider = divider;
+      best_sp_diff = sp_diff;
+    }
+  }
+  return best;
+}
+
+}  // namespace mcp2515
+}  // namespace esphome
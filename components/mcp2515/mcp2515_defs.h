@@ -128,11 +128,13 @@ enum REGISTER : uint8_t {
 static const uint8_t CANSTAT_OPMOD = 0xE0;
 static const uint8_t CANSTAT_ICOD = 0x0E;
 
+static const uint8_t CNF2_BTLMODE = 0x80;
 static const uint8_t CNF3_SOF = 0x80;
 
 static const uint8_t TXB_EXIDE_MASK = 0x08;
 static const uint8_t DLC_MASK = 0x0F;
 static const uint8_t RTR_MASK = 0x40;
+static const uint8_t SIDL_SRR_MASK = 0x10;
 
 static const uint8_t RXB_CTRL_RXM_STD = 0x20;
 static const uint8_t RXB_CTRL_RXM_EXT = 0x40;
@@ -149,226 +151,5 @@ static const uint8_t MCP_EID0 = 3;
 static const uint8_t MCP_DLC = 4;
 static const uint8_t MCP_DATA = 5;
 
-/*
- *  Speed 8M
- */
-static const uint8_t MCP_8MHZ_1000KBPS_CFG1 = 0x00;
-static const uint8_t MCP_8MHZ_1000KBPS_CFG2 = 0x80;
-static const uint8_t MCP_8MHZ_1000KBPS_CFG3 = 0x80;
-
-static const uint8_t MCP_8MHZ_500KBPS_CFG1 = 0x00;
-static const uint8_t MCP_8MHZ_500KBPS_CFG2 = 0x90;
-static const uint8_t MCP_8MHZ_500KBPS_CFG3 = 0x82;
-
-static const uint8_t MCP_8MHZ_250KBPS_CFG1 = 0x00;
-static const uint8_t MCP_8MHZ_250KBPS_CFG2 = 0xB1;
-static const uint8_t MCP_8MHZ_250KBPS_CFG3 = 0x85;
-
-static const uint8_t MCP_8MHZ_200KBPS_CFG1 = 0x00;
-static const uint8_t MCP_8MHZ_200KBPS_CFG2 = 0xB4;
-static const uint8_t MCP_8MHZ_200KBPS_CFG3 = 0x86;
-
-static const uint8_t MCP_8MHZ_125KBPS_CFG1 = 0x01;
-static const uint8_t MCP_8MHZ_125KBPS_CFG2 = 0xB1;
-static const uint8_t MCP_8MHZ_125KBPS_CFG3 = 0x85;
-
-static const uint8_t MCP_8MHZ_100KBPS_CFG1 = 0x01;
-static const uint8_t MCP_8MHZ_100KBPS_CFG2 = 0xB4;
-static const uint8_t MCP_8MHZ_100KBPS_CFG3 = 0x86;
-
-static const uint8_t MCP_8MHZ_80KBPS_CFG1 = 0x01;
-static const uint8_t MCP_8MHZ_80KBPS_CFG2 = 0xBF;
-static const uint8_t MCP_8MHZ_80KBPS_CFG3 = 0x87;
-
-static const uint8_t MCP_8MHZ_50KBPS_CFG1 = 0x03;
-static const uint8_t MCP_8MHZ_50KBPS_CFG2 = 0xB4;
-static const uint8_t MCP_8MHZ_50KBPS_CFG3 = 0x86;
-
-static const uint8_t MCP_8MHZ_40KBPS_CFG1 = 0x03;
-static const uint8_t MCP_8MHZ_40KBPS_CFG2 = 0xBF;
-static const uint8_t MCP_8MHZ_40KBPS_CFG3 = 0x87;
-
-static const uint8_t MCP_8MHZ_33K3BPS_CFG1 = 0x47;
-static const uint8_t MCP_8MHZ_33K3BPS_CFG2 = 0xE2;
-static const uint8_t MCP_8MHZ_33K3BPS_CFG3 = 0x85;
-
-static const uint8_t MCP_8MHZ_31K25BPS_CFG1 = 0x07;
-static const uint8_t MCP_8MHZ_31K25BPS_CFG2 = 0xA4;
-static const uint8_t MCP_8MHZ_31K25BPS_CFG3 = 0x84;
-
-static const uint8_t MCP_8MHZ_20KBPS_CFG1 = 0x07;
-static const uint8_t MCP_8MHZ_20KBPS_CFG2 = 0xBF;
-static const uint8_t MCP_8MHZ_20KBPS_CFG3 = 0x87;
-
-static const uint8_t MCP_8MHZ_10KBPS_CFG1 = 0x0F;
-static const uint8_t MCP_8MHZ_10KBPS_CFG2 = 0xBF;
-static const uint8_t MCP_8MHZ_10KBPS_CFG3 = 0x87;
-
-static const uint8_t MCP_8MHZ_5KBPS_CFG1 = 0x1F;
-static const uint8_t MCP_8MHZ_5KBPS_CFG2 = 0xBF;
-static const uint8_t MCP_8MHZ_5KBPS_CFG3 = 0x87;
-
-/*
- *  Speed 12M
- */
-
-static const uint8_t MCP_12MHZ_1000KBPS_CFG1 = 0x00;
-static const uint8_t MCP_12MHZ_1000KBPS_CFG2 = 0x88;
-static const uint8_t MCP_12MHZ_1000KBPS_CFG3 = 0x81;
-
-static const uint8_t MCP_12MHZ_500KBPS_CFG1 = 0x00;
-static const uint8_t MCP_12MHZ_500KBPS_CFG2 = 0x9B;
-static const uint8_t MCP_12MHZ_500KBPS_CFG3 = 0x82;
-
-static const uint8_t MCP_12MHZ_250KBPS_CFG1 = 0x01;
-static const uint8_t MCP_12MHZ_250KBPS_CFG2 = 0x9B;
-static const uint8_t MCP_12MHZ_250KBPS_CFG3 = 0x82;
-
-static const uint8_t MCP_12MHZ_200KBPS_CFG1 = 0x01;
-static const uint8_t MCP_12MHZ_200KBPS_CFG2 = 0xA4;
-static const uint8_t MCP_12MHZ_200KBPS_CFG3 = 0x83;
-
-static const uint8_t MCP_12MHZ_125KBPS_CFG1 = 0x03;
-static const uint8_t MCP_12MHZ_125KBPS_CFG2 = 0x9B;
-static const uint8_t MCP_12MHZ_125KBPS_CFG3 = 0x82;
-
-static const uint8_t MCP_12MHZ_100KBPS_CFG1 = 0x03;
-static const uint8_t MCP_12MHZ_100KBPS_CFG2 = 0xA4;
-static const uint8_t MCP_12MHZ_100KBPS_CFG3 = 0x83;
-
-static const uint8_t MCP_12MHZ_80KBPS_CFG1 = 0x04;
-static const uint8_t MCP_12MHZ_80KBPS_CFG2 = 0xA4;
-static const uint8_t MCP_12MHZ_80KBPS_CFG3 = 0x83;
-
-static const uint8_t MCP_12MHZ_50KBPS_CFG1 = 0x07;
-static const uint8_t MCP_12MHZ_50KBPS_CFG2 = 0xA4;
-static const uint8_t MCP_12MHZ_50KBPS_CFG3 = 0x83;
-
-static const uint8_t MCP_12MHZ_40KBPS_CFG1 = 0x09;
-static const uint8_t MCP_12MHZ_40KBPS_CFG2 = 0xA4;
-static const uint8_t MCP_12MHZ_40KBPS_CFG3 = 0x83;
-
-static const uint8_t MCP_12MHZ_33K3BPS_CFG1 = 0x08;
-static const uint8_t MCP_12MHZ_33K3BPS_CFG2 = 0xB6;
-static const uint8_t MCP_12MHZ_33K3BPS_CFG3 = 0x84;
-
-static const uint8_t MCP_12MHZ_20KBPS_CFG1 = 0x0E;
-static const uint8_t MCP_12MHZ_20KBPS_CFG2 = 0xB6;
-static const uint8_t MCP_12MHZ_20KBPS_CFG3 = 0x84;
-
-static const uint8_t MCP_12MHZ_10KBPS_CFG1 = 0x31;
-static const uint8_t MCP_12MHZ_10KBPS_CFG2 = 0x9B;
-static const uint8_t MCP_12MHZ_10KBPS_CFG3 = 0x82;
-
-static const uint8_t MCP_12MHZ_5KBPS_CFG1 = 0x3B;
-static const uint8_t MCP_12MHZ_5KBPS_CFG2 = 0xB6;
-static const uint8_t MCP_12MHZ_5KBPS_CFG3 = 0x84;
-
-/*
- *  speed 16M
- */
-static const uint8_t MCP_16MHZ_1000KBPS_CFG1 = 0x00;
-static const uint8_t MCP_16MHZ_1000KBPS_CFG2 = 0xD0;
-static const uint8_t MCP_16MHZ_1000KBPS_CFG3 = 0x82;
-
-static const uint8_t MCP_16MHZ_500KBPS_CFG1 = 0x00;
-static const uint8_t MCP_16MHZ_500KBPS_CFG2 = 0xF0;
-static const uint8_t MCP_16MHZ_500KBPS_CFG3 = 0x86;
-
-static const uint8_t MCP_16MHZ_250KBPS_CFG1 = 0x41;
-static const uint8_t MCP_16MHZ_250KBPS_CFG2 = 0xF1;
-static const uint8_t MCP_16MHZ_250KBPS_CFG3 = 0x85;
-
-static const uint8_t MCP_16MHZ_200KBPS_CFG1 = 0x01;
-static const uint8_t MCP_16MHZ_200KBPS_CFG2 = 0xFA;
-static const uint8_t MCP_16MHZ_200KBPS_CFG3 = 0x87;
-
-static const uint8_t MCP_16MHZ_125KBPS_CFG1 = 0x03;
-static const uint8_t MCP_16MHZ_125KBPS_CFG2 = 0xF0;
-static const uint8_t MCP_16MHZ_125KBPS_CFG3 = 0x86;
-
-static const uint8_t MCP_16MHZ_100KBPS_CFG1 = 0x03;
-static const uint8_t MCP_16MHZ_100KBPS_CFG2 = 0xFA;
-static const uint8_t MCP_16MHZ_100KBPS_CFG3 = 0x87;
-
-static const uint8_t MCP_16MHZ_80KBPS_CFG1 = 0x03;
-static const uint8_t MCP_16MHZ_80KBPS_CFG2 = 0xFF;
-static const uint8_t MCP_16MHZ_80KBPS_CFG3 = 0x87;
-
-static const uint8_t MCP_16MHZ_83K3BPS_CFG1 = 0x03;
-static const uint8_t MCP_16MHZ_83K3BPS_CFG2 = 0xBE;
-static const uint8_t MCP_16MHZ_83K3BPS_CFG3 = 0x07;
-
-static const uint8_t MCP_16MHZ_50KBPS_CFG1 = 0x07;
-static const uint8_t MCP_16MHZ_50KBPS_CFG2 = 0xFA;
-static const uint8_t MCP_16MHZ_50KBPS_CFG3 = 0x87;
-
-static const uint8_t MCP_16MHZ_40KBPS_CFG1 = 0x07;
-static const uint8_t MCP_16MHZ_40KBPS_CFG2 = 0xFF;
-static const uint8_t MCP_16MHZ_40KBPS_CFG3 = 0x87;
-
-static const uint8_t MCP_16MHZ_33K3BPS_CFG1 = 0x4E;
-static const uint8_t MCP_16MHZ_33K3BPS_CFG2 = 0xF1;
-static const uint8_t MCP_16MHZ_33K3BPS_CFG3 = 0x85;
-
-static const uint8_t MCP_16MHZ_20KBPS_CFG1 = 0x0F;
-static const uint8_t MCP_16MHZ_20KBPS_CFG2 = 0xFF;
-static const uint8_t MCP_16MHZ_20KBPS_CFG3 = 0x87;
-
-static const uint8_t MCP_16MHZ_10KBPS_CFG1 = 0x1F;
-static const uint8_t MCP_16MHZ_10KBPS_CFG2 = 0xFF;
-static const uint8_t MCP_16MHZ_10KBPS_CFG3 = 0x87;
-
-static const uint8_t MCP_16MHZ_5KBPS_CFG1 = 0x3F;
-static const uint8_t MCP_16MHZ_5KBPS_CFG2 = 0xFF;
-static const uint8_t MCP_16MHZ_5KBPS_CFG3 = 0x87;
-
-/*
- *  speed 20M
- */
-static const uint8_t MCP_20MHZ_1000KBPS_CFG1 = 0x00;
-static const uint8_t MCP_20MHZ_1000KBPS_CFG2 = 0xD9;
-static const uint8_t MCP_20MHZ_1000KBPS_CFG3 = 0x82;
-
-static const uint8_t MCP_20MHZ_500KBPS_CFG1 = 0x00;
-static const uint8_t MCP_20MHZ_500KBPS_CFG2 = 0xFA;
-static const uint8_t MCP_20MHZ_500KBPS_CFG3 = 0x87;
-
-static const uint8_t MCP_20MHZ_250KBPS_CFG1 = 0x41;
-static const uint8_t MCP_20MHZ_250KBPS_CFG2 = 0xFB;
-static const uint8_t MCP_20MHZ_250KBPS_CFG3 = 0x86;
-
-static const uint8_t MCP_20MHZ_200KBPS_CFG1 = 0x01;
-static const uint8_t MCP_20MHZ_200KBPS_CFG2 = 0xFF;
-static const uint8_t MCP_20MHZ_200KBPS_CFG3 = 0x87;
-
-static const uint8_t MCP_20MHZ_125KBPS_CFG1 = 0x03;
-static const uint8_t MCP_20MHZ_125KBPS_CFG2 = 0xFA;
-static const uint8_t MCP_20MHZ_125KBPS_CFG3 = 0x87;
-
-static const uint8_t MCP_20MHZ_100KBPS_CFG1 = 0x04;
-static const uint8_t MCP_20MHZ_100KBPS_CFG2 = 0xFA;
-static const uint8_t MCP_20MHZ_100KBPS_CFG3 = 0x87;
-
-static const uint8_t MCP_20MHZ_83K3BPS_CFG1 = 0x04;
-static const uint8_t MCP_20MHZ_83K3BPS_CFG2 = 0xFE;
-static const uint8_t MCP_20MHZ_83K3BPS_CFG3 = 0x87;
-
-static const uint8_t MCP_20MHZ_80KBPS_CFG1 = 0x04;
-static const uint8_t MCP_20MHZ_80KBPS_CFG2 = 0xFF;
-static const uint8_t MCP_20MHZ_80KBPS_CFG3 = 0x87;
-
-static const uint8_t MCP_20MHZ_50KBPS_CFG1 = 0x09;
-static const uint8_t MCP_20MHZ_50KBPS_CFG2 = 0xFA;
-static const uint8_t MCP_20MHZ_50KBPS_CFG3 = 0x87;
-
-static const uint8_t MCP_20MHZ_40KBPS_CFG1 = 0x09;
-static const uint8_t MCP_20MHZ_40KBPS_CFG2 = 0xFF;
-static const uint8_t MCP_20MHZ_40KBPS_CFG3 = 0x87;
-
-static const uint8_t MCP_20MHZ_33K3BPS_CFG1 = 0x0B;
-static const uint8_t MCP_20MHZ_33K3BPS_CFG2 = 0xFF;
-static const uint8_t MCP_20MHZ_33K3BPS_CFG3 = 0x87;
-
 }  // namespace mcp2515
 }  // namespace esphome
@@ -0,0 +1,33 @@
+import esphome.codegen as cg
+import esphome.config_validation as cv
+from esphome.components.canbus import CanbusComponent
+from esphome.components.canbus_ext import frame_source
+from esphome.const import CONF_ID, CONF_PORT
+
+CODEOWNERS = ["@leodesigner"]
+DEPENDENCIES = ["network"]
+AUTO_LOAD = ["canbus_ext", "socket"]
+
+CONF_CANBUS_ID = "canbus_id"
+CONF_BUFFER_SIZE = "buffer_size"
+
+slcan_server_ns = cg.esphome_ns.namespace("slcan_server")
+SlcanServer = slcan_server_ns.class_("SlcanServer", cg.Component)
+
+CONFIG_SCHEMA = cv.Schema(
+    {
+        cv.GenerateID(): cv.declare_id(SlcanServer),
+        cv.Required(CONF_CANBUS_ID): cv.use_id(CanbusComponent),
+        cv.Optional(CONF_PORT, default=3333): cv.port,
+        # about 30 bytes per frame, 2048 holds some 70 frames while the client is slow
+        cv.Optional(CONF_BUFFER_SIZE, default=2048): cv.int_range(min=256, max=16384),
+    }
+).extend(cv.COMPONENT_SCHEMA)
+
+
+async def to_code(config):
+    canbus = await cg.get_variable(config[CONF_CANBUS_ID])
+    var = cg.new_Pvariable(config[CONF_ID], canbus, config[CONF_BUFFER_SIZE])
+    cg.add(var.set_frame_source(frame_source(canbus)))
+    await cg.register_component(var, config)
+    cg.add(var.set_port(config[CONF_PORT]))
@@ -0,0 +1,286 @@
+#include "slcan_server.h"
+#include "esphome/core/log.h"
+
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+
+namespace esphome {
+namespace slcan_server {
+
+static const char *const TAG = "slcan_server";
+
+static const char SLCAN_OK = '\r';
+static const char SLCAN_ERROR = '\a';
+static const uint8_t STATUS_DATA_OVERRUN = 0x08;
+// the longest reply to a single command ("V1013\r" and alike)
+static const size_t SLCAN_MAX_REPLY = 6;
+static const size_t READ_CHUNK = 64;
+
+static const char HEX_DIGITS[] = "0123456789ABCDEF";
+
+static bool parse_hex(const char *text, size_t digits, uint32_t *value) {
+  *value = 0;
+  for (size_t i = 0; i < digits; i++) {
+    char c = text[i];
+    uint8_t nibble;
+    if (c >= '0' && c <= '9') {
+      nibble = c - '0';
+    } else if (c >= 'A' && c <= 'F') {
+      nibble = c - 'A' + 10;
+    } else if (c >= 'a' && c <= 'f') {
+      nibble = c - 'a' + 10;
+    } else {
+      return false;
+    }
+    *value = (*value << 4) | nibble;
+  }
+  return true;
+}
+
+static char *put_hex(char *pos, uint32_t value, size_t digits) {
+  for (size_t i = digits; i > 0; i--) {
+    pos[i - 1] = HEX_DIGITS[value & 0x0F];
+    value >>= 4;
+  }
+  return pos + digits;
+}
+
+void SlcanServer::setup() {
+  if (this->frame_source_ == nullptr) {
+    ESP_LOGE(TAG, "The canbus platform does not provide a frame source");
+    this->mark_failed();
+    return;
+  }
+  this->listener_ = socket::socket_ip(SOCK_STREAM, 0);
+  if (this->listener_ == nullptr) {
+    ESP_LOGE(TAG, "Could not create socket");
+    this->mark_failed();
+    return;
+  }
+  int enable = 1;
+  this->listener_->setsockopt(SOL_SOCKET, SO_REUSEADDR, &enable, sizeof(enable));
+  this->listener_->setblocking(false);
+  struct sockaddr_storage server;
+  socklen_t len = socket::set_sockaddr_any((struct sockaddr *) &server, sizeof(server), this->port_);
+  if (len == 0 || this->listener_->bind((struct sockaddr *) &server, len) != 0 || this->listener_->listen(1) != 0) {
+    ESP_LOGE(TAG, "Could not listen on port %u: errno %d", this->port_, errno);
+    this->listener_.reset();
+    this->mark_failed();
+    return;
+  }
+
+  this->tx_buffer_.resize(this->buffer_size_);
+  this->tx_data_.reserve(canbus::CAN_MAX_DATA_LENGTH);
+  this->frame_source_->add_frame_listener(this);
+}
+
+void SlcanServer::dump_config() {
+  ESP_LOGCONFIG(TAG, "SLCAN server:");
+  ESP_LOGCONFIG(TAG, "  Port: %u", this->port_);
+  ESP_LOGCONFIG(TAG, "  Send buffer: %u bytes", this->buffer_size_);
+}
+
+void SlcanServer::loop() {
+  if (this->listener_ == nullptr)
+    return;
+  this->accept_();
+  if (this->client_ == nullptr)
+    return;
+  if (!this->read_commands_() || !this->flush_())
+    this->disconnect_();
+}
+
+void SlcanServer::accept_() {
+  struct sockaddr_storage peer;
+  socklen_t peer_len = sizeof(peer);
+  std::unique_ptr<socket::Socket> socket = this->listener_->accept((struct sockaddr *) &peer, &peer_len);
+  if (socket == nullptr)
+    return;
+  if (this->client_ != nullptr) {
+    ESP_LOGW(TAG, "Connection refused, a client is already connected");
+    return;
+  }
+  socket->setblocking(false);
+  this->client_ = std::move(socket);
+  this->state_ = STATE_CLOSED;
+  this->timestamps_ = false;
+  this->overrun_ = false;
+  this->tx_length_ = 0;
+  this->line_length_ = 0;
+  ESP_LOGD(TAG, "Client connected");
+}
+
+void SlcanServer::disconnect_() {
+  ESP_LOGD(TAG, "Client disconnected, %u frames sent, %u dropped", (unsigned) this->frames_sent_,
+           (unsigned) this->frames_dropped_);
+  this->client_.reset();
+  this->state_ = STATE_CLOSED;
+}
+
+void SlcanServer::on_frames(const canbus::CanFrame *frames, const uint32_t *timestamps_us, size_t count) {
+  if (this->client_ == nullptr || this->state_ == STATE_CLOSED)
+    return;
+  for (size_t i = 0; i < count; i++) {
+    const canbus::CanFrame &frame = frames[i];
+    if (this->tx_free_() < SLCAN_MAX_FRAME) {
+      this->frames_dropped_++;
+      this->overrun_ = true;
+      continue;
+    }
+    char *start = (char *) this->tx_buffer_.data() + this->tx_length_;
+    char *pos = start;
+    const uint8_t dlc = frame.can_data_length_code > 8 ? 8 : frame.can_data_length_code;
+    if (frame.use_extended_id) {
+      *pos++ = frame.remote_transmission_request ? 'R' : 'T';
+      pos = put_hex(pos, frame.can_id, 8);
+    } else {
+      *pos++ = frame.remote_transmission_request ? 'r' : 't';
+      pos = put_hex(pos, frame.can_id, 3);
+    }
+    *pos++ = '0' + dlc;
+    if (!frame.remote_transmission_request) {
+      for (uint8_t j = 0; j < dlc; j++)
+        pos = put_hex(pos, frame.data[j], 2);
+    }
+    if (this->timestamps_)
+      pos = put_hex(pos, (timestamps_us[i] / 1000) % 60000, 4);
+    *pos++ = SLCAN_OK;
+    this->tx_length_ += pos - start;
+    this->frames_sent_++;
+  }
+}
+
+// Reads no more than the send buffer can answer, see the class comment
+bool SlcanServer::read_commands_() {
+  uint8_t buf[READ_CHUNK];
+  size_t budget = this->tx_free_() / SLCAN_MAX_REPLY;
+  if (budget == 0)
+    return true;
+  ssize_t received = this->client_->read(buf, budget < sizeof(buf) ? budget : sizeof(buf));
+  if (received == 0)
+    return false;
+  if (received < 0)
+    return errno == EAGAIN || errno == EWOULDBLOCK;
+
+  for (ssize_t i = 0; i < received; i++) {
+    const char c = buf[i];
+    if (c == '\n')
+      continue;
+    if (c != '\r') {
+      // an overlong line is kept at SLCAN_MAX_LINE and answered with an error
+      if (this->line_length_ < SLCAN_MAX_LINE)
+        this->line_[this->line_length_++] = c;
+      continue;
+    }
+    if (this->line_length_ == 0 || this->line_length_ == SLCAN_MAX_LINE) {
+      this->reply_(&SLCAN_ERROR, 1);
+    } else {
+      this->handle_command_(this->line_, this->line_length_);
+    }
+    this->line_length_ = 0;
+  }
+  return true;
+}
+
+// One write() for everything queued since the last loop(); what the socket does not take stays queued
+bool SlcanServer::flush_() {
+  if (this->tx_length_ == 0)
+    return true;
+  ssize_t written = this->client_->write(this->tx_buffer_.data(), this->tx_length_);
+  if (written < 0)
+    return errno == EAGAIN || errno == EWOULDBLOCK;
+  this->tx_length_ -= written;
+  memmove(this->tx_buffer_.data(), this->tx_buffer_.data() + written, this->tx_length_);
+  return true;
+}
+
+void SlcanServer::reply_(const char *text, size_t length) {
+  if (this->tx_free_() < length)
+    return;
+  memcpy(this->tx_buffer_.data() + this->tx_length_, text, length);
+  this->tx_length_ += length;
+}
+
+void SlcanServer::handle_command_(const char *line, size_t length) {
+  char reply[SLCAN_MAX_REPLY];
+  switch (line[0]) {
+    case 'O':
+      this->state_ = STATE_OPEN;
+      break;
+    case 'L':
+      this->state_ = STATE_LISTEN_ONLY;
+      break;
+    case 'C':
+      this->state_ = STATE_CLOSED;
+      break;
+    case 'S':
+    case 's':
+      // the bit rate is the one of the canbus component, the request is acknowledged and ignored
+      if (this->state_ != STATE_CLOSED) {
+        this->reply_(&SLCAN_ERROR, 1);
+        return;
+      }
+      break;
+    case 'M':
+    case 'm':
+      // acceptance filters belong to the canbus component as well
+      break;
+    case 'Z':
+      this->timestamps_ = length > 1 && line[1] == '1';
+      break;
+    case 'V':
+    case 'v':
+      this->reply_(line[0] == 'V' ? "V1013\r" : "v1013\r", 6);
+      return;
+    case 'N':
+      this->reply_("NR48C\r", 6);
+      return;
+    case 'F':
+      snprintf(reply, sizeof(reply), "F%02X\r", this->overrun_ ? STATUS_DATA_OVERRUN : 0);
+      this->overrun_ = false;
+      this->reply_(reply, 4);
+      return;
+    case 't':
+    case 'r':
+    case 'T':
+    case 'R':
+      if (this->state_ == STATE_OPEN && this->transmit_(line, length)) {
+        this->reply_(line[0] == 't' || line[0] == 'r' ? "z\r" : "Z\r", 2);
+      } else {
+        this->reply_(&SLCAN_ERROR, 1);
+      }
+      return;
+    default:
+      this->reply_(&SLCAN_ERROR, 1);
+      return;
+  }
+  this->reply_(&SLCAN_OK, 1);
+}
+
+bool SlcanServer::transmit_(const char *line, size_t length) {
+  const bool extended = line[0] == 'T' || line[0] == 'R';
+  const bool rtr = line[0] == 'r' || line[0] == 'R';
+  const size_t id_digits = extended ? 8 : 3;
+  uint32_t can_id;
+  uint32_t dlc;
+  if (length < 2 + id_digits || !parse_hex(line + 1, id_digits, &can_id) || can_id > (extended ? 0x1FFFFFFF : 0x7FF) ||
+      !parse_hex(line + 1 + id_digits, 1, &dlc) || dlc > canbus::CAN_MAX_DATA_LENGTH)
+    return false;
+  const char *data = line + 2 + id_digits;
+  if (length != 2 + id_digits + (rtr ? 0 : 2 * dlc))
+    return false;
+
+  // RTR frames carry no payload, the zeros only give send_data() the length code
+  this->tx_data_.assign(dlc, 0);
+  for (uint32_t i = 0; i < dlc && !rtr; i++) {
+    uint32_t byte;
+    if (!parse_hex(data + 2 * i, 2, &byte))
+      return false;
+    this->tx_data_[i] = byte;
+  }
+  return this->canbus_->send_data(can_id, extended, rtr, this->tx_data_) == canbus::ERROR_OK;
+}
+
+}  // namespace slcan_server
+}  // namespace esphome
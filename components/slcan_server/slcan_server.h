@@ -0,0 +1,72 @@
+#pragma once
+
+#include "esphome/core/component.h"
+#include "esphome/components/canbus/canbus.h"
+#include "esphome/components/canbus_ext/canbus_ext.h"
+#include "esphome/components/socket/socket.h"
+
+#include <memory>
+#include <vector>
+
+namespace esphome {
+namespace slcan_server {
+
+// longest command: T + 8 id digits + dlc + 16 data digits + CR
+static const size_t SLCAN_MAX_LINE = 32;
+// longest frame sent: T + id + dlc + data + 4 timestamp digits + CR
+static const size_t SLCAN_MAX_FRAME = 31;
+
+// Lawicel SLCAN over TCP for a single client (SavvyCAN, python-can with socket://host:port). Received frames
+// are formatted into a fixed send buffer and written to the socket once per loop(); when the client does not
+// keep up the buffer fills and further frames are dropped, reported as data overrun in the status flags.
+// Commands are only read while the buffer has room for the reply, so a client flooding transmit requests is
+// held back by TCP flow control instead of the CAN loop.
+class SlcanServer : public Component, public canbus_ext::FrameListener {
+ public:
+  SlcanServer(canbus::Canbus *canbus, uint16_t buffer_size) : canbus_(canbus), buffer_size_(buffer_size) {}
+  void set_frame_source(canbus_ext::FrameSource *frame_source) { frame_source_ = frame_source; }
+  void set_port(uint16_t port) { port_ = port; }
+
+  void setup() override;
+  void loop() override;
+  void dump_config() override;
+  float get_setup_priority() const override { return setup_priority::AFTER_WIFI; }
+
+  void on_frames(const canbus::CanFrame *frames, const uint32_t *timestamps_us, size_t count) override;
+
+ protected:
+  enum State : uint8_t { STATE_CLOSED, STATE_OPEN, STATE_LISTEN_ONLY };
+
+  void accept_();
+  void disconnect_();
+  bool read_commands_();
+  bool flush_();
+  void handle_command_(const char *line, size_t length);
+  bool transmit_(const char *line, size_t length);
+  void reply_(const char *text, size_t length);
+  size_t tx_free_() const { return this->tx_buffer_.size() - this->tx_length_; }
+
+  canbus::Canbus *canbus_;
+  canbus_ext::FrameSource *frame_source_{nullptr};
+  uint16_t buffer_size_;
+  uint16_t port_{3333};
+
+  std::unique_ptr<socket::Socket> listener_;
+  std::unique_ptr<socket::Socket> client_;
+  State state_{STATE_CLOSED};
+  bool timestamps_{false};
+  bool overrun_{false};
+
+  std::vector<uint8_t> tx_buffer_;
+  size_t tx_length_{0};
+  char line_[SLCAN_MAX_LINE];
+  size_t line_length_{0};
+  // payload scratch for canbus::send_data(), keeps its capacity
+  std::vector<uint8_t> tx_data_;
+
+  uint32_t frames_sent_{0};
+  uint32_t frames_dropped_{0};
+};
+
+}  // namespace slcan_server
+}  // namespace esphome
@@ -0,0 +1,31 @@
+import esphome.codegen as cg
+import esphome.config_validation as cv
+from esphome.components import canbus
+from esphome.const import CONF_ID
+from esphome.components.canbus import CanbusComponent
+from esphome.components.canbus_ext import FRAME_SOURCE_SCHEMA, register_frame_source
+
+CODEOWNERS = ["@leodesigner"]
+AUTO_LOAD = ["canbus_ext", "sensor"]
+
+CONF_INTERFACE = "interface"
+
+socketcan_ns = cg.esphome_ns.namespace("socketcan")
+SocketCAN = socketcan_ns.class_("SocketCAN", CanbusComponent)
+
+CONFIG_SCHEMA = cv.All(
+    canbus.CANBUS_SCHEMA.extend(
+        {
+            cv.GenerateID(): cv.declare_id(SocketCAN),
+            cv.Optional(CONF_INTERFACE, default="can0"): cv.string_strict,
+        }
+    ).extend(FRAME_SOURCE_SCHEMA),
+    cv.only_on(["host"]),
+)
+
+
+async def to_code(config):
+    var = cg.new_Pvariable(config[CONF_ID])
+    await canbus.register_canbus(var, config)
+    await register_frame_source(var, config)
+    cg.add(var.set_interface(config[CONF_INTERFACE]))
@@ -0,0 +1,202 @@
+#if defined(USE_HOST) && defined(__linux__)
+
+#include "socketcan.h"
+#include "esphome/core/log.h"
+
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <linux/can.h>
+#include <linux/can/raw.h>
+#include <net/if.h>
+#include <sys/ioctl.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+namespace esphome {
+namespace socketcan {
+
+static const char *const TAG = "socketcan";
+
+static void to_can_frame(const canbus::CanFrame &frame, struct can_frame *out) {
+  memset(out, 0, sizeof(*out));
+  out->can_id = frame.use_extended_id ? (frame.can_id & CAN_EFF_MASK) | CAN_EFF_FLAG : frame.can_id & CAN_SFF_MASK;
+  if (frame.remote_transmission_request)
+    out->can_id |= CAN_RTR_FLAG;
+  out->can_dlc = frame.can_data_length_code;
+  memcpy(out->data, frame.data, frame.can_data_length_code);
+}
+
+static void from_can_frame(const struct can_frame &in, canbus::CanFrame *frame) {
+  frame->use_extended_id = (in.can_id & CAN_EFF_FLAG) != 0;
+  frame->remote_transmission_request = (in.can_id & CAN_RTR_FLAG) != 0;
+  frame->can_id = in.can_id & (frame->use_extended_id ? CAN_EFF_MASK : CAN_SFF_MASK);
+  frame->can_data_length_code = in.can_dlc > canbus::CAN_MAX_DATA_LENGTH ? canbus::CAN_MAX_DATA_LENGTH : in.can_dlc;
+  memcpy(frame->data, in.data, frame->can_data_length_code);
+}
+
+bool SocketCAN::setup_internal() {
+  this->fd_ = ::socket(PF_CAN, SOCK_RAW | SOCK_NONBLOCK, CAN_RAW);
+  if (this->fd_ < 0) {
+    ESP_LOGE(TAG, "socket() failed: %s", strerror(errno));
+    return false;
+  }
+
+  struct ifreq ifr;
+  memset(&ifr, 0, sizeof(ifr));
+  strncpy(ifr.ifr_name, this->interface_.c_str(), IFNAMSIZ - 1);
+  if (::ioctl(this->fd_, SIOCGIFINDEX, &ifr) < 0) {
+    ESP_LOGE(TAG, "Unknown CAN interface %s: %s", this->interface_.c_str(), strerror(errno));
+    ::close(this->fd_);
+    this->fd_ = -1;
+    return false;
+  }
+
+  struct sockaddr_can addr;
+  memset(&addr, 0, sizeof(addr));
+  addr.can_family = AF_CAN;
+  addr.can_ifindex = ifr.ifr_ifindex;
+  if (::bind(this->fd_, (struct sockaddr *) &addr, sizeof(addr)) < 0) {
+    ESP_LOGE(TAG, "bind() to %s failed: %s", this->interface_.c_str(), strerror(errno));
+    ::close(this->fd_);
+    this->fd_ = -1;
+    return false;
+  }
+
+  // kernel receive time on every frame, see read_messages()
+  int on = 1;
+  if (::setsockopt(this->fd_, SOL_SOCKET, SO_TIMESTAMP, &on, sizeof(on)) < 0)
+    ESP_LOGW(TAG, "SO_TIMESTAMP not available: %s", strerror(errno));
+  return true;
+}
+
+void SocketCAN::dump_config() {
+  ESP_LOGCONFIG(TAG, "SocketCAN:");
+  ESP_LOGCONFIG(TAG, "  Interface: %s", this->interface_.c_str());
+  ESP_LOGCONFIG(TAG, "  Bit rate is taken from the interface configuration");
+}
+
+canbus::Error SocketCAN::send_message(struct canbus::CanFrame *frame) {
+  if (this->fd_ < 0 || frame->can_data_length_code > canbus::CAN_MAX_DATA_LENGTH)
+    return canbus::ERROR_FAILTX;
+  if (this->tx_count_ == TX_QUEUE && this->flush_tx() == 0)
+    return canbus::ERROR_ALLTXBUSY;
+  this->tx_queue_[this->tx_count_++] = *frame;
+  return canbus::ERROR_OK;
+}
+
+// Writes the queued frames with a single sendmmsg(), frames the socket did not take stay queued
+size_t SocketCAN::flush_tx() {
+  if (this->tx_count_ == 0)
+    return 0;
+
+  struct can_frame frames[TX_QUEUE];
+  struct iovec iov[TX_QUEUE];
+  struct mmsghdr msgs[TX_QUEUE];
+  memset(msgs, 0, sizeof(msgs));
+  for (size_t i = 0; i < this->tx_count_; i++) {
+    to_can_frame(this->tx_queue_[i], &frames[i]);
+    iov[i].iov_base = &frames[i];
+    iov[i].iov_len = sizeof(frames[i]);
+    msgs[i].msg_hdr.msg_iov = &iov[i];
+    msgs[i].msg_hdr.msg_iovlen = 1;
+  }
+
+  int sent = ::sendmmsg(this->fd_, msgs, this->tx_count_, MSG_DONTWAIT);
+  if (sent < 0) {
+    if (errno != EAGAIN && errno != ENOBUFS) {
+      // the interface rejected the batch (down, bus-off), do not retry it forever
+      ESP_LOGW(TAG, "sendmmsg() failed: %s, dropping %u frames", strerror(errno), this->tx_count_);
+      this->tx_dropped_ += this->tx_count_;
+      this->tx_count_ = 0;
+    }
+    return 0;
+  }
+
+  for (int i = 0; i < sent; i++)
+    this->account_frame_(this->tx_queue_[i]);
+  memmove(&this->tx_queue_[0], &this->tx_queue_[sent], (this->tx_count_ - sent) * sizeof(canbus::CanFrame));
+  this->tx_count_ -= sent;
+  return sent;
+}
+
+size_t SocketCAN::read_messages(struct canbus::CanFrame *frames, size_t max_frames, uint32_t *timestamps_us) {
+  if (this->fd_ < 0)
+    return 0;
+  if (max_frames > RX_BATCH)
+    max_frames = RX_BATCH;
+
+  struct can_frame raw[RX_BATCH];
+  struct iovec iov[RX_BATCH];
+  struct mmsghdr msgs[RX_BATCH];
+  char control[RX_BATCH][CMSG_SPACE(sizeof(struct timeval))];
+  memset(msgs, 0, sizeof(msgs));
+  for (size_t i = 0; i < max_frames; i++) {
+    iov[i].iov_base = &raw[i];
+    iov[i].iov_len = sizeof(raw[i]);
+    msgs[i].msg_hdr.msg_iov = &iov[i];
+    msgs[i].msg_hdr.msg_iovlen = 1;
+    msgs[i].msg_hdr.msg_control = control[i];
+    msgs[i].msg_hdr.msg_controllen = sizeof(control[i]);
+  }
+
+  int received = ::recvmmsg(this->fd_, msgs, max_frames, MSG_DONTWAIT, nullptr);
+  if (received <= 0)
+    return 0;
+
+  // kernel timestamps are wall clock, carry them over to micros() through their age
+  uint32_t now_us = micros();
+  struct timeval now;
+  ::gettimeofday(&now, nullptr);
+
+  size_t count = 0;
+  for (int i = 0; i < received; i++) {
+    if (msgs[i].msg_len < sizeof(struct can_frame) || (raw[i].can_id & CAN_ERR_FLAG))
+      continue;
+    if (timestamps_us != nullptr) {
+      int64_t age_us = 0;
+      for (struct cmsghdr *cmsg = CMSG_FIRSTHDR(&msgs[i].msg_hdr); cmsg != nullptr;
+           cmsg = CMSG_NXTHDR(&msgs[i].msg_hdr, cmsg)) {
+        if (cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SCM_TIMESTAMP) {
+          struct timeval tv;
+          memcpy(&tv, CMSG_DATA(cmsg), sizeof(tv));
+          age_us = (int64_t) (now.tv_sec - tv.tv_sec) * 1000000 + (now.tv_usec - tv.tv_usec);
+        }
+      }
+      timestamps_us[count] = now_us - (uint32_t) (age_us > 0 ? age_us : 0);
+    }
+    from_can_frame(raw[i], &frames[count]);
+    this->account_frame_(frames[count++]);
+  }
+  return count;
+}
+
+// Only hands out the batch loop() drained, loop() is the only reader of the socket
+canbus::Error SocketCAN::read_message(struct canbus::CanFrame *frame) {
+  if (this->rx_pending_pos_ >= this->rx_pending_count_)
+    return canbus::ERROR_NOMSG;
+  *frame = this->rx_pending_[this->rx_pending_pos_++];
+  return canbus::ERROR_OK;
+}
+
+void SocketCAN::loop() {
+  this->update_bus_load_(millis());
+  this->flush_tx();
+
+  this->rx_pending_count_ = this->read_messages(this->rx_pending_, RX_BATCH, this->rx_timestamps_);
+  this->rx_pending_pos_ = 0;
+  if (this->rx_pending_count_ == 0)
+    return;
+
+  this->dispatch_frames_(this->rx_pending_, this->rx_timestamps_, this->rx_pending_count_);
+
+  // Canbus::loop() handles one frame per call and fetches it through read_message()
+  while (this->rx_pending_pos_ < this->rx_pending_count_)
+    canbus::Canbus::loop();
+}
+
+}  // namespace socketcan
+}  // namespace esphome
+
+#endif  // USE_HOST && __linux__
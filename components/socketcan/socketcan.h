@@ -0,0 +1,50 @@
+#pragma once
+
+#include "esphome/components/canbus/canbus.h"
+#include "esphome/components/canbus_ext/canbus_ext.h"
+#include "esphome/core/component.h"
+
+#include <string>
+
+namespace esphome {
+namespace socketcan {
+
+// frames moved per recvmmsg() / sendmmsg() call
+static const size_t RX_BATCH = 16;
+static const size_t TX_QUEUE = 16;
+
+// Linux SocketCAN backend (can0, vcan0, slcan0, ...). The bit rate belongs to the interface and is set
+// with `ip link set can0 type can bitrate 125000`; bit_rate in the YAML must match it; it is
+// only used for logging and bus load accounting.
+class SocketCAN : public canbus::Canbus, public canbus_ext::FrameSource {
+ public:
+  void set_interface(const std::string &interface) { this->interface_ = interface; }
+  void loop() override;
+  void dump_config() override;
+  uint32_t get_bit_rate_bps() const override { return canbus_ext::speed_to_bps(this->bit_rate_); }
+
+  size_t read_messages(struct canbus::CanFrame *frames, size_t max_frames, uint32_t *timestamps_us = nullptr);
+  size_t flush_tx();
+
+ protected:
+  std::string interface_;
+  int fd_{-1};
+
+  bool setup_internal() override;
+  canbus::Error send_message(struct canbus::CanFrame *frame) override;
+  canbus::Error read_message(struct canbus::CanFrame *frame) override;
+
+  // frames drained by loop(), handed to the canbus triggers through read_message()
+  canbus::CanFrame rx_pending_[RX_BATCH];
+  uint32_t rx_timestamps_[RX_BATCH];
+  uint8_t rx_pending_count_{0};
+  uint8_t rx_pending_pos_{0};
+
+  // frames queued by send_message(), written with one sendmmsg() per loop or when full
+  canbus::CanFrame tx_queue_[TX_QUEUE];
+  uint8_t tx_count_{0};
+  uint32_t tx_dropped_{0};
+};
+
+}  // namespace socketcan
+}  // namespace esphome
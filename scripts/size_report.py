@@ -0,0 +1,183 @@
+#!/usr/bin/env python3
+"""Flash / RAM footprint of the components at two git revisions.
+
+Builds each config with `esphome compile` against the components of the baseline revision and of the working
+tree, and prints the sizes PlatformIO reports as JSON and as a markdown table. Example, for the compile-time
+sensor stripping:
+
+    scripts/size_report.py --baseline c6c10ed~1 emerson_r48_example.yaml
+
+Needs esphome on the PATH; the !secret values of the configs are filled with placeholders.
+
+Without an ESPHome toolchain, --host compiles emerson_r48.cpp of each revision with the host compiler against
+tests/shim instead, with the USE_EMERSON_R48_* defines the config's sensors and numbers would emit. It reports
+the text / data / bss of that object and sizeof(EmersonR48Component), which ESPHome allocates on the heap. The
+absolute numbers are x86-64 ones; the differences between revisions and configs carry over, not the totals.
+
+    scripts/size_report.py --host --baseline c6c10ed~1 --revision c6c10ed emerson_r48_example.yaml
+"""
+
+import argparse
+import json
+import os
+import re
+import shutil
+import subprocess
+import sys
+import tempfile
+from pathlib import Path
+
+import yaml
+
+REPO = Path(__file__).resolve().parent.parent
+SOURCE_RE = re.compile(r"^(\s*)- source: github://leodesigner/esphome-emerson-vertiv-r48.*$", re.MULTILINE)
+SECRET_RE = re.compile(r"!secret\s+(\w+)")
+# PlatformIO: "RAM:   [====      ]  41.2% (used 33748 bytes from 81920 bytes)"
+SIZE_RE = re.compile(r"^(RAM|Flash):.*\(used (\d+) bytes from (\d+) bytes\)", re.MULTILINE)
+SHIM = REPO / "tests" / "shim"
+HOST_PROBE = """#include "esphome/components/emerson_r48/emerson_r48.h"
+#include <cstdio>
+int main() { std::printf("%zu\\n", sizeof(esphome::emerson_r48::EmersonR48Component)); }
+"""
+
+
+def export_components(ref, dest):
+    """Component tree of a revision, None for the working tree."""
+    if (dest / "components").exists():
+        return
+    if ref is None:
+        shutil.copytree(REPO / "components", dest / "components")
+        return
+    archive = subprocess.run(
+        ["git", "-C", str(REPO), "archive", ref, "components"], check=True, capture_output=True
+    ).stdout
+    subprocess.run(["tar", "-x", "-C", str(dest)], input=archive, check=True)
+
+
+def prepare_config(config, components, dest):
+    text = config.read_text()
+    if not SOURCE_RE.search(text):
+        sys.exit(f"{config}: no external_components source of this repository to replace")
+    text = SOURCE_RE.sub(
+        lambda m: f"{m.group(1)}- source:\n{m.group(1)}    type: local\n{m.group(1)}    path: {components}",
+        text,
+    )
+    secrets = sorted(set(SECRET_RE.findall(text)))
+    (dest / "secrets.yaml").write_text("".join(f'{name}: "placeholder"\n' for name in secrets))
+    target = dest / config.name
+    target.write_text(text)
+    return target
+
+
+class _AnyTagLoader(yaml.SafeLoader):
+    """!secret, !lambda and friends load as plain values, only the keys matter here."""
+
+
+_AnyTagLoader.add_multi_constructor("!", lambda loader, suffix, node: None)
+
+
+def config_defines(config):
+    """The USE_EMERSON_R48_*_SENSOR / _NUMBER defines sensor.py and number/__init__.py emit for a config."""
+    doc = yaml.load(config.read_text(), Loader=_AnyTagLoader) or {}
+    defines = []
+    for domain, suffix in (("sensor", "SENSOR"), ("number", "NUMBER")):
+        for entry in doc.get(domain) or []:
+            if not isinstance(entry, dict) or entry.get("platform") != "emerson_r48":
+                continue
+            defines += [f"-DUSE_EMERSON_R48_{key.upper()}_{suffix}" for key in entry if key != "platform"]
+    return sorted(set(defines))
+
+
+def build_host(config, ref, workdir, dry_run):
+    label = ref or "working tree"
+    tree = workdir / (ref or "worktree").replace("/", "_").replace("~", "_")
+    tree.mkdir(parents=True, exist_ok=True)
+    export_components(ref, tree)
+    include = tree / "include" / "esphome"
+    include.mkdir(parents=True, exist_ok=True)
+    if not (include / "components").exists():
+        (include / "components").symlink_to(tree / "components")
+    cxx = os.environ.get("CXX", "c++")
+    flags = ["-std=c++17", "-Os", "-DUSE_HOST", *config_defines(config), f"-I{tree / 'include'}", f"-I{SHIM}"]
+    obj = tree / f"{config.stem}.o"
+    compile_cmd = [cxx, *flags, "-c", str(tree / "components" / "emerson_r48" / "emerson_r48.cpp"), "-o", str(obj)]
+    (tree / "probe.cpp").write_text(HOST_PROBE)
+    sources = [tree / "probe.cpp", SHIM / "esphome_shim.cpp"]
+    if (tree / "components" / "canbus_ext" / "canbus_ext.cpp").exists():
+        sources.append(tree / "components" / "canbus_ext" / "canbus_ext.cpp")
+    probe = tree / f"{config.stem}_probe"
+    probe_cmd = [cxx, *flags, *map(str, sources), str(obj), "-o", str(probe)]
+    if dry_run:
+        print("would run:", " ".join(compile_cmd), file=sys.stderr)
+        print("would run:", " ".join(probe_cmd), file=sys.stderr)
+        return {"config": config.name, "revision": label}
+    for command in (compile_cmd, probe_cmd):
+        result = subprocess.run(command, capture_output=True, text=True)
+        if result.returncode != 0:
+            sys.stderr.write(result.stderr[-4000:])
+            sys.exit(f"{config.name} at {label}: host build failed")
+    # Berkeley format: text data bss dec hex filename
+    text, data, bss = (int(v) for v in subprocess.run(
+        ["size", str(obj)], check=True, capture_output=True, text=True
+    ).stdout.splitlines()[1].split()[:3])
+    component = int(subprocess.run([str(probe)], check=True, capture_output=True, text=True).stdout)
+    return {"config": config.name, "revision": label, "text": text, "data": data, "bss": bss, "component": component}
+
+
+def build(config, ref, workdir, dry_run):
+    label = ref or "working tree"
+    tree = workdir / (ref or "worktree").replace("/", "_").replace("~", "_")
+    tree.mkdir(parents=True, exist_ok=True)
+    export_components(ref, tree)
+    target = prepare_config(config, tree / "components", tree)
+    command = ["esphome", "compile", str(target)]
+    if dry_run:
+        print("would run:", " ".join(command), file=sys.stderr)
+        return {"config": config.name, "revision": label}
+    result = subprocess.run(command, capture_output=True, text=True)
+    if result.returncode != 0:
+        sys.stderr.write(result.stdout[-4000:] + result.stderr[-4000:])
+        sys.exit(f"{config.name} at {label}: build failed")
+    sizes = {kind.lower(): int(used) for kind, used, _ in SIZE_RE.findall(result.stdout)}
+    if "ram" not in sizes or "flash" not in sizes:
+        sys.exit(f"{config.name} at {label}: no size summary in the build output")
+    return {"config": config.name, "revision": label, **sizes}
+
+
+def print_table(rows, columns):
+    print("| config | revision | " + " | ".join(f"{c} (B)" for c in columns) + " | "
+          + " | ".join(f"{c} delta" for c in columns) + " |")
+    print("|---|---|" + "---:|" * (2 * len(columns)))
+    for before, after in zip(rows[::2], rows[1::2]):
+        for row in (before, after):
+            values = " | ".join(str(row[c]) for c in columns)
+            deltas = " | ".join(f"{row[c] - before[c]:+d}" for c in columns)
+            print(f"| {row['config']} | {row['revision']} | {values} | {deltas} |")
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("--baseline", required=True, help="git revision to compare against")
+    parser.add_argument("--revision", help="git revision to compare, default the working tree")
+    parser.add_argument("--host", action="store_true", help="host object sizes against tests/shim, no esphome")
+    parser.add_argument("--dry-run", action="store_true", help="prepare the trees, print the build commands")
+    parser.add_argument("configs", nargs="+", type=Path)
+    args = parser.parse_args()
+
+    measure = build_host if args.host else build
+    rows = []
+    with tempfile.TemporaryDirectory(prefix="r48-size-") as tmp:
+        for config in args.configs:
+            config = config.resolve()
+            before = measure(config, args.baseline, Path(tmp) / config.stem, args.dry_run)
+            after = measure(config, args.revision, Path(tmp) / config.stem, args.dry_run)
+            rows += [before, after]
+    if args.dry_run:
+        return
+
+    print(json.dumps(rows, indent=2))
+    print()
+    print_table(rows, ["text", "data", "bss", "component"] if args.host else ["flash", "ram"])
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,82 @@
+// Host timing of the update() poll cycle of EmersonR48Component: ns per update() tick (read request or control
+// frame through the shim canbus) and per complete cycle including the decode and publication of every reply.
+// Registered as a test so that every run of the suite prints the numbers; it only fails if a result is wrong.
+
+#include "esphome/components/emerson_r48/emerson_r48.h"
+#include "esphome/core/log.h"
+#include "fake_canbus.h"
+#include "host_shim.h"
+#include "host_test.h"
+
+#include <chrono>
+
+using namespace esphome;
+using namespace esphome::emerson_r48;
+
+static const uint32_t CYCLES = 200000;
+static const uint32_t TICKS_PER_CYCLE = EMR48_POLL_LIST.count + 1;
+
+template<typename F> static double bench(const char *name, uint32_t per_iteration, F &&body) {
+  body(CYCLES / 10);  // warm up
+  auto start = std::chrono::steady_clock::now();
+  body(CYCLES);
+  auto elapsed = std::chrono::steady_clock::now() - start;
+  double ns = std::chrono::duration<double, std::nano>(elapsed).count() / CYCLES / per_iteration;
+  std::printf("%-28s %8.2f ns/op\n", name, ns);
+  return ns;
+}
+
+int main() {
+  // the stale warnings of the first run would swamp the numbers
+  host_shim::set_log_level(ESPHOME_LOG_LEVEL_ERROR);
+  FakeCanbus bus;
+  EmersonR48Component hub(&bus);
+  sensor::Sensor sensors[SENSOR_COUNT];
+  hub.set_frame_source(&bus);
+  hub.set_update_interval(1000);
+  hub.set_output_voltage_sensor(&sensors[SENSOR_OUTPUT_VOLTAGE]);
+  hub.set_output_current_sensor(&sensors[SENSOR_OUTPUT_CURRENT]);
+  hub.set_max_output_current_sensor(&sensors[SENSOR_MAX_OUTPUT_CURRENT]);
+  hub.set_output_temp_sensor(&sensors[SENSOR_OUTPUT_TEMP]);
+  hub.set_input_voltage_sensor(&sensors[SENSOR_INPUT_VOLTAGE]);
+  hub.setup();
+  for (int i = 0; i < 20; i++) {
+    hub.loop();
+    host_shim::advance_ms(10);
+  }
+  bus.sent.reserve(TICKS_PER_CYCLE);
+
+  // requests only: nobody answers, the sensors go stale after ten intervals and stay so
+  bench("update() tick", TICKS_PER_CYCLE, [&](uint32_t n) {
+    for (uint32_t c = 0; c < n; c++) {
+      for (uint32_t t = 0; t < TICKS_PER_CYCLE; t++) {
+        hub.update();
+        host_shim::advance_ms(1);
+      }
+      bus.sent.clear();
+    }
+  });
+
+  // every request answered right away, the way a rectifier on an idle bus does
+  uint8_t replies[EMR48_READ_PARAM_COUNT][EMR48_FRAME_LENGTH];
+  for (size_t i = 0; i < EMR48_READ_PARAM_COUNT; i++)
+    encode_data_reply(read_param(i).id, 50.0f + i, replies[i]);
+  const uint32_t before = hub.get_snapshot().sequence;
+  bench("poll cycle with replies", 1, [&](uint32_t n) {
+    for (uint32_t c = 0; c < n; c++) {
+      for (uint32_t t = 0; t < TICKS_PER_CYCLE; t++) {
+        hub.update();
+        host_shim::advance_ms(1);
+        if (!bus.sent.empty() && bus.sent.back().can_id == CAN_ID_REQUEST) {
+          const uint8_t param = bus.sent.back().data[3];
+          bus.deliver(CAN_ID_DATA, replies[param_index(param, PARAM_READ)]);
+        }
+      }
+      bus.sent.clear();
+    }
+  });
+  // one snapshot per cycle, every value through
+  CHECK_EQ(hub.get_snapshot().sequence - before, CYCLES + CYCLES / 10);
+  CHECK_EQ(sensors[SENSOR_INPUT_VOLTAGE].state, 50.0f + param_index(EMR48_DATA_OUTPUT_IV, PARAM_READ));
+  return HOST_TEST_RESULT();
+}
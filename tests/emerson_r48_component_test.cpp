@@ -0,0 +1,421 @@
+// Host test of EmersonR48Component against the ESPHome shim in tests/shim: the frames the setters send, the boot
+// sequence, the update() poll cycle and the receive path into sensors, snapshot and statistics.
+
+#include "esphome/components/emerson_r48/emerson_r48.h"
+#include "esphome/core/log.h"
+#include "fake_canbus.h"
+#include "host_shim.h"
+#include "host_test.h"
+
+#include <cstring>
+#include <memory>
+
+using namespace esphome;
+using namespace esphome::emerson_r48;
+
+static const uint32_t UPDATE_INTERVAL_MS = 1000;
+static const uint32_t RESTORE_KEY = 0x52343800;
+
+struct Rig {
+  FakeCanbus bus;
+  EmersonR48Component hub{&bus};
+  sensor::Sensor sensors[SENSOR_COUNT];
+  sensor::Sensor poll_time;
+  sensor::Sensor missed_replies;
+  sensor::Sensor setpoint_latency;
+  number::Number output_voltage_number;
+  number::Number max_output_current_number;
+  number::Number max_input_current_number;
+  switch_::Switch ac_switch;
+
+  explicit Rig(bool frame_source = true, uint32_t restore_key = 0) {
+    if (frame_source)
+      this->hub.set_frame_source(&this->bus);
+    this->hub.set_restore_key(restore_key);
+    this->hub.set_update_interval(UPDATE_INTERVAL_MS);
+    this->hub.set_output_voltage_sensor(&this->sensors[SENSOR_OUTPUT_VOLTAGE]);
+    this->hub.set_output_current_sensor(&this->sensors[SENSOR_OUTPUT_CURRENT]);
+    this->hub.set_max_output_current_sensor(&this->sensors[SENSOR_MAX_OUTPUT_CURRENT]);
+    this->hub.set_output_temp_sensor(&this->sensors[SENSOR_OUTPUT_TEMP]);
+    this->hub.set_input_voltage_sensor(&this->sensors[SENSOR_INPUT_VOLTAGE]);
+    this->hub.set_poll_time_sensor(&this->poll_time);
+    this->hub.set_missed_replies_sensor(&this->missed_replies);
+    this->hub.set_setpoint_latency_sensor(&this->setpoint_latency);
+    this->hub.set_output_voltage_number(&this->output_voltage_number);
+    this->hub.set_max_output_current_number(&this->max_output_current_number);
+    this->hub.set_max_input_current_number(&this->max_input_current_number);
+    this->hub.set_ac_switch(&this->ac_switch);
+    this->hub.setup();
+  }
+
+  // runs loop() until the boot sequence has sent all of its frames
+  void boot() {
+    for (int i = 0; i < 20; i++) {
+      this->hub.loop();
+      host_shim::advance_ms(10);
+    }
+  }
+
+  // one update() tick and the update_interval after it
+  void tick() {
+    this->hub.update();
+    host_shim::advance_ms(UPDATE_INTERVAL_MS);
+  }
+
+  const canbus::CanFrame &last() const { return this->bus.sent.back(); }
+};
+
+static bool frame_is(const canbus::CanFrame &frame, uint32_t can_id, const uint8_t *data) {
+  return frame.use_extended_id && !frame.remote_transmission_request && frame.can_id == can_id &&
+         frame.can_data_length_code == EMR48_FRAME_LENGTH && memcmp(frame.data, data, EMR48_FRAME_LENGTH) == 0;
+}
+
+static void test_poll_list() {
+  // the five readable parameters all have their sensor configured in this build, in table order
+  CHECK_EQ(EMR48_POLL_LIST.count, 5);
+  CHECK_EQ(EMR48_PARAMS[EMR48_POLL_LIST.index[0]].id, EMR48_DATA_OUTPUT_V);
+  CHECK_EQ(EMR48_PARAMS[EMR48_POLL_LIST.index[4]].id, EMR48_DATA_OUTPUT_IV);
+  CHECK_EQ(EMR48_SENSOR_INDEX.count, 6);  // + input power, configured but not polled
+}
+
+static void test_set_output_voltage() {
+  Rig rig;
+  uint8_t expected[EMR48_FRAME_LENGTH];
+
+  rig.hub.set_output_voltage(53.5f);
+  CHECK_EQ(rig.bus.sent.size(), 1u);
+  encode_output_voltage(53.5f, false, expected);
+  CHECK(frame_is(rig.last(), CAN_ID_SET, expected));
+  CHECK_EQ(rig.last().data[3], EMR48_SET_OUTPUT_V_ONLINE);
+  CHECK_EQ(rig.output_voltage_number.state, 53.5f);
+  CHECK_EQ(rig.hub.get_setpoints().output_voltage, 53.5f);
+
+  rig.hub.set_output_voltage(48.0f, true);
+  CHECK_EQ(rig.bus.sent.size(), 2u);
+  encode_output_voltage(48.0f, true, expected);
+  CHECK(frame_is(rig.last(), CAN_ID_SET, expected));
+  CHECK_EQ(rig.last().data[3], EMR48_SET_OUTPUT_V_OFFLINE);
+
+  // out of range and NAN: nothing is sent, the setpoint and the number keep the last value
+  rig.hub.set_output_voltage(60.0f);
+  rig.hub.set_output_voltage(40.0f);
+  rig.hub.set_output_voltage(NAN);
+  CHECK_EQ(rig.bus.sent.size(), 2u);
+  CHECK_EQ(rig.output_voltage_number.state, 48.0f);
+  CHECK_EQ(rig.hub.get_setpoints().output_voltage, 48.0f);
+}
+
+static void test_set_max_output_current() {
+  Rig rig;
+  uint8_t expected[EMR48_FRAME_LENGTH];
+
+  rig.hub.set_max_output_current(50.0f);
+  CHECK_EQ(rig.bus.sent.size(), 1u);
+  encode_max_output_current(50.0f, false, expected);
+  CHECK(frame_is(rig.last(), CAN_ID_SET, expected));
+  CHECK_EQ(rig.last().data[3], EMR48_SET_OUTPUT_AL_ONLINE);
+  CHECK_EQ(bytearray_to_float(&rig.last().data[4]), 0.5f);  // percent on the API, a fraction on the wire
+  CHECK_EQ(rig.max_output_current_number.state, 50.0f);
+
+  rig.hub.set_max_output_current(121.0f, true);
+  encode_max_output_current(121.0f, true, expected);
+  CHECK(frame_is(rig.last(), CAN_ID_SET, expected));
+  CHECK_EQ(rig.last().data[3], EMR48_SET_OUTPUT_AL_OFFLINE);
+
+  rig.hub.set_max_output_current(9.0f);
+  rig.hub.set_max_output_current(122.0f);
+  CHECK_EQ(rig.bus.sent.size(), 2u);
+  CHECK_EQ(rig.hub.get_setpoints().max_output_current, 121.0f);
+}
+
+static void test_set_max_input_current() {
+  Rig rig;
+  uint8_t expected[EMR48_FRAME_LENGTH];
+
+  rig.hub.set_max_input_current(12.5f);
+  CHECK_EQ(rig.bus.sent.size(), 1u);
+  encode_max_input_current(12.5f, expected);
+  CHECK(frame_is(rig.last(), CAN_ID_SET, expected));
+  CHECK_EQ(rig.last().data[3], EMR48_SET_INPUT_AL);
+  CHECK_EQ(rig.max_input_current_number.state, 12.5f);
+
+  rig.hub.set_max_input_current(-1.0f);
+  rig.hub.set_max_input_current(NAN);
+  CHECK_EQ(rig.bus.sent.size(), 1u);
+  CHECK_EQ(rig.hub.get_setpoints().max_input_current, 12.5f);
+}
+
+static void test_set_control() {
+  Rig rig;
+  uint8_t expected[EMR48_FRAME_LENGTH];
+
+  rig.hub.set_control(0x85);
+  encode_control(0x85, expected);
+  CHECK(frame_is(rig.last(), CAN_ID_SET_CTL, expected));
+
+  // the flags end up in the control byte and on the switches
+  rig.hub.set_control_flags(true, false, true, false);
+  CHECK_EQ(rig.bus.sent.size(), 2u);
+  const uint8_t bits = encode_control_bits(false, true, false, true);
+  CHECK_EQ(rig.hub.control_bits(), bits);
+  encode_control(bits, expected);
+  CHECK(frame_is(rig.last(), CAN_ID_SET_CTL, expected));
+  CHECK(rig.ac_switch.state);
+  CHECK_EQ(rig.ac_switch.publish_count, 1u);
+  // unchanged switch states are not published again
+  rig.hub.set_control_flags(true, false, true, false);
+  CHECK_EQ(rig.ac_switch.publish_count, 1u);
+}
+
+static void test_startup_sequence() {
+  Rig rig;
+  // update() does nothing until the boot sequence is through
+  rig.hub.update();
+  CHECK(rig.bus.sent.empty());
+
+  rig.boot();
+  uint8_t control[EMR48_FRAME_LENGTH];
+  encode_control(rig.hub.control_bits(), control);
+  // no setpoints yet: sync, gimme5 and the control bits only
+  CHECK_EQ(rig.bus.sent.size(), 3u);
+  CHECK_EQ(rig.bus.sent[0].can_id, CAN_ID_SYNC);
+  CHECK_EQ(rig.bus.sent[1].can_id, CAN_ID_GIMME5);
+  CHECK_EQ(rig.bus.sent[1].data[0], 0x20);
+  CHECK(frame_is(rig.bus.sent[2], CAN_ID_SET_CTL, control));
+}
+
+// the restored setpoints go out with the boot sequence, the online ones are refreshed afterwards
+static void test_restored_setpoints() {
+  {
+    Rig first(true, RESTORE_KEY);
+    first.hub.set_output_voltage(52.0f);
+    first.hub.set_max_output_current(80.0f);
+    first.hub.set_max_input_current(10.0f);
+  }
+  // setpoints have to survive a power cycle, not only a soft reset
+  CHECK(global_preferences->find(RESTORE_KEY) != nullptr && global_preferences->find(RESTORE_KEY)->in_flash);
+  Rig rig(true, RESTORE_KEY);
+  CHECK_EQ(rig.output_voltage_number.state, 52.0f);
+  rig.boot();
+  CHECK_EQ(rig.bus.sent.size(), 6u);
+  uint8_t expected[EMR48_FRAME_LENGTH];
+  encode_output_voltage(52.0f, false, expected);
+  CHECK(frame_is(rig.bus.sent[3], CAN_ID_SET, expected));
+  encode_max_output_current(80.0f, false, expected);
+  CHECK(frame_is(rig.bus.sent[4], CAN_ID_SET, expected));
+  encode_max_input_current(10.0f, expected);
+  CHECK(frame_is(rig.bus.sent[5], CAN_ID_SET, expected));
+
+  rig.bus.sent.clear();
+  host_shim::advance_ms(EMR48_ONLINE_COMMAND_TIMEOUT_MS / 2);
+  rig.hub.loop();
+  CHECK_EQ(rig.bus.sent.size(), 2u);
+  global_preferences->clear();
+}
+
+// an offline setpoint is replayed offline and, holding by itself, never refreshed
+static void test_restored_offline_setpoints() {
+  {
+    Rig first(true, RESTORE_KEY);
+    first.hub.set_output_voltage(53.0f, true);
+    first.hub.set_max_output_current(60.0f);
+  }
+  Rig rig(true, RESTORE_KEY);
+  rig.boot();
+  CHECK_EQ(rig.bus.sent.size(), 5u);
+  uint8_t expected[EMR48_FRAME_LENGTH];
+  encode_output_voltage(53.0f, true, expected);
+  CHECK(frame_is(rig.bus.sent[3], CAN_ID_SET, expected));
+  encode_max_output_current(60.0f, false, expected);
+  CHECK(frame_is(rig.bus.sent[4], CAN_ID_SET, expected));
+
+  rig.bus.sent.clear();
+  host_shim::advance_ms(EMR48_ONLINE_COMMAND_TIMEOUT_MS / 2);
+  rig.hub.loop();
+  CHECK_EQ(rig.bus.sent.size(), 1u);
+  CHECK(frame_is(rig.last(), CAN_ID_SET, expected));
+  global_preferences->clear();
+}
+
+// one read request per update() in poll list order, then the control bits; the next tick starts over
+static void test_poll_cycle() {
+  Rig rig;
+  rig.boot();
+  rig.bus.sent.clear();
+
+  for (uint8_t i = 0; i < EMR48_POLL_LIST.count; i++) {
+    rig.tick();
+    uint8_t expected[EMR48_FRAME_LENGTH];
+    encode_read_request(EMR48_PARAMS[EMR48_POLL_LIST.index[i]].id, expected);
+    CHECK_EQ(rig.bus.sent.size(), i + 1u);
+    CHECK(frame_is(rig.last(), CAN_ID_REQUEST, expected));
+  }
+  rig.tick();
+  CHECK_EQ(rig.last().can_id, CAN_ID_SET_CTL);
+  rig.tick();
+  CHECK_EQ(rig.last().can_id, CAN_ID_REQUEST);
+  CHECK_EQ(rig.last().data[3], EMR48_PARAMS[EMR48_POLL_LIST.index[0]].id);
+  CHECK_EQ(rig.bus.sent.size(), EMR48_POLL_LIST.count + 2u);
+}
+
+// every hub keeps its own place in the cycle
+static void test_two_hubs() {
+  Rig a, b;
+  a.boot();
+  b.boot();
+  a.bus.sent.clear();
+  b.bus.sent.clear();
+  a.tick();
+  a.tick();
+  b.tick();
+  CHECK_EQ(a.last().data[3], EMR48_PARAMS[EMR48_POLL_LIST.index[1]].id);
+  CHECK_EQ(b.last().data[3], EMR48_PARAMS[EMR48_POLL_LIST.index[0]].id);
+}
+
+// max_age belongs to the polled parameters; on any other sensor it is a configuration error, not a silent no-op
+static void test_max_age() {
+  Rig rig;
+  host_shim::reset_log_counts();
+  rig.hub.set_max_age(SENSOR_OUTPUT_VOLTAGE, 30000);
+  CHECK_EQ(rig.hub.get_timing(EMR48_DATA_OUTPUT_V)->max_age_ms, 30000u);
+  CHECK_EQ(host_shim::log_count(ESPHOME_LOG_LEVEL_ERROR), 0u);
+  rig.hub.set_max_age(SENSOR_INPUT_POWER, 30000);
+  CHECK_EQ(host_shim::log_count(ESPHOME_LOG_LEVEL_ERROR), 1u);
+}
+
+// replies land on the sensors right away and in the snapshot once the cycle is complete
+static void test_handle_frame() {
+  Rig rig;
+  rig.boot();
+  uint32_t snapshots = 0;
+  rig.hub.add_on_snapshot_callback([&snapshots](const TelemetrySnapshot &) { snapshots++; });
+
+  static const float VALUES[] = {53.5f, 20.0f, 80.0f, 35.0f, 230.0f};
+  const uint32_t start = millis();
+  for (uint8_t i = 0; i < EMR48_POLL_LIST.count; i++) {
+    const ParamDef &param = EMR48_PARAMS[EMR48_POLL_LIST.index[i]];
+    rig.hub.update();
+    host_shim::advance_ms(20);
+    rig.bus.deliver_reply(param.id, VALUES[i]);
+    CHECK_NEAR(rig.sensors[param.sensor].state, VALUES[i], 1e-4);
+    CHECK_NEAR(rig.hub.get_latest().get(param.sensor), VALUES[i], 1e-4);
+    const ParamTiming *timing = rig.hub.get_timing(param.id);
+    CHECK(timing != nullptr && timing->count == 1);
+    CHECK_NEAR(timing->response_max_us, 20000, 1);  // request times are stamped odd, 0 means none
+    if (i + 1 < EMR48_POLL_LIST.count)
+      host_shim::advance_ms(UPDATE_INTERVAL_MS - 20);
+  }
+  CHECK_EQ(snapshots, 1u);
+  const TelemetrySnapshot &snapshot = rig.hub.get_snapshot();
+  CHECK_EQ(snapshot.sequence, 1u);
+  CHECK_NEAR(snapshot.get(SENSOR_OUTPUT_VOLTAGE), 53.5f, 1e-4);
+  CHECK_NEAR(snapshot.get(SENSOR_MAX_OUTPUT_CURRENT), 80.0f, 1e-3);
+  // sample times are when the driver received each reply, 20 ms after its request
+  CHECK_NEAR(snapshot.sample_ms[SENSOR_OUTPUT_VOLTAGE], start + 20, 1);
+  CHECK_NEAR(snapshot.sample_ms[SENSOR_INPUT_VOLTAGE], millis(), 1);
+  CHECK(std::isnan(snapshot.get(SENSOR_INPUT_POWER)));
+  CHECK_EQ(snapshot.sample_ms[SENSOR_INPUT_POWER], 0u);
+  // from the first request to the last reply
+  CHECK_EQ(rig.poll_time.state, float(millis() - start));
+
+  // foreign ids, short frames and unknown parameters are ignored
+  const uint32_t published = rig.sensors[SENSOR_OUTPUT_VOLTAGE].publish_count;
+  uint8_t data[EMR48_FRAME_LENGTH];
+  encode_data_reply(EMR48_DATA_OUTPUT_V, 40.0f, data);
+  rig.bus.deliver(CAN_ID_SET, data);
+  data[3] = 0x7F;
+  rig.bus.deliver(CAN_ID_DATA, data);
+  CHECK_EQ(rig.sensors[SENSOR_OUTPUT_VOLTAGE].publish_count, published);
+
+  // a reply that waited 30 ms in the driver's batch is dated when it arrived, not when it was decoded
+  rig.hub.update();  // control bits, the end of the first cycle
+  for (uint8_t i = 0; i < EMR48_POLL_LIST.count; i++) {
+    const ParamDef &param = EMR48_PARAMS[EMR48_POLL_LIST.index[i]];
+    rig.hub.update();
+    host_shim::advance_ms(50);
+    encode_data_reply(param.id, VALUES[i], data);
+    rig.bus.deliver(CAN_ID_DATA, data, micros() - 30000);
+  }
+  CHECK_EQ(rig.hub.get_snapshot().sequence, 2u);
+  CHECK_NEAR(rig.hub.get_snapshot().sample_ms[SENSOR_INPUT_VOLTAGE], millis() - 30, 1);
+
+  // a cycle without replies is counted when the one after starts: control bits, the requests, control bits
+  for (uint8_t i = 0; i < EMR48_POLL_LIST.count + 2; i++)
+    rig.tick();
+  rig.hub.update();
+  CHECK_EQ(rig.missed_replies.state, float(EMR48_POLL_LIST.count));
+}
+
+static void test_setpoint_latency() {
+  Rig rig;
+  rig.boot();
+  rig.hub.set_output_voltage(50.0f);
+  host_shim::advance_ms(300);
+  rig.bus.deliver_reply(EMR48_DATA_OUTPUT_V, 53.5f);  // not there yet
+  CHECK(std::isnan(rig.setpoint_latency.state));
+  host_shim::advance_ms(200);
+  rig.bus.deliver_reply(EMR48_DATA_OUTPUT_V, 50.05f);
+  CHECK_EQ(rig.setpoint_latency.state, 500.0f);
+}
+
+// without a frame source the replies come through the catch-all canbus trigger
+static void test_trigger_path() {
+  Rig rig(false);
+  uint8_t data[EMR48_FRAME_LENGTH];
+  encode_data_reply(EMR48_DATA_OUTPUT_T, 41.0f, data);
+  rig.bus.queue_rx(CAN_ID_DATA, data);
+  rig.bus.loop();
+  CHECK_EQ(rig.sensors[SENSOR_OUTPUT_TEMP].state, 41.0f);
+}
+
+static void test_read_parameter() {
+  Rig rig;
+  rig.boot();
+  rig.bus.sent.clear();
+  float result = 0;
+  CHECK(rig.hub.read_parameter(0x30, [&result](uint8_t, float value) { result = value; }));
+  CHECK_EQ(rig.bus.sent.size(), 1u);
+  CHECK_EQ(rig.last().data[3], 0x30);
+  rig.bus.deliver_reply(EMR48_DATA_OUTPUT_V, 1.0f);  // some other reply
+  CHECK_EQ(result, 0.0f);
+  uint8_t data[EMR48_FRAME_LENGTH];
+  encode_set_parameter(0x30, 7.0f, data);
+  data[0] = 0x41;
+  rig.bus.deliver(CAN_ID_DATA, data);
+  CHECK_EQ(result, 7.0f);
+
+  // no reply within EMR48_READ_TIMEOUT_MS: NAN
+  CHECK(rig.hub.read_parameter(0x31, [&result](uint8_t, float value) { result = value; }));
+  host_shim::advance_ms(EMR48_READ_TIMEOUT_MS + 10);
+  rig.hub.loop();
+  CHECK(std::isnan(result));
+
+  // a parameter sensor whose read the hub cannot take publishes NAN and says why
+  EmersonR48ParameterSensor sensor(&rig.hub, 0x32);
+  sensor.publish_state(1.0f);
+  for (uint8_t i = 0; i < EMR48_MAX_PENDING_READS; i++)
+    CHECK(rig.hub.read_parameter(0x40 + i, [](uint8_t, float) {}));
+  host_shim::reset_log_counts();
+  sensor.update();
+  CHECK(std::isnan(sensor.state));
+  CHECK_EQ(host_shim::log_count(ESPHOME_LOG_LEVEL_WARN), 1u);
+}
+
+int main() {
+  test_poll_list();
+  test_set_output_voltage();
+  test_set_max_output_current();
+  test_set_max_input_current();
+  test_set_control();
+  test_startup_sequence();
+  test_restored_setpoints();
+  test_restored_offline_setpoints();
+  test_poll_cycle();
+  test_two_hubs();
+  test_max_age();
+  test_handle_frame();
+  test_setpoint_latency();
+  test_trigger_path();
+  test_read_parameter();
+  return HOST_TEST_RESULT();
+}
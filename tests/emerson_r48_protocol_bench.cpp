@@ -0,0 +1,69 @@
+// Host timing of the codec hot paths: ns per call of the setpoint encoder and the reply decoder.
+// Registered as a test so that every run of the suite prints the numbers; it only fails if a result is wrong.
+
+#include "esphome/components/emerson_r48_protocol/emerson_r48_protocol.h"
+#include "host_test.h"
+
+#include <chrono>
+
+using namespace esphome::emerson_r48;
+
+static const uint32_t ITERATIONS = 2000000;
+
+template<typename F> static void bench(const char *name, F &&body) {
+  body(ITERATIONS / 10);  // warm up
+  auto start = std::chrono::steady_clock::now();
+  body(ITERATIONS);
+  auto elapsed = std::chrono::steady_clock::now() - start;
+  double ns = std::chrono::duration<double, std::nano>(elapsed).count() / ITERATIONS;
+  std::printf("%-28s %8.2f ns/op\n", name, ns);
+}
+
+int main() {
+  uint8_t frames[EMR48_READ_PARAM_COUNT][EMR48_FRAME_LENGTH];
+  for (size_t i = 0; i < EMR48_READ_PARAM_COUNT; i++)
+    encode_data_reply(read_param(i).id, 1.0f + i, frames[i]);
+
+  volatile float sink = 0;
+  bench("decode_data_frame", [&](uint32_t n) {
+    float sum = 0;
+    for (uint32_t i = 0; i < n; i++) {
+      float value;
+      if (decode_data_frame(CAN_ID_DATA, frames[i % EMR48_READ_PARAM_COUNT], EMR48_FRAME_LENGTH, &value) != nullptr)
+        sum += value;
+    }
+    sink = sum;
+  });
+  CHECK(sink > 0);
+
+  volatile uint8_t byte_sink = 0;
+  bench("encode_output_voltage", [&](uint32_t n) {
+    uint8_t data[EMR48_FRAME_LENGTH]{};
+    uint8_t acc = 0;
+    for (uint32_t i = 0; i < n; i++) {
+      encode_output_voltage(EMR48_OUTPUT_VOLTAGE_MIN + (i & 15), (i & 1) != 0, data);
+      acc ^= data[5];
+    }
+    byte_sink = acc;
+  });
+  bench("encode_max_output_current", [&](uint32_t n) {
+    uint8_t data[EMR48_FRAME_LENGTH]{};
+    uint8_t acc = 0;
+    for (uint32_t i = 0; i < n; i++) {
+      encode_max_output_current(EMR48_OUTPUT_CURRENT_RATED_PERCENTAGE_MIN + (i & 63), false, data);
+      acc ^= data[5];
+    }
+    byte_sink = acc;
+  });
+  bench("encode_control", [&](uint32_t n) {
+    uint8_t data[EMR48_FRAME_LENGTH]{};
+    uint8_t acc = 0;
+    for (uint32_t i = 0; i < n; i++) {
+      encode_control(encode_control_bits(i & 1, i & 2, i & 4, i & 8), data);
+      acc ^= data[2];
+    }
+    byte_sink = acc;
+  });
+  (void) byte_sink;
+  return HOST_TEST_RESULT();
+}
@@ -0,0 +1,160 @@
+// Host test of the Emerson R48 codec: wire layout of every encoder, the decoders and the byte order.
+
+#include "esphome/components/emerson_r48_protocol/emerson_r48_protocol.h"
+#include "host_test.h"
+
+#include <cstring>
+#include <initializer_list>
+#include <limits>
+
+using namespace esphome::emerson_r48;
+
+static bool frame_equals(const uint8_t *data, const uint8_t (&expected)[EMR48_FRAME_LENGTH]) {
+  return memcmp(data, expected, EMR48_FRAME_LENGTH) == 0;
+}
+
+static void test_float_byte_order() {
+  uint8_t bytes[4];
+  float_to_bytearray(53.5f, bytes);  // 0x42560000, most significant byte first
+  CHECK_EQ(bytes[0], 0x42);
+  CHECK_EQ(bytes[1], 0x56);
+  CHECK_EQ(bytes[2], 0x00);
+  CHECK_EQ(bytes[3], 0x00);
+  float_to_bytearray(-1.5f, bytes);  // 0xBFC00000
+  CHECK_EQ(bytes[0], 0xBF);
+  CHECK_EQ(bytes[1], 0xC0);
+
+  const uint8_t pi[4] = {0x40, 0x49, 0x0F, 0xDB};
+  CHECK_EQ(bytearray_to_float(pi), 3.14159274f);
+  for (float value : {0.0f, 1.0f, 41.0f, 58.5f, 0.121f, -273.15f, 1e-20f}) {
+    float_to_bytearray(value, bytes);
+    CHECK_EQ(bytearray_to_float(bytes), value);
+  }
+}
+
+static void test_read_request() {
+  uint8_t data[EMR48_FRAME_LENGTH]{};
+  encode_read_request(EMR48_DATA_OUTPUT_A, data);
+  CHECK(frame_equals(data, {0x01, 0xF0, 0x00, 0x02, 0x00, 0x00, 0x00, 0x00}));
+}
+
+static void test_encode_parameter() {
+  uint8_t data[EMR48_FRAME_LENGTH]{};
+  CHECK(encode_parameter<EMR48_SET_OUTPUT_V_ONLINE>(53.5f, data));
+  CHECK(frame_equals(data, {0x03, 0xF0, 0x00, 0x21, 0x42, 0x56, 0x00, 0x00}));
+  CHECK(encode_parameter<EMR48_SET_OUTPUT_V_OFFLINE>(EMR48_OUTPUT_VOLTAGE_MIN, data));
+  CHECK_EQ(data[3], 0x24);
+  CHECK(encode_parameter<EMR48_SET_OUTPUT_V_OFFLINE>(EMR48_OUTPUT_VOLTAGE_MAX, data));
+
+  // out of range and NAN leave the frame untouched
+  uint8_t untouched[EMR48_FRAME_LENGTH];
+  memset(untouched, 0xAA, sizeof(untouched));
+  memcpy(data, untouched, sizeof(data));
+  CHECK(!encode_parameter<EMR48_SET_OUTPUT_V_ONLINE>(40.99f, data));
+  CHECK(!encode_parameter<EMR48_SET_OUTPUT_V_ONLINE>(58.51f, data));
+  CHECK(!encode_parameter<EMR48_SET_OUTPUT_V_ONLINE>(std::numeric_limits<float>::quiet_NaN(), data));
+  CHECK(!encode_parameter<EMR48_SET_OUTPUT_AL_ONLINE>(9.9f, data));
+  CHECK(!encode_parameter<EMR48_SET_OUTPUT_AL_ONLINE>(121.1f, data));
+  CHECK(memcmp(data, untouched, sizeof(data)) == 0);
+
+  // current limits are percent in the API and a fraction on the wire
+  CHECK(encode_parameter<EMR48_SET_OUTPUT_AL_ONLINE>(50.0f, data));
+  CHECK(frame_equals(data, {0x03, 0xF0, 0x00, 0x22, 0x3F, 0x00, 0x00, 0x00}));
+  CHECK(encode_max_output_current(100.0f, true, data));
+  CHECK(frame_equals(data, {0x03, 0xF0, 0x00, 0x19, 0x3F, 0x80, 0x00, 0x00}));
+
+  CHECK(encode_output_voltage(48.0f, false, data));
+  CHECK(frame_equals(data, {0x03, 0xF0, 0x00, 0x21, 0x42, 0x40, 0x00, 0x00}));
+
+  CHECK(encode_max_input_current(10.0f, data));
+  CHECK(frame_equals(data, {0x03, 0xF0, 0x00, 0x1A, 0x41, 0x20, 0x00, 0x00}));
+  CHECK(!encode_max_input_current(std::numeric_limits<float>::quiet_NaN(), data));
+  CHECK(!encode_max_input_current(-1.0f, data));
+  CHECK(!encode_max_input_current(std::numeric_limits<float>::infinity(), data));
+}
+
+static void test_control() {
+  CHECK_EQ(encode_control_bits(false, false, false, false), 0x01);
+  CHECK_EQ(encode_control_bits(true, false, false, false), 0x81);
+  CHECK_EQ(encode_control_bits(false, true, false, false), 0x11);
+  CHECK_EQ(encode_control_bits(false, false, true, false), 0x09);
+  CHECK_EQ(encode_control_bits(false, false, false, true), 0x05);
+  CHECK_EQ(encode_control_bits(true, true, true, true), 0x9D);
+
+  uint8_t data[EMR48_FRAME_LENGTH]{};
+  encode_control(0x85, data);
+  CHECK(frame_equals(data, {0x00, 0xF0, 0x85, 0x80, 0x00, 0x00, 0x00, 0x00}));
+}
+
+static void test_decode_data_frame() {
+  float value = 0;
+  const uint8_t voltage[EMR48_FRAME_LENGTH] = {0x41, 0xF0, 0x00, 0x01, 0x42, 0x56, 0x00, 0x00};
+  const ParamDef *param = decode_data_frame(CAN_ID_DATA, voltage, sizeof(voltage), &value);
+  CHECK(param != nullptr);
+  if (param != nullptr) {
+    CHECK_EQ(param->id, EMR48_DATA_OUTPUT_V);
+    CHECK_EQ(param->sensor, SENSOR_OUTPUT_VOLTAGE);
+  }
+  CHECK_EQ(value, 53.5f);
+
+  // the current limit comes back as a fraction of the rated current
+  const uint8_t limit[EMR48_FRAME_LENGTH] = {0x41, 0xF0, 0x00, 0x03, 0x3F, 0x00, 0x00, 0x00};
+  CHECK(decode_data_frame(CAN_ID_DATA, limit, sizeof(limit), &value) != nullptr);
+  CHECK_EQ(value, 50.0f);
+
+  // other rectifier addresses are replies all the same, but only address 0 decodes
+  CHECK_EQ(data_reply_id(0), CAN_ID_DATA);
+  CHECK_EQ(data_reply_id(0x3C), 0x060F81E3u);
+  CHECK_EQ(reply_address(data_reply_id(0x3C)), 0x3C);
+  CHECK(is_data_reply(data_reply_id(59)));
+  CHECK(!is_data_reply(CAN_ID_DATA2));
+  CHECK(decode_data_frame(data_reply_id(59), voltage, sizeof(voltage), &value) == nullptr);
+  uint8_t param_id;
+  CHECK(!decode_data_reply(data_reply_id(1), voltage, sizeof(voltage), &param_id, &value));
+  CHECK(decode_data_reply(CAN_ID_DATA, voltage, sizeof(voltage), &param_id, &value));
+  CHECK(decode_data_frame(CAN_ID_DATA2, voltage, sizeof(voltage), &value) == nullptr);
+  CHECK(decode_data_frame(CAN_ID_REQUEST, voltage, sizeof(voltage), &value) == nullptr);
+  CHECK(decode_data_frame(CAN_ID_DATA, voltage, EMR48_FRAME_LENGTH - 1, &value) == nullptr);
+  const uint8_t unknown[EMR48_FRAME_LENGTH] = {0x41, 0xF0, 0x00, 0x7F, 0x42, 0x56, 0x00, 0x00};
+  CHECK(decode_data_frame(CAN_ID_DATA, unknown, sizeof(unknown), &value) == nullptr);
+
+  // every readable parameter survives the rectifier-side encoder
+  for (size_t i = 0; i < EMR48_READ_PARAM_COUNT; i++) {
+    uint8_t data[EMR48_FRAME_LENGTH]{};
+    CHECK(encode_data_reply(read_param(i).id, 42.25f, data));
+    param = decode_data_frame(CAN_ID_DATA, data, sizeof(data), &value);
+    CHECK(param == &read_param(i));
+    CHECK_NEAR(value, 42.25f, 1e-4);
+  }
+}
+
+static void test_decode_set_frame() {
+  uint8_t data[EMR48_FRAME_LENGTH]{};
+  float value = 0;
+  CHECK(encode_max_output_current(75.0f, false, data));
+  const ParamDef *param = decode_set_frame(CAN_ID_SET, data, sizeof(data), &value);
+  CHECK(param != nullptr);
+  if (param != nullptr)
+    CHECK_EQ(param->id, EMR48_SET_OUTPUT_AL_ONLINE);
+  CHECK_NEAR(value, 75.0f, 1e-4);
+
+  CHECK(encode_output_voltage(52.0f, true, data));
+  param = decode_set_frame(CAN_ID_SET, data, sizeof(data), &value);
+  CHECK(param != nullptr && param->id == EMR48_SET_OUTPUT_V_OFFLINE);
+  CHECK_EQ(value, 52.0f);
+
+  CHECK(decode_set_frame(CAN_ID_SET2, data, sizeof(data), &value) == nullptr);
+  CHECK(decode_set_frame(CAN_ID_SET, data, 4, &value) == nullptr);
+  encode_read_request(EMR48_DATA_OUTPUT_V, data);
+  CHECK(decode_set_frame(CAN_ID_SET, data, sizeof(data), &value) == nullptr);
+}
+
+int main() {
+  test_float_byte_order();
+  test_read_request();
+  test_encode_parameter();
+  test_control();
+  test_decode_data_frame();
+  test_decode_set_frame();
+  return HOST_TEST_RESULT();
+}
@@ -0,0 +1,120 @@
+// The emerson_r48_sim capacity sweep as a host test: controller and simulated bank in one process on the
+// bit-rate-limited bus of simulated_bus.h, N = 1, 10, 30, 60 units. Asserts the simulator's reply latency and
+// loss and the controller's poll cycle time and setpoint latency per step, then shows the same sweep saturating
+// the bus with a four times faster poll.
+
+#include "esphome/components/emerson_r48/emerson_r48.h"
+#include "esphome/components/emerson_r48_sim/emerson_r48_sim.h"
+#include "esphome/core/log.h"
+#include "host_shim.h"
+#include "host_test.h"
+#include "simulated_bus.h"
+
+#include <vector>
+
+using namespace esphome;
+using namespace esphome::emerson_r48;
+using esphome::emerson_r48_sim::EmersonR48Simulator;
+using esphome::emerson_r48_sim::SweepResult;
+
+static const uint32_t BIT_RATE = 125000;
+static const uint32_t STEP_MS = 10000;
+static const uint32_t MAX_LATENCY_MS = 100;
+static const uint32_t MAX_POLL_TIME_MS = 1000;
+static const uint32_t MAX_SETPOINT_LATENCY_MS = 2500;
+static const uint8_t SWEEP_UNITS[] = {1, 10, 30, 60};
+
+// As emerson_r48_bench_example.yaml: the five polled sensors, 5 ms response delay, a 1.2 Ohm load
+static std::vector<SweepResult> run_sweep(uint32_t update_interval) {
+  SimulatedBus bus(BIT_RATE);
+  BusNode controller_node(&bus);
+  BusNode rectifier_node(&bus);
+  sensor::Sensor sensors[SENSOR_COUNT];
+
+  EmersonR48Component hub(&controller_node);
+  hub.set_frame_source(&controller_node);
+  hub.set_update_interval(update_interval);
+  hub.set_output_voltage_sensor(&sensors[SENSOR_OUTPUT_VOLTAGE]);
+  hub.set_output_current_sensor(&sensors[SENSOR_OUTPUT_CURRENT]);
+  hub.set_max_output_current_sensor(&sensors[SENSOR_MAX_OUTPUT_CURRENT]);
+  hub.set_output_temp_sensor(&sensors[SENSOR_OUTPUT_TEMP]);
+  hub.set_input_voltage_sensor(&sensors[SENSOR_INPUT_VOLTAGE]);
+
+  EmersonR48Simulator sim(&rectifier_node);
+  sim.set_frame_source(&rectifier_node);
+  sim.set_response_delay(5);
+  sim.set_load_resistance(1.2f);
+  for (uint8_t units : SWEEP_UNITS)
+    sim.add_sweep_step(units);
+  sim.set_sweep_limits(STEP_MS, MAX_LATENCY_MS, 0.0f);
+  sim.set_controller(&hub);
+  sim.set_sweep_controller_limits(MAX_POLL_TIME_MS, MAX_SETPOINT_LATENCY_MS);
+
+  controller_node.setup();
+  rectifier_node.setup();
+  hub.setup();
+  sim.setup();
+
+  const uint32_t deadline = millis() + STEP_MS * (sizeof(SWEEP_UNITS) + 1);
+  uint32_t last_update = millis();
+  while (!sim.is_sweep_done() && millis() < deadline) {
+    host_shim::advance_us(250);
+    bus.run_until(host_shim::now_us());
+    controller_node.loop();
+    rectifier_node.loop();
+    sim.loop();
+    hub.loop();
+    if (millis() - last_update >= update_interval) {
+      last_update = millis();
+      hub.update();
+    }
+  }
+  CHECK(sim.is_sweep_done());
+  return sim.get_sweep_results();
+}
+
+static void test_sweep() {
+  std::vector<SweepResult> results = run_sweep(200);
+  CHECK_EQ(results.size(), sizeof(SWEEP_UNITS));
+  for (size_t i = 0; i < results.size(); i++) {
+    const SweepResult &r = results[i];
+    CHECK_EQ(r.units, SWEEP_UNITS[i]);
+    CHECK(r.passed);
+    CHECK(r.requests > 0);
+    CHECK_EQ(r.loss, 0.0f);
+    CHECK(r.latency_max_ms <= MAX_LATENCY_MS);
+    CHECK(r.poll_cycles > 0);
+    CHECK(r.poll_time_max_ms <= MAX_POLL_TIME_MS);
+    CHECK(r.setpoints > 0);
+    CHECK(r.setpoint_latency_max_ms <= MAX_SETPOINT_LATENCY_MS);
+    if (i > 0) {
+      // more units, more replies queued behind each request on the same wire
+      CHECK(r.bus_load > results[i - 1].bus_load);
+      CHECK(r.latency_max_ms > results[i - 1].latency_max_ms);
+    }
+  }
+  // 60 replies of ~120 bits for each request every 200 ms: over a quarter of the 125 kbps bus
+  CHECK(results.back().bus_load > 25.0f && results.back().bus_load < 45.0f);
+}
+
+// One request every 50 ms asks 60 units for more than the bus carries: the replies back up, the simulator runs
+// out of queue space and the step fails, with the bus busy all the time
+static void test_saturation() {
+  std::vector<SweepResult> results = run_sweep(50);
+  CHECK_EQ(results.size(), sizeof(SWEEP_UNITS));
+  if (results.size() != sizeof(SWEEP_UNITS))
+    return;
+  CHECK(results[0].passed);
+  const SweepResult &r = results.back();
+  CHECK(!r.passed);
+  CHECK(r.bus_load > 95.0f);
+  CHECK(r.latency_max_ms > MAX_LATENCY_MS);
+}
+
+int main() {
+  // the sweep: {...} lines are the output of this test
+  host_shim::set_log_level(ESPHOME_LOG_LEVEL_INFO);
+  test_sweep();
+  test_saturation();
+  return HOST_TEST_RESULT();
+}
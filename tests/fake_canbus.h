@@ -0,0 +1,64 @@
+#pragma once
+
+// Canbus driver for the component host tests: records every frame sent and delivers frames to the listeners
+// the way a driver with a frame source does (batched, stamped with micros()), or to the triggers through
+// Canbus::loop() when the component has no frame source.
+
+#include "esphome/core/hal.h"
+#include "esphome/components/canbus/canbus.h"
+#include "esphome/components/canbus_ext/canbus_ext.h"
+#include "esphome/components/emerson_r48_protocol/emerson_r48_protocol.h"
+
+#include <cstring>
+#include <deque>
+#include <vector>
+
+class FakeCanbus : public esphome::canbus::Canbus, public esphome::canbus_ext::FrameSource {
+ public:
+  uint32_t get_bit_rate_bps() const override { return 125000; }
+
+  // frames a component sent, oldest first
+  std::vector<esphome::canbus::CanFrame> sent;
+  // send_message() answers ERROR_FAILTX while set, the frame is not recorded
+  bool fail_tx{false};
+
+  // timestamp_us: when the driver received the frame, earlier than now for a frame that waited in a batch
+  void deliver(uint32_t can_id, const uint8_t *data, uint32_t timestamp_us = esphome::micros()) {
+    esphome::canbus::CanFrame frame = make_frame(can_id, data);
+    this->dispatch_frames_(&frame, &timestamp_us, 1);
+  }
+  // Reply of rectifier address 0 to a read of param
+  void deliver_reply(uint8_t param, float value) {
+    uint8_t data[esphome::emerson_r48::EMR48_FRAME_LENGTH];
+    esphome::emerson_r48::encode_data_reply(param, value, data);
+    this->deliver(esphome::emerson_r48::CAN_ID_DATA, data);
+  }
+  // for the trigger path: read by the next loop()
+  void queue_rx(uint32_t can_id, const uint8_t *data) { this->rx_.push_back(make_frame(can_id, data)); }
+
+  static esphome::canbus::CanFrame make_frame(uint32_t can_id, const uint8_t *data) {
+    esphome::canbus::CanFrame frame{};
+    frame.can_id = can_id;
+    frame.use_extended_id = true;
+    frame.can_data_length_code = esphome::emerson_r48::EMR48_FRAME_LENGTH;
+    memcpy(frame.data, data, esphome::emerson_r48::EMR48_FRAME_LENGTH);
+    return frame;
+  }
+
+ protected:
+  std::deque<esphome::canbus::CanFrame> rx_;
+
+  esphome::canbus::Error send_message(esphome::canbus::CanFrame *frame) override {
+    if (this->fail_tx)
+      return esphome::canbus::ERROR_FAILTX;
+    this->sent.push_back(*frame);
+    return esphome::canbus::ERROR_OK;
+  }
+  esphome::canbus::Error read_message(esphome::canbus::CanFrame *frame) override {
+    if (this->rx_.empty())
+      return esphome::canbus::ERROR_NOMSG;
+    *frame = this->rx_.front();
+    this->rx_.pop_front();
+    return esphome::canbus::ERROR_OK;
+  }
+};
@@ -0,0 +1,41 @@
+#pragma once
+
+// Minimal assertion helpers for the host tests: every failed check is printed, main() returns the failure count.
+
+#include <cmath>
+#include <cstdio>
+
+static int host_test_failures = 0;
+
+#define CHECK(cond) \
+  do { \
+    if (!(cond)) { \
+      std::printf("%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #cond); \
+      host_test_failures++; \
+    } \
+  } while (0)
+
+#define CHECK_EQ(a, b) \
+  do { \
+    const auto check_a_ = (a); \
+    const auto check_b_ = (b); \
+    if (!(check_a_ == check_b_)) { \
+      std::printf("%s:%d: CHECK_EQ(%s, %s) failed: %lld != %lld\n", __FILE__, __LINE__, #a, #b, \
+                  (long long) check_a_, (long long) check_b_); \
+      host_test_failures++; \
+    } \
+  } while (0)
+
+#define CHECK_NEAR(a, b, tolerance) \
+  do { \
+    const double check_a_ = (a); \
+    const double check_b_ = (b); \
+    if (!(std::fabs(check_a_ - check_b_) <= (tolerance))) { \
+      std::printf("%s:%d: CHECK_NEAR(%s, %s) failed: %g != %g\n", __FILE__, __LINE__, #a, #b, check_a_, check_b_); \
+      host_test_failures++; \
+    } \
+  } while (0)
+
+#define HOST_TEST_RESULT() \
+  (std::printf("%s: %d failure(s)\n", host_test_failures ? "FAILED" : "passed", host_test_failures), \
+   host_test_failures != 0)
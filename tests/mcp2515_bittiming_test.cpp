@@ -0,0 +1,228 @@
+// Host test of the MCP2515 bit timing solver over the crystal x bit rate matrix: register encodings, rate
+// error, the datasheet segment rules, the tie-breaks and the rejection of unreachable rates.
+
+#include <cstdint>
+#include "esphome/components/mcp2515/mcp2515_bittiming.h"
+#include "host_test.h"
+
+#include <initializer_list>
+
+using namespace esphome::mcp2515;
+
+static const uint32_t CLOCKS_HZ[] = {8000000, 16000000, 20000000};
+static const uint32_t BIT_RATES[] = {50000, 100000, 125000, 200000, 250000, 500000, 800000, 1000000};
+
+struct Registers {
+  uint8_t cfg1, cfg2, cfg3;
+};
+
+struct Decoded {
+  uint32_t brp, sjw, prop, ps1, ps2, tq;
+};
+
+// CNF1: SJW[7:6] BRP[5:0], CNF2: BTLMODE SAM PHSEG1[5:3] PRSEG[2:0], CNF3: SOF WAKFIL PHSEG2[2:0]
+static Decoded decode(uint8_t cfg1, uint8_t cfg2, uint8_t cfg3) {
+  Decoded d{};
+  d.brp = (cfg1 & 0x3F) + 1u;
+  d.sjw = (cfg1 >> 6) + 1u;
+  d.prop = (cfg2 & 0x07) + 1u;
+  d.ps1 = ((cfg2 >> 3) & 0x07) + 1u;
+  d.ps2 = (cfg3 & 0x07) + 1u;
+  d.tq = 1 + d.prop + d.ps1 + d.ps2;
+  return d;
+}
+
+static uint64_t divider(const Decoded &d) { return 2ull * d.brp * d.tq; }
+
+// |clock / divider - bit_rate| / bit_rate in ppm, truncated like the solver
+static uint32_t error_ppm(uint32_t clock_hz, uint32_t bit_rate, uint64_t div) {
+  const uint64_t target = uint64_t(bit_rate) * div;
+  const uint64_t err = clock_hz > target ? clock_hz - target : target - clock_hz;
+  return uint32_t(err * 1000000ull / target);
+}
+
+// The solver's own choices for the matrix, clocks x BIT_RATES; 20 MHz cannot make 800 kbit/s
+static const Registers EXPECTED[3][8] = {
+    {{0x04, 0xBC, 0x81},
+     {0x41, 0xBF, 0x82},
+     {0x01, 0xBC, 0x81},
+     {0x40, 0xBF, 0x82},
+     {0x00, 0xBC, 0x81},
+     {0x00, 0x98, 0x81},
+     {0x00, 0x80, 0x81},
+     {0x00, 0x80, 0x80}},
+    {{0x09, 0xBC, 0x81},
+     {0x04, 0xBC, 0x81},
+     {0x03, 0xBC, 0x81},
+     {0x41, 0xBF, 0x82},
+     {0x01, 0xBC, 0x81},
+     {0x00, 0xBC, 0x81},
+     {0x00, 0xA8, 0x81},
+     {0x00, 0x98, 0x81}},
+    {{0x49, 0xBF, 0x82},
+     {0x44, 0xBF, 0x82},
+     {0x04, 0xBC, 0x81},
+     {0x04, 0xA8, 0x81},
+     {0x41, 0xBF, 0x82},
+     {0x40, 0xBF, 0x82},
+     {0x00, 0x00, 0x00},
+     {0x00, 0xA8, 0x81}},
+};
+
+// Rows of the MCP2515 CNF tables (datasheet / the switch tables the solver replaced) inside the matrix
+struct TableTiming {
+  uint32_t clock_hz;
+  uint32_t bit_rate;
+  uint8_t cfg1, cfg2, cfg3;
+};
+static const TableTiming DATASHEET[] = {
+    {8000000, 50000, 0x03, 0xB4, 0x86},   {8000000, 100000, 0x01, 0xB4, 0x86},
+    {8000000, 125000, 0x01, 0xB1, 0x85},  {8000000, 200000, 0x00, 0xB4, 0x86},
+    {8000000, 250000, 0x00, 0xB1, 0x85},  {8000000, 500000, 0x00, 0x90, 0x82},
+    {8000000, 1000000, 0x00, 0x80, 0x80}, {16000000, 50000, 0x07, 0xFA, 0x87},
+    {16000000, 100000, 0x03, 0xFA, 0x87}, {16000000, 125000, 0x03, 0xF0, 0x86},
+    {16000000, 200000, 0x01, 0xFA, 0x87}, {16000000, 250000, 0x41, 0xF1, 0x85},
+    {16000000, 500000, 0x00, 0xF0, 0x86}, {16000000, 1000000, 0x00, 0xD0, 0x82},
+    {20000000, 50000, 0x09, 0xFA, 0x87},  {20000000, 100000, 0x04, 0xFA, 0x87},
+    {20000000, 125000, 0x03, 0xFA, 0x87}, {20000000, 200000, 0x01, 0xFF, 0x87},
+    {20000000, 250000, 0x41, 0xFB, 0x86}, {20000000, 500000, 0x00, 0xFA, 0x87},
+    {20000000, 1000000, 0x00, 0xD9, 0x82},
+};
+
+// the register fields must match the struct, and the segments the datasheet rules (section 5.3)
+static void check_encoding(const BitTiming &t, uint32_t clock_hz, uint32_t bit_rate) {
+  const Decoded d = decode(t.cfg1, t.cfg2, t.cfg3);
+  CHECK_EQ(d.brp, t.brp);
+  CHECK_EQ(d.sjw, t.sjw);
+  CHECK_EQ(d.prop, t.prop_seg);
+  CHECK_EQ(d.ps1, t.phase_seg1);
+  CHECK_EQ(d.ps2, t.phase_seg2);
+  CHECK(t.cfg2 & CNF2_BTLMODE);  // PS2 taken from CNF3
+  CHECK(t.cfg3 & CNF3_SOF);
+  CHECK(d.tq >= 4 && d.tq <= 25);
+  CHECK(d.prop + d.ps1 >= d.ps2);
+  if (d.tq > 4) {
+    CHECK(d.ps2 >= 2);
+    CHECK(d.sjw < d.ps2);
+  }
+  CHECK_EQ(t.sample_point, (1 + d.prop + d.ps1) * 1000 / d.tq);
+  CHECK_EQ(t.error_ppm, error_ppm(clock_hz, bit_rate, divider(d)));
+  const uint64_t div = divider(d);
+  CHECK_EQ(t.bit_rate, uint32_t((clock_hz + div / 2) / div));
+}
+
+// no (BRP, quanta) pair the solver may use gets closer to the requested rate
+static uint32_t best_error_ppm(uint32_t clock_hz, uint32_t bit_rate) {
+  uint32_t best = UINT32_MAX;
+  for (uint32_t brp = 1; brp <= 64; brp++)
+    for (uint32_t tq = 4; tq <= 25; tq++) {
+      const uint32_t ppm = error_ppm(clock_hz, bit_rate, 2ull * brp * tq);
+      if (ppm < best)
+        best = ppm;
+    }
+  return best;
+}
+
+static void test_matrix() {
+  for (size_t c = 0; c < 3; c++) {
+    for (size_t r = 0; r < 8; r++) {
+      const uint32_t clock_hz = CLOCKS_HZ[c];
+      const uint32_t bit_rate = BIT_RATES[r];
+      const BitTiming t = solve_bit_timing(clock_hz, bit_rate);
+      const Registers &expected = EXPECTED[c][r];
+      CHECK_EQ(t.ok, expected.cfg2 != 0);
+      CHECK_EQ(t.cfg1, expected.cfg1);
+      CHECK_EQ(t.cfg2, expected.cfg2);
+      CHECK_EQ(t.cfg3, expected.cfg3);
+      const uint32_t best = best_error_ppm(clock_hz, bit_rate);
+      if (!t.ok) {
+        CHECK(best > MAX_BIT_RATE_ERROR_PPM);
+        continue;
+      }
+      CHECK_EQ(t.error_ppm, best);
+      CHECK(t.error_ppm <= MAX_BIT_RATE_ERROR_PPM);
+      check_encoding(t, clock_hz, bit_rate);
+    }
+  }
+}
+
+static void test_datasheet_tables() {
+  for (const TableTiming &row : DATASHEET) {
+    const Decoded d = decode(row.cfg1, row.cfg2, row.cfg3);
+    const BitTiming t = solve_bit_timing(row.clock_hz, row.bit_rate);
+    CHECK(t.ok);
+    // every table entry is exact in this range, the solver has to be as well
+    CHECK_EQ(error_ppm(row.clock_hz, row.bit_rate, divider(d)), 0u);
+    CHECK_EQ(t.error_ppm, 0u);
+    CHECK_EQ(t.bit_rate, row.bit_rate);
+  }
+}
+
+// 1 Mbit/s from 8 MHz only fits with 4 quanta: SyncSeg, PropSeg, PS1, PS2 of one quantum each
+static void test_four_quanta() {
+  const BitTiming t = solve_bit_timing(8000000, 1000000);
+  CHECK(t.ok);
+  CHECK_EQ(t.brp, 1);
+  CHECK_EQ(t.prop_seg, 1);
+  CHECK_EQ(t.phase_seg1, 1);
+  CHECK_EQ(t.phase_seg2, 1);
+  CHECK_EQ(t.sjw, 1);
+  CHECK_EQ(t.sample_point, 750);
+  CHECK_EQ(t.cfg1, 0x00);
+  CHECK_EQ(t.cfg2, 0x80);
+  CHECK_EQ(t.cfg3, 0x80);
+  // 4 quanta is never chosen when a longer bit reaches the same rate
+  for (uint32_t clock_hz : CLOCKS_HZ)
+    for (uint32_t bit_rate : BIT_RATES) {
+      const BitTiming other = solve_bit_timing(clock_hz, bit_rate);
+      if (other.ok && !(clock_hz == 8000000 && bit_rate == 1000000))
+        CHECK(1 + other.prop_seg + other.phase_seg1 + other.phase_seg2 > 4);
+    }
+}
+
+static void test_tie_breaks() {
+  // smallest rate error first: 95 kbit/s from 8 MHz is not exact, a divider of 84 is the closest
+  BitTiming t = solve_bit_timing(8000000, 95000);
+  CHECK(t.ok);
+  CHECK_EQ(t.error_ppm, best_error_ppm(8000000, 95000));
+  CHECK_EQ(t.bit_rate, 95238);
+
+  // then the sample point: 125 kbit/s from 8 MHz is exact with 16, 8 and 4 quanta, only 16 reach 87.5 %
+  t = solve_bit_timing(8000000, 125000);
+  CHECK_EQ(t.sample_point, 875);
+  CHECK_EQ(1 + t.prop_seg + t.phase_seg1 + t.phase_seg2, 16);
+
+  // then the most quanta: 500 kbit/s from 16 MHz at 75 % is exact with 16, 8 and 4 quanta
+  t = solve_bit_timing(16000000, 500000, 750);
+  CHECK_EQ(t.sample_point, 750);
+  CHECK_EQ(t.brp, 1);
+  CHECK_EQ(1 + t.prop_seg + t.phase_seg1 + t.phase_seg2, 16);
+  CHECK_EQ(t.phase_seg2, 4);
+}
+
+static void test_rejection() {
+  // 20 MHz / 800 kbit/s needs an odd divider of 25 = 2 * BRP * quanta, the nearest (24, 26) are ~4 % off
+  CHECK(!solve_bit_timing(20000000, 800000).ok);
+  // above 1 Mbit/s from 8 MHz the 4 quanta minimum caps the rate
+  CHECK(!solve_bit_timing(8000000, 1100000).ok);
+  // right at the limit: 8 MHz / 8 against 1.0049 and 1.0051 Mbit/s requested
+  const BitTiming inside = solve_bit_timing(8000000, 1004900);
+  CHECK(inside.ok);
+  CHECK(inside.error_ppm <= MAX_BIT_RATE_ERROR_PPM);
+  CHECK_EQ(inside.bit_rate, 1000000);
+  CHECK(!solve_bit_timing(8000000, 1005100).ok);
+  CHECK(!solve_bit_timing(0, 125000).ok);
+  CHECK(!solve_bit_timing(8000000, 0).ok);
+}
+
+// the solver is constexpr, fixed configs can be checked at build time
+static_assert(solve_bit_timing(16000000, 125000).cfg1 == 0x03, "constexpr solve");
+
+int main() {
+  test_matrix();
+  test_datasheet_tables();
+  test_four_quanta();
+  test_tie_breaks();
+  test_rejection();
+  return HOST_TEST_RESULT();
+}
@@ -0,0 +1,105 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "esphome/core/automation.h"
+#include "esphome/core/component.h"
+
+namespace esphome {
+namespace canbus {
+
+// The ESPHome canbus API as far as the components use it; send_data() and loop() behave as upstream, the
+// driver side (send_message / read_message) is left to the test's subclass.
+
+enum Error : uint8_t {
+  ERROR_OK = 0,
+  ERROR_FAIL = 1,
+  ERROR_ALLTXBUSY = 2,
+  ERROR_FAILINIT = 3,
+  ERROR_FAILTX = 4,
+  ERROR_NOMSG = 5,
+};
+
+enum CanSpeed : uint8_t {
+  CAN_5KBPS,
+  CAN_10KBPS,
+  CAN_20KBPS,
+  CAN_31K25BPS,
+  CAN_33KBPS,
+  CAN_40KBPS,
+  CAN_50KBPS,
+  CAN_80KBPS,
+  CAN_83K3BPS,
+  CAN_95KBPS,
+  CAN_100KBPS,
+  CAN_125KBPS,
+  CAN_200KBPS,
+  CAN_250KBPS,
+  CAN_500KBPS,
+  CAN_1000KBPS,
+};
+
+static const uint8_t CAN_MAX_DATA_LENGTH = 8;
+
+struct CanFrame {
+  bool use_extended_id = false;
+  bool remote_transmission_request = false;
+  uint32_t can_id;
+  uint8_t can_data_length_code;
+  uint8_t data[CAN_MAX_DATA_LENGTH] __attribute__((aligned(8)));
+};
+
+class CanbusTrigger;
+
+class Canbus : public Component {
+ public:
+  Canbus() = default;
+  void setup() override { this->setup_internal(); }
+  void loop() override;
+
+  Error send_data(uint32_t can_id, bool use_extended_id, bool remote_transmission_request,
+                  const std::vector<uint8_t> &data);
+  Error send_data(uint32_t can_id, bool use_extended_id, const std::vector<uint8_t> &data) {
+    return this->send_data(can_id, use_extended_id, false, data);
+  }
+
+  void set_can_id(uint32_t can_id) { this->can_id_ = can_id; }
+  void set_use_extended_id(bool use_extended_id) { this->use_extended_id_ = use_extended_id; }
+  void set_bitrate(CanSpeed bit_rate) { this->bit_rate_ = bit_rate; }
+  void add_trigger(CanbusTrigger *trigger) { this->triggers_.push_back(trigger); }
+
+ protected:
+  std::vector<CanbusTrigger *> triggers_{};
+  uint32_t can_id_{0};
+  bool use_extended_id_{false};
+  CanSpeed bit_rate_{CAN_125KBPS};
+
+  virtual bool setup_internal() { return true; }
+  virtual Error send_message(CanFrame *frame) = 0;
+  virtual Error read_message(CanFrame *frame) {
+    (void) frame;
+    return ERROR_NOMSG;
+  }
+};
+
+class CanbusTrigger : public Trigger<std::vector<uint8_t>, uint32_t, bool>, public Component {
+  friend class Canbus;
+
+ public:
+  explicit CanbusTrigger(Canbus *parent, const std::uint32_t can_id, const std::uint32_t can_id_mask,
+                         const bool use_extended_id)
+      : parent_(parent), can_id_(can_id), can_id_mask_(can_id_mask), use_extended_id_(use_extended_id) {}
+  void set_remote_transmission_request(bool remote_transmission_request) { this->rtr_ = remote_transmission_request; }
+  void setup() override { this->parent_->add_trigger(this); }
+
+ protected:
+  Canbus *parent_;
+  uint32_t can_id_;
+  uint32_t can_id_mask_;
+  bool use_extended_id_;
+  int rtr_{-1};
+};
+
+}  // namespace canbus
+}  // namespace esphome
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+
+#include "esphome/core/component.h"
+
+namespace esphome {
+namespace number {
+
+class Number {
+ public:
+  virtual ~Number() = default;
+  void publish_state(float state) {
+    this->state = state;
+    this->has_state_ = true;
+    this->publish_count++;
+  }
+  bool has_state() const { return this->has_state_; }
+
+  float state{NAN};
+  uint32_t publish_count{0};  // host only
+
+ protected:
+  virtual void control(float value) { this->publish_state(value); }
+  bool has_state_{false};
+};
+
+}  // namespace number
+}  // namespace esphome
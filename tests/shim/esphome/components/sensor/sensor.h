@@ -0,0 +1,34 @@
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+#include <functional>
+
+#include "esphome/core/component.h"
+#include "esphome/core/helpers.h"
+
+namespace esphome {
+namespace sensor {
+
+class Sensor {
+ public:
+  virtual ~Sensor() = default;
+  void publish_state(float state) {
+    this->state = state;
+    this->has_state_ = true;
+    this->publish_count++;
+    this->callback_.call(state);
+  }
+  void add_on_state_callback(std::function<void(float)> &&callback) { this->callback_.add(std::move(callback)); }
+  bool has_state() const { return this->has_state_; }
+
+  float state{NAN};
+  uint32_t publish_count{0};  // host only
+
+ protected:
+  bool has_state_{false};
+  CallbackManager<void(float)> callback_;
+};
+
+}  // namespace sensor
+}  // namespace esphome
@@ -0,0 +1,26 @@
+#pragma once
+
+#include <cstdint>
+
+#include "esphome/core/component.h"
+
+namespace esphome {
+namespace switch_ {
+
+class Switch {
+ public:
+  virtual ~Switch() = default;
+  void publish_state(bool state) {
+    this->state = state;
+    this->publish_count++;
+  }
+
+  bool state{false};
+  uint32_t publish_count{0};  // host only
+
+ protected:
+  virtual void write_state(bool state) { this->publish_state(state); }
+};
+
+}  // namespace switch_
+}  // namespace esphome
@@ -0,0 +1,24 @@
+#pragma once
+
+#include <vector>
+
+#include "esphome/core/component.h"
+
+namespace esphome {
+
+// Keeps the registered components; the host tests drive setup(), loop() and update() themselves
+class Application {
+ public:
+  template<typename C> C *register_component(C *c) {
+    this->components_.push_back(c);
+    return c;
+  }
+  const std::vector<Component *> &get_components() const { return this->components_; }
+
+ protected:
+  std::vector<Component *> components_;
+};
+
+extern Application App;
+
+}  // namespace esphome
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <vector>
+
+#include "esphome/core/component.h"
+
+namespace esphome {
+
+template<typename... Ts> class Automation;
+
+template<typename... Ts> class Trigger {
+ public:
+  void trigger(Ts... x) {
+    if (this->automation_parent_ != nullptr)
+      this->automation_parent_->trigger(x...);
+  }
+  void set_automation_parent(Automation<Ts...> *automation_parent) { this->automation_parent_ = automation_parent; }
+
+ protected:
+  Automation<Ts...> *automation_parent_{nullptr};
+};
+
+template<typename... Ts> class Action {
+ public:
+  virtual ~Action() = default;
+  virtual void play(Ts... x) = 0;
+  void play_complex(Ts... x) { this->play(x...); }
+};
+
+template<typename... Ts> class Automation {
+ public:
+  explicit Automation(Trigger<Ts...> *trigger) { trigger->set_automation_parent(this); }
+  void add_actions(const std::vector<Action<Ts...> *> &actions) {
+    this->actions_.insert(this->actions_.end(), actions.begin(), actions.end());
+  }
+  void trigger(Ts... x) {
+    for (auto *action : this->actions_)
+      action->play_complex(x...);
+  }
+
+ protected:
+  std::vector<Action<Ts...> *> actions_;
+};
+
+}  // namespace esphome
@@ -0,0 +1,18 @@
+#pragma once
+
+#include <functional>
+
+#include "esphome/core/automation.h"
+
+namespace esphome {
+
+template<typename... Ts> class LambdaAction : public Action<Ts...> {
+ public:
+  explicit LambdaAction(std::function<void(Ts...)> &&f) : f_(std::move(f)) {}
+  void play(Ts... x) override { this->f_(x...); }
+
+ protected:
+  std::function<void(Ts...)> f_;
+};
+
+}  // namespace esphome
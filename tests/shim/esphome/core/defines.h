@@ -0,0 +1,3 @@
+#pragma once
+
+// The USE_* feature flags come from the compile definitions of the host targets, see tests/CMakeLists.txt
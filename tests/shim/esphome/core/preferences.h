@@ -0,0 +1,68 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <map>
+#include <vector>
+
+namespace esphome {
+
+// In-memory preferences: a saved value survives until global_preferences->clear(), the way flash survives a
+// reboot. in_flash is recorded per key so a test can tell flash from RTC storage.
+struct HostPreference {
+  std::vector<uint8_t> data;
+  bool in_flash{false};
+  uint32_t saves{0};
+};
+
+class ESPPreferenceObject {
+ public:
+  ESPPreferenceObject() = default;
+  explicit ESPPreferenceObject(HostPreference *pref) : pref_(pref) {}
+
+  template<typename T> bool save(const T *src) {
+    if (this->pref_ == nullptr)
+      return false;
+    const auto *bytes = reinterpret_cast<const uint8_t *>(src);
+    this->pref_->data.assign(bytes, bytes + sizeof(T));
+    this->pref_->saves++;
+    return true;
+  }
+
+  template<typename T> bool load(T *dest) {
+    if (this->pref_ == nullptr || this->pref_->data.size() != sizeof(T))
+      return false;
+    std::memcpy(dest, this->pref_->data.data(), sizeof(T));
+    return true;
+  }
+
+ protected:
+  HostPreference *pref_{nullptr};
+};
+
+class ESPPreferences {
+ public:
+  template<typename T> ESPPreferenceObject make_preference(uint32_t type, bool in_flash) {
+    HostPreference &pref = this->store_[type];
+    pref.in_flash = in_flash;
+    return ESPPreferenceObject(&pref);
+  }
+  template<typename T> ESPPreferenceObject make_preference(uint32_t type) {
+    return this->make_preference<T>(type, false);
+  }
+  bool sync() { return true; }
+
+  // test access
+  HostPreference *find(uint32_t type) {
+    auto it = this->store_.find(type);
+    return it == this->store_.end() ? nullptr : &it->second;
+  }
+  void clear() { this->store_.clear(); }
+
+ protected:
+  std::map<uint32_t, HostPreference> store_;
+};
+
+extern ESPPreferences *global_preferences;
+
+}  // namespace esphome
@@ -0,0 +1,107 @@
+#include "host_shim.h"
+#include "esphome/core/application.h"
+#include "esphome/core/component.h"
+#include "esphome/core/hal.h"
+#include "esphome/core/helpers.h"
+#include "esphome/core/log.h"
+#include "esphome/core/preferences.h"
+#include "esphome/components/canbus/canbus.h"
+
+#include <cstdarg>
+
+namespace esphome {
+
+namespace setup_priority {
+const float BUS = 1000.0f;
+const float IO = 900.0f;
+const float HARDWARE = 800.0f;
+const float DATA = 600.0f;
+const float PROCESSOR = 400.0f;
+const float AFTER_WIFI = 200.0f;
+const float AFTER_CONNECTION = 100.0f;
+const float LATE = -100.0f;
+}  // namespace setup_priority
+
+static uint64_t clock_us = 1000000;
+static int log_level = ESPHOME_LOG_LEVEL_WARN;
+static uint32_t log_counts[ESPHOME_LOG_LEVEL_VERY_VERBOSE + 1]{};
+
+Application App;  // NOLINT
+
+static ESPPreferences host_preferences;
+ESPPreferences *global_preferences = &host_preferences;
+
+uint32_t millis() { return uint32_t(clock_us / 1000); }
+uint32_t micros() { return uint32_t(clock_us); }
+void delay(uint32_t ms) { clock_us += uint64_t(ms) * 1000; }
+void delayMicroseconds(uint32_t us) { clock_us += us; }
+void yield() {}
+
+uint32_t fnv1_hash(const std::string &str) {
+  uint32_t hash = 2166136261UL;
+  for (char c : str) {
+    hash *= 16777619UL;
+    hash ^= uint8_t(c);
+  }
+  return hash;
+}
+
+namespace host_shim {
+
+void advance_us(uint32_t us) { clock_us += us; }
+uint64_t now_us() { return clock_us; }
+
+void set_log_level(int level) { log_level = level; }
+uint32_t log_count(int level) { return log_counts[level]; }
+void reset_log_counts() {
+  for (auto &count : log_counts)
+    count = 0;
+}
+
+void log_printf(int level, const char *tag, const char *format, ...) {
+  log_counts[level]++;
+  if (level > log_level)
+    return;
+  static const char LEVEL_CHARS[] = "-EWICDVV";
+  std::printf("[%c][%s] ", LEVEL_CHARS[level], tag);
+  va_list args;
+  va_start(args, format);
+  std::vprintf(format, args);
+  va_end(args);
+  std::printf("\n");
+}
+
+}  // namespace host_shim
+
+namespace canbus {
+
+// as upstream: the payload is truncated to 8 bytes and handed to the driver
+Error Canbus::send_data(uint32_t can_id, bool use_extended_id, bool remote_transmission_request,
+                        const std::vector<uint8_t> &data) {
+  CanFrame frame{};
+  frame.can_id = can_id;
+  frame.use_extended_id = use_extended_id;
+  frame.remote_transmission_request = remote_transmission_request;
+  uint8_t size = data.size() > CAN_MAX_DATA_LENGTH ? CAN_MAX_DATA_LENGTH : uint8_t(data.size());
+  frame.can_data_length_code = size;
+  for (uint8_t i = 0; i < size; i++)
+    frame.data[i] = data[i];
+  return this->send_message(&frame);
+}
+
+// as upstream: every received frame goes to the triggers whose id, mask and frame format match
+void Canbus::loop() {
+  CanFrame frame;
+  while (this->read_message(&frame) == ERROR_OK) {
+    std::vector<uint8_t> data(frame.data, frame.data + frame.can_data_length_code);
+    for (auto *trigger : this->triggers_) {
+      if ((trigger->can_id_ & trigger->can_id_mask_) == (frame.can_id & trigger->can_id_mask_) &&
+          trigger->use_extended_id_ == frame.use_extended_id &&
+          (trigger->rtr_ == -1 || trigger->rtr_ == int(frame.remote_transmission_request)))
+        trigger->trigger(data, frame.can_id, frame.remote_transmission_request);
+    }
+  }
+}
+
+}  // namespace canbus
+}  // namespace esphome
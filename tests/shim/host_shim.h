@@ -0,0 +1,22 @@
+#pragma once
+
+// Test-side controls of the ESPHome host shim in shim/esphome: the simulated clock, the log filter and counters.
+
+#include <cstdint>
+
+namespace esphome {
+namespace host_shim {
+
+// millis() and micros() only move when a test advances them; both start at 1 s so that 0 stays "never"
+void advance_us(uint32_t us);
+inline void advance_ms(uint32_t ms) { advance_us(ms * 1000); }
+uint64_t now_us();
+
+// Messages at or above this level (ESPHOME_LOG_LEVEL_*) are printed, default warnings and errors
+void set_log_level(int level);
+// Messages logged at exactly this level since the last reset_log_counts()
+uint32_t log_count(int level);
+void reset_log_counts();
+
+}  // namespace host_shim
+}  // namespace esphome
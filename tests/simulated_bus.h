@@ -0,0 +1,110 @@
+#pragma once
+
+// In-process CAN bus for the host sweep: every node is a canbus driver with a frame source, frames take their
+// exact on-wire time at the bus bit rate, pending frames arbitrate by id (lowest wins) once the bus is free and
+// each node has a fixed number of TX mailboxes, so a busy bus saturates the way a real 125 kbps one does. A
+// completed frame is delivered to every other node, stamped with the time its last bit left the wire.
+
+#include "esphome/core/hal.h"
+#include "esphome/components/canbus/canbus.h"
+#include "esphome/components/canbus_ext/canbus_ext.h"
+#include "host_shim.h"
+
+#include <cstdint>
+#include <deque>
+#include <vector>
+
+class SimulatedBus;
+
+class BusNode : public esphome::canbus::Canbus, public esphome::canbus_ext::FrameSource {
+  friend class SimulatedBus;
+
+ public:
+  BusNode(SimulatedBus *bus, uint8_t tx_mailboxes = 3);
+  uint32_t get_bit_rate_bps() const override;
+  // as the drivers do: closes the bus load window when it is due
+  void loop() override { this->update_bus_load_(esphome::millis()); }
+  uint32_t tx_busy() const { return this->tx_busy_; }
+
+ protected:
+  struct Pending {
+    esphome::canbus::CanFrame frame;
+    uint64_t queued_us;
+  };
+
+  SimulatedBus *bus_;
+  uint8_t tx_mailboxes_;
+  std::deque<Pending> tx_;
+  uint32_t tx_busy_{0};
+
+  esphome::canbus::Error send_message(esphome::canbus::CanFrame *frame) override {
+    if (this->tx_.size() >= this->tx_mailboxes_) {
+      this->tx_busy_++;
+      return esphome::canbus::ERROR_ALLTXBUSY;
+    }
+    this->tx_.push_back({*frame, esphome::host_shim::now_us()});
+    return esphome::canbus::ERROR_OK;
+  }
+
+  void sent_(const esphome::canbus::CanFrame &frame) { this->account_frame_(frame); }
+  void receive_(const esphome::canbus::CanFrame &frame, uint32_t timestamp_us) {
+    this->account_frame_(frame);
+    this->dispatch_frames_(&frame, &timestamp_us, 1);
+  }
+};
+
+class SimulatedBus {
+ public:
+  explicit SimulatedBus(uint32_t bit_rate_bps) : bit_rate_bps_(bit_rate_bps) {}
+  uint32_t get_bit_rate_bps() const { return this->bit_rate_bps_; }
+  void attach(BusNode *node) { this->nodes_.push_back(node); }
+
+  // Puts on the wire, one after the other, every frame that is completely transmitted by now_us
+  void run_until(uint64_t now_us) {
+    while (true) {
+      uint64_t earliest = UINT64_MAX;
+      for (BusNode *node : this->nodes_) {
+        if (!node->tx_.empty() && node->tx_.front().queued_us < earliest)
+          earliest = node->tx_.front().queued_us;
+      }
+      if (earliest == UINT64_MAX)
+        return;
+      const uint64_t start = earliest > this->free_at_us_ ? earliest : this->free_at_us_;
+      // arbitration among the frames waiting when the bus goes idle
+      BusNode *winner = nullptr;
+      for (BusNode *node : this->nodes_) {
+        if (node->tx_.empty() || node->tx_.front().queued_us > start)
+          continue;
+        if (winner == nullptr || node->tx_.front().frame.can_id < winner->tx_.front().frame.can_id)
+          winner = node;
+      }
+      const esphome::canbus::CanFrame frame = winner->tx_.front().frame;
+      const uint64_t end = start + uint64_t(esphome::canbus_ext::frame_bits(frame)) * 1000000 / this->bit_rate_bps_;
+      if (end > now_us)
+        return;
+      winner->tx_.pop_front();
+      this->free_at_us_ = end;
+      this->busy_us_ += end - start;
+      winner->sent_(frame);
+      for (BusNode *node : this->nodes_) {
+        if (node != winner)
+          node->receive_(frame, uint32_t(end));
+      }
+    }
+  }
+
+  // wire time of every frame transmitted so far
+  uint64_t busy_us() const { return this->busy_us_; }
+
+ protected:
+  uint32_t bit_rate_bps_;
+  std::vector<BusNode *> nodes_;
+  uint64_t free_at_us_{0};
+  uint64_t busy_us_{0};
+};
+
+inline BusNode::BusNode(SimulatedBus *bus, uint8_t tx_mailboxes) : bus_(bus), tx_mailboxes_(tx_mailboxes) {
+  bus->attach(this);
+}
+
+inline uint32_t BusNode::get_bit_rate_bps() const { return this->bus_->get_bit_rate_bps(); }